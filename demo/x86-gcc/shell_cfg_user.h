@@ -26,6 +26,27 @@ unsigned int userGetTick();
  */
 #define     SHELL_SUPPORT_END_LINE      1
 
+/**
+ * @brief 支持shell机器模式
+ */
+#define     SHELL_SUPPORT_MACHINE_MODE  1
+
+/**
+ * @brief 支持单行多语句
+ */
+#define     SHELL_SUPPORT_MULTI_STATEMENT   1
+
+/**
+ * @brief 支持后台命令
+ */
+#define     SHELL_SUPPORT_BACKGROUND    1
+
+/**
+ * @brief 使用锁
+ *        后台命令在其他线程中通过尾行模式输出，需要和输入处理互斥
+ */
+#define     SHELL_USING_LOCK            1
+
 /**
  * @brief 使用执行未导出函数的功能
  *        启用后，可以通过`exec [addr] [args]`直接执行对应地址的函数
@@ -40,6 +61,36 @@ unsigned int userGetTick();
  */
 #define     SHELL_KEEP_RETURN_VALUE     1
 
+/**
+ * @brief shell命令提示符缓冲大小
+ */
+#define     SHELL_PROMPT_BUFFER         64
+
+/**
+ * @brief shell管道缓冲大小
+ */
+#define     SHELL_PIPE_BUFFER           4096
+
+/**
+ * @brief shell重定向缓冲大小
+ */
+#define     SHELL_REDIRECT_BUFFER       1024
+
+/**
+ * @brief 命令行执行队列大小
+ */
+#define     SHELL_EXEC_QUEUE_SIZE       512
+
+/**
+ * @brief 支持取消正在执行的命令
+ */
+#define     SHELL_SUPPORT_CANCEL        1
+
+/**
+ * @brief 支持可挂起命令
+ */
+#define     SHELL_SUPPORT_YIELD         1
+
 /**
  * @brief shell格式化输入的缓冲大小
  *        为0时不使用shell格式化输入
@@ -54,6 +105,17 @@ unsigned int userGetTick();
  */
 #define     SHELL_GET_TICK()            userGetTick()
 
+/**
+ * @brief 当前shell的线程局部存储修饰符
+ *        telnet会话在各自的线程中执行命令
+ */
+#define     SHELL_THREAD_LOCAL          __thread
+
+/**
+ * @brief shell注册表是否动态扩展
+ */
+#define     SHELL_REGISTRY_GROW         1
+
 /**
  * @brief shell内存分配
  *        shell本身不需要此接口，若使用shell伴生对象，需要进行定义
@@ -73,10 +135,40 @@ unsigned int userGetTick();
  */
 #define     SHELL_USING_FUNC_SIGNATURE  1
 
+/**
+ * @brief 使用命令调用函数
+ */
+#define     SHELL_USING_FUNC_INVOKER    1
+
 /**
  * @brief 支持数组参数
  *        使能后，可以在命令中使用数组参数，如`cmd [1,2,3]`
  *        需要使能 `SHELL_USING_FUNC_SIGNATURE` 宏，并且配置 `SHELL_MALLOC`, `SHELL_FREE`
  */
 #define     SHELL_SUPPORT_ARRAY_PARAM   1
+
+/**
+ * @brief 参数内存池大小
+ */
+#define     SHELL_PARAM_ARENA_SIZE      512
+
+/**
+ * @brief 变量查找缓存大小
+ */
+#define     SHELL_VAR_CACHE_SIZE        8
+
+/**
+ * @brief 是否支持字符串中的变量替换
+ */
+#define     SHELL_SUPPORT_VAR_EXPAND    1
+
+/**
+ * @brief 是否支持表达式参数
+ */
+#define     SHELL_SUPPORT_EXPRESSION    1
+
+/**
+ * @brief 表达式缓存数量
+ */
+#define     SHELL_EXPR_CACHE_SIZE       4
 #endif
@@ -18,3 +18,20 @@ void cppTest(void)
 }
 SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
 cppTest, cppTest, cpp test);
+
+int cppTypedTest(int i, double d, const char *s, unsigned char c)
+{
+    Shell *shell = shellGetCurrent();
+    shellPrint(shell, "int: %d, double: %f, string: %s, uchar: %u\r\n", i, d, s, c);
+    return i;
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0),
+cppTypedTest, cppTypedTest, cpp typed test);
+
+void cppWideTest(long long timestamp, float scale)
+{
+    Shell *shell = shellGetCurrent();
+    shellPrint(shell, "timestamp: %lld, scale: %f\r\n", timestamp, scale);
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0),
+cppWideTest, cppWideTest, cpp wide type test);
@@ -14,6 +14,7 @@
 #include "shell_fs.h"
 #include "shell_passthrough.h"
 #include "shell_secure_user.h"
+#include "shell_job.h"
 #include "log.h"
 #include "telnetd.h"
 #include <stdio.h>
@@ -22,12 +23,21 @@
 #include <stddef.h>
 #include <string.h>
 #include <sys/time.h>
+#include <sys/ioctl.h>
+#include <poll.h>
 #include <pthread.h>
+#include <semaphore.h>
 
 Shell shell;
 char shellBuffer[512];
 ShellFs shellFs;
 char shellPathBuffer[512] = "/";
+#if SHELL_REDIRECT_BUFFER > 0
+char shellMemLogBuffer[16384];
+ShellFsMemFile shellMemFiles[] = {
+    {.name = "mem", .buffer = shellMemLogBuffer, .size = sizeof(shellMemLogBuffer)},
+};
+#endif
 Log log = {
     .active = 1,
     .level = LOG_DEBUG
@@ -83,27 +93,53 @@ unsigned short userShellWrite(char *data, unsigned short len)
  */
 unsigned short userShellRead(char *data, unsigned short len)
 {
-    unsigned short length = len;
-    while (length--)
+    struct pollfd fd = {.fd = STDIN_FILENO, .events = POLLIN};
+    ssize_t length;
+    if (poll(&fd, 1, 0) <= 0)
     {
-        *data++ = getchar();
+        return 0;
     }
-    return len;
+    length = read(STDIN_FILENO, data, len);
+    return length > 0 ? length : 0;
+}
+
+/**
+ * @brief 用户shell等待输入
+ * 
+ * @param timeout 等待时间(ms)
+ * @return int 有输入返回1，超时返回0
+ */
+int userShellWaitInput(unsigned int timeout)
+{
+    struct pollfd fd = {.fd = STDIN_FILENO, .events = POLLIN};
+    return poll(&fd, 1, timeout == SHELL_WAIT_FOREVER ? -1 : (int)timeout) > 0;
 }
 
 #if SHELL_USING_LOCK == 1
-static int lockCount = 0;
+static pthread_mutex_t userShellMutex;
+
+/**
+ * @brief 用户shell加锁
+ *        使用递归锁，命令执行期间可以再次加锁
+ * 
+ * @param shell shell对象
+ * @return int 0 成功
+ */
 int userShellLock(struct shell_def *shell)
 {
-    printf("lock: %d\r\n", lockCount);
-    return 0;
+    return pthread_mutex_lock(&userShellMutex);
 }
 
 
+/**
+ * @brief 用户shell解锁
+ * 
+ * @param shell shell对象
+ * @return int 0 成功
+ */
 int userShellUnlock(struct shell_def *shell)
 {
-    printf("unlock: %d\r\n", lockCount);
-    return 0;
+    return pthread_mutex_unlock(&userShellMutex);
 }
 #endif
 
@@ -131,6 +167,57 @@ size_t userShellListDir(char *path, char *buffer, size_t maxLen)
     return 0;
 }
 
+#if SHELL_REDIRECT_BUFFER > 0
+/**
+ * @brief 打开重定向文件
+ * 
+ * @param path 文件路径
+ * @param mode 打开方式
+ * @return void* 文件
+ */
+void *userShellFileOpen(const char *path, const char *mode)
+{
+    return fopen(path, mode);
+}
+
+/**
+ * @brief 关闭重定向文件
+ * 
+ * @param file 文件
+ * @return int 0 成功
+ */
+int userShellFileClose(void *file)
+{
+    return fclose(file);
+}
+
+/**
+ * @brief 读重定向文件
+ * 
+ * @param file 文件
+ * @param buffer 数据缓冲
+ * @param len 读取长度
+ * @return int 实际读取长度
+ */
+int userShellFileRead(void *file, char *buffer, unsigned short len)
+{
+    return fread(buffer, 1, len, file);
+}
+
+/**
+ * @brief 写重定向文件
+ * 
+ * @param file 文件
+ * @param buffer 数据
+ * @param len 数据长度
+ * @return int 实际写入长度
+ */
+int userShellFileWrite(void *file, const char *buffer, unsigned short len)
+{
+    return fwrite(buffer, 1, len, file);
+}
+#endif
+
 /**
  * @brief 新线程接口
  * 
@@ -146,31 +233,114 @@ int userNewThread(void *handler, void *param)
     return pthread_create(&tid, NULL, handler, param) == 0 ? 0 : -1;
 }
 
+/**
+ * @brief 延时接口
+ * 
+ * @param ms 延时时间(ms)
+ */
+void userDelay(unsigned int ms)
+{
+    usleep(ms * 1000);
+}
+
+#if SHELL_EXEC_QUEUE_SIZE > 0
+/**
+ * @brief shell命令执行线程的唤醒信号量，每次命令行入队时释放一次
+ */
+static sem_t userShellExecSem;
+
+/**
+ * @brief shell命令行入队通知，在输入线程中调用，唤醒命令执行线程
+ * 
+ * @param shell shell对象
+ */
+static void userShellExecNotify(Shell *shell)
+{
+    (void) shell;
+    sem_post(&userShellExecSem);
+}
+
+/**
+ * @brief shell命令执行线程
+ *        队列为空时等待入队通知，信号量会计数，执行期间入队的命令行不会错过
+ * 
+ * @param param shell对象
+ * 
+ * @return void* NULL
+ */
+static void *userShellExecutor(void *param)
+{
+    Shell *shell = (Shell *)param;
+
+    while (1)
+    {
+        if (!shellExecQueued(shell))
+        {
+            sem_wait(&userShellExecSem);
+        }
+    }
+    return NULL;
+}
+#endif
+
 /**
  * @brief 用户shell初始化
  * 
  */
 void userShellInit(void)
 {
+    struct winsize winSize;
+#if SHELL_USING_LOCK == 1
+    pthread_mutexattr_t attr;
+#endif
+
     shellFs.getcwd = getcwd;
     shellFs.chdir = chdir;
     shellFs.listdir = userShellListDir;
+#if SHELL_REDIRECT_BUFFER > 0
+    shellFs.file.open = userShellFileOpen;
+    shellFs.file.close = userShellFileClose;
+    shellFs.file.read = userShellFileRead;
+    shellFs.file.write = userShellFileWrite;
+    shellFsMemInit(&shellFs, shellMemFiles, sizeof(shellMemFiles) / sizeof(ShellFsMemFile));
+#endif
     shellFsInit(&shellFs, shellPathBuffer, 512);
 
     shell.write = userShellWrite;
     shell.read = userShellRead;
+    shell.waitInput = userShellWaitInput;
 #if SHELL_USING_LOCK == 1
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&userShellMutex, &attr);
+    pthread_mutexattr_destroy(&attr);
     shell.lock = userShellLock;
     shell.unlock = userShellUnlock;
 #endif
     shellSetPath(&shell, shellPathBuffer);
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &winSize) == 0)
+    {
+        shellSetTerminalSize(&shell, winSize.ws_col, winSize.ws_row);
+    }
     shellInit(&shell, shellBuffer, 512);
     shellCompanionAdd(&shell, SHELL_COMPANION_ID_FS, &shellFs);
+    shellCompanionAdd(&shell, SHELL_COMPANION_ID_FILE, &shellFs.file);
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    sem_init(&userShellExecSem, 0, 0);
+    shell.queue.notify = userShellExecNotify;
+    if (userNewThread(userShellExecutor, &shell) == 0)
+    {
+        shellSetExecQueue(&shell, 1);
+    }
+#endif
 
     log.write = terminalLogWrite;
     logRegister(&log, &shell);
 
-    telentdInit(userNewThread);
+    telentdInit(userNewThread, 0);
+#if SHELL_SUPPORT_BACKGROUND == 1
+    shellJobInit(userNewThread, userDelay);
+#endif
 
     // logDebug("hello world");
     // logHexDump(LOG_ALL_OBJ, LOG_DEBUG, (void *)&shell, sizeof(shell));
@@ -232,6 +402,17 @@ void shellKeyTest(void)
             }
             shellPrint(shell, "%02x ", data);
         }
+    #if SHELL_SUPPORT_CANCEL == 1
+        else if (shellIsCancelled())
+        {
+            shellWriteString(shell, "\r\n");
+            return;
+        }
+    #endif
+        else
+        {
+            shellWaitInput(shell, SHELL_WAIT_FOREVER);
+        }
     }
 }
 SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
@@ -283,11 +464,47 @@ void shellFuncSignatureTest(int a, char *b, char c)
 SHELL_EXPORT_CMD_SIGN(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
 funcSignatureTest, shellFuncSignatureTest, test function signature, isc);
 
+#if SHELL_USING_FUNC_INVOKER == 1
+int shellTypedTest(char c, short h, float f, char *s)
+{
+    printf("c = %c, h = %d, f = %f, s = %s\r\n", c, h, f, s);
+    return h;
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0),
+typedTest, shellTypedTest, test typed command, c, h, f, s);
+
+int shellWideTest(long long timestamp, double gain)
+{
+    printf("timestamp = %lld, gain = %.9f\r\n", timestamp, gain);
+    return 0;
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0),
+wideTest, shellWideTest, test wide type command, l, d);
+#endif
+
 typedef struct {
     int a;
     char *b;
 } TestStruct;
 
+#if SHELL_PARAM_ARENA_SIZE > 0
+int testStructParser(char *string, void **param)
+{
+    TestStruct *data = shellArenaAlloc(shellGetCurrent(), sizeof(TestStruct) + 16);
+    if (data == NULL)
+    {
+        return -1;
+    }
+    data->b = (char *)(data + 1);
+    if (sscanf(string, "%d %15s", &(data->a), data->b) == 2)
+    {
+        *param = (void *)data;
+        return 0;
+    }
+    return -1;
+}
+SHELL_EXPORT_PARAM_PARSER(0, LTestStruct;, testStructParser, NULL);
+#else
 int testStructParser(char *string, void **param)
 {
     TestStruct *data = malloc(sizeof(TestStruct));
@@ -308,6 +525,7 @@ int testStructClener(void *param)
     return 0;
 }
 SHELL_EXPORT_PARAM_PARSER(0, LTestStruct;, testStructParser, testStructClener);
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
 
 void shellParamParserTest(int a, TestStruct *data, char *c)
 {
@@ -337,6 +555,29 @@ int shellArrayTest(int a, int *b, char *c, TestStruct **datas)
 }
 SHELL_EXPORT_CMD_SIGN(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
 arrayTest, shellArrayTest, test array param parser, i[i[q[LTestStruct;);
+
+int shellArrayTypeTest(long long *a, double *b, int **c)
+{
+    int i, j;
+    for (i = 0; i < shellGetArrayParamSize(a); i++)
+    {
+        printf("a[%d] = %lld\r\n", i, a[i]);
+    }
+    for (i = 0; i < shellGetArrayParamSize(b); i++)
+    {
+        printf("b[%d] = %f\r\n", i, b[i]);
+    }
+    for (i = 0; i < shellGetArrayParamSize(c); i++)
+    {
+        for (j = 0; j < shellGetArrayParamSize(c[i]); j++)
+        {
+            printf("c[%d][%d] = %d\r\n", i, j, c[i][j]);
+        }
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD_SIGN(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
+arrayTypeTest, shellArrayTypeTest, test array param types, [l[d[[i);
 #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
 
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
@@ -353,3 +594,58 @@ int paramTest(int argc, char *argv[])
 }
 SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN),
 paramTest, paramTest, test param);
+
+int jobTest(int count)
+{
+    Shell *shell = shellGetCurrent();
+    for (int i = 0; i < count; i++)
+    {
+    #if SHELL_SUPPORT_BACKGROUND == 1
+        if (shellJobKilled())
+        {
+            return -1;
+        }
+    #endif
+    #if SHELL_SUPPORT_CANCEL == 1
+        if (shellIsCancelled())
+        {
+            return -1;
+        }
+    #endif
+        shellPrint(shell, "job test %d\r\n", i);
+        userDelay(1000);
+    }
+    return count;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
+jobTest, jobTest, background job test\r\njobTest 10 &);
+
+#if SHELL_SUPPORT_YIELD == 1
+typedef struct
+{
+    int count;
+    int index;
+} YieldTest;
+
+ShellYieldState yieldTest(ShellYield *yield, int argc, char *argv[])
+{
+    YieldTest *test = SHELL_YIELD_CONTEXT(yield, YieldTest);
+    SHELL_YIELD_BEGIN(yield);
+    test->count = argc > 1 ? atoi(argv[1]) : 3;
+    for (test->index = 0; test->index < test->count; test->index++)
+    {
+    #if SHELL_SUPPORT_CANCEL == 1
+        if (shellIsCancelled())
+        {
+            SHELL_YIELD_RETURN(yield, -1);
+        }
+    #endif
+        shellPrint(shellGetCurrent(), "yield test %d\r\n", test->index);
+        SHELL_YIELD_DELAY(yield, 1000);
+    }
+    yield->retVal = test->count;
+    SHELL_YIELD_END(yield);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_YIELD),
+yieldTest, yieldTest, yield command test\r\nyieldTest 10);
+#endif
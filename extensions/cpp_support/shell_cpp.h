@@ -12,9 +12,17 @@
 #define __SHELL_CPP_H__
 
 #ifdef __cplusplus
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
 extern "C" {
 
 #include "shell.h"
+#include "shell_ext.h"
 
 /**
  * @brief shell command cpp 支持 cmd 定义
@@ -28,6 +36,9 @@ typedef struct shell_command_cpp_cmd
 #if SHELL_USING_FUNC_SIGNATURE == 1
     const char *signature;                                      /**< 函数签名 */
 #endif
+#if SHELL_USING_FUNC_INVOKER == 1
+    int (*invoker)(ShellParam *);                               /**< 命令调用函数 */
+#endif
 } ShellCommandCppCmd;
 
 /**
@@ -42,6 +53,9 @@ typedef struct shell_command_cpp_var
 #if SHELL_USING_FUNC_SIGNATURE == 1
     void *unused;                                               /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
 #endif
+#if SHELL_USING_FUNC_INVOKER == 1
+    void *unusedInvoker;                                        /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
+#endif
 } ShellCommandCppVar;
 
 /**
@@ -56,6 +70,9 @@ typedef struct shell_command_cpp_user
 #if SHELL_USING_FUNC_SIGNATURE == 1
     void *unused;                                               /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
 #endif
+#if SHELL_USING_FUNC_INVOKER == 1
+    void *unusedInvoker;                                        /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
+#endif
 } ShellCommandCppUser;
 
 /**
@@ -70,6 +87,9 @@ typedef struct shell_command_cpp_key
 #if SHELL_USING_FUNC_SIGNATURE == 1
     void *unused;                                               /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
 #endif
+#if SHELL_USING_FUNC_INVOKER == 1
+    void *unusedInvoker;                                        /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
+#endif
 } ShellCommandCppKey;
 
 #if SHELL_USING_FUNC_SIGNATURE == 1
@@ -80,6 +100,9 @@ typedef struct shell_command_cpp_param_parser
     int (*parser)(char *, void **);;                            /**< 解析函数 */
     int (*cleaner)(void *);                                     /**< 清理函数 */
     void *unsed;                                                /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
+#if SHELL_USING_FUNC_INVOKER == 1
+    void *unusedInvoker;                                        /**< 未使用成员，需要保持和 ShellCommandCppCmd 大小一致 */
+#endif
 } ShellCommandCppParamParser;
 #endif
 
@@ -195,6 +218,423 @@ typedef struct shell_command_cpp_param_parser
 #endif /** SHELL_USING_CMD_EXPORT == 1 */
 
 }
+
+/**
+ * @brief 解析cpp命令的数字参数
+ *        支持`shellExtParseNum`可以解析的所有格式，以及`$`开头的变量
+ * 
+ * @param shell shell对象
+ * @param string 字符串参数
+ * @param real 按照浮点型解析变量，否则按照64位整型解析
+ * @param number 解析出的数字
+ * 
+ * @return int 0 解析成功 -1 解析失败
+ */
+static inline int shellCppParseNumber(Shell *shell, char *string, bool real, ShellNumber *number)
+{
+    if (*string == '$' && *(string + 1))
+    {
+        ShellParam param;
+        char type[2] = {real ? 'd' : 'l', 0};
+        if (shellExtParseParam(shell, string, type, &param) != 0)
+        {
+            return -1;
+        }
+        if (real)
+        {
+            number->type = NUM_TYPE_FLOAT;
+            number->real = param.real;
+            return 0;
+        }
+        number->type = NUM_TYPE_DEC;
+        number->negative = param.integer < 0;
+        number->integer = number->negative
+            ? 0ULL - (unsigned long long) param.integer : (unsigned long long) param.integer;
+        return 0;
+    }
+    if (shellExtParseNum(string, number) != 0)
+    {
+        shellWriteString(shell, "Invalid number: ");
+        shellWriteString(shell, string);
+        shellWriteString(shell, "\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 输出cpp命令参数溢出错误
+ * 
+ * @param shell shell对象
+ * @param string 字符串参数
+ * 
+ * @return int -1
+ */
+static inline int shellCppNumberOverflow(Shell *shell, char *string)
+{
+    shellWriteString(shell, "Number overflow: ");
+    shellWriteString(shell, string);
+    shellWriteString(shell, "\r\n");
+    return -1;
+}
+
+/**
+ * @brief cpp命令参数类型
+ *        每个支持的参数类型提供签名字符`sign`以及参数解析函数`parse`，
+ *        不支持的参数类型在导出命令时会编译失败
+ */
+template <typename T, typename Enable = void>
+struct ShellCppParam;
+
+/**
+ * @brief 整型参数，签名按照宽度为`q`, `h`, `i`, `l`
+ */
+template <typename T>
+struct ShellCppParam<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+    static constexpr char sign = sizeof(T) == 1 ? 'q'
+                               : sizeof(T) == 2 ? 'h'
+                               : sizeof(T) == 4 ? 'i' : 'l';
+
+    static int parse(Shell *shell, char *string, T *value)
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+        const unsigned long long max = std::numeric_limits<UnsignedT>::max();
+        ShellNumber number;
+        unsigned long long magnitude;
+        bool negative;
+
+        if (shellCppParseNumber(shell, string, false, &number) != 0)
+        {
+            return -1;
+        }
+        if (number.type == NUM_TYPE_FLOAT)
+        {
+            double real = number.real;
+            negative = real < 0;
+            real = negative ? -real : real;
+            if (real >= 18446744073709551616.0)
+            {
+                return shellCppNumberOverflow(shell, string);
+            }
+            magnitude = (unsigned long long) real;
+        }
+        else
+        {
+            negative = number.negative;
+            magnitude = number.integer;
+        }
+        if (negative ? (magnitude > (max >> 1) + 1) : (magnitude > max))
+        {
+            return shellCppNumberOverflow(shell, string);
+        }
+        *value = (T) (UnsignedT) (negative ? 0ULL - magnitude : magnitude);
+        return 0;
+    }
+};
+
+/**
+ * @brief 字符参数，签名为`c`
+ */
+template <>
+struct ShellCppParam<char, void>
+{
+    static constexpr char sign = 'c';
+
+    static int parse(Shell *shell, char *string, char *value)
+    {
+        *value = (*string == '\'' && *(string + 1)) ? string[1] : string[0];
+        return 0;
+    }
+};
+
+/**
+ * @brief 布尔参数，签名为`q`，非0值为`true`
+ */
+template <>
+struct ShellCppParam<bool, void>
+{
+    static constexpr char sign = 'q';
+
+    static int parse(Shell *shell, char *string, bool *value)
+    {
+        unsigned long long integer;
+        if (ShellCppParam<unsigned long long>::parse(shell, string, &integer) != 0)
+        {
+            return -1;
+        }
+        *value = integer != 0;
+        return 0;
+    }
+};
+
+/**
+ * @brief 浮点型参数，签名为`f`, `d`
+ */
+template <typename T>
+struct ShellCppParam<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static constexpr char sign = sizeof(T) == sizeof(float) ? 'f' : 'd';
+
+    static int parse(Shell *shell, char *string, T *value)
+    {
+        ShellNumber number;
+        double real;
+
+        if (shellCppParseNumber(shell, string, true, &number) != 0)
+        {
+            return -1;
+        }
+        real = number.type == NUM_TYPE_FLOAT ? number.real
+            : (number.negative ? -(double) number.integer : (double) number.integer);
+        if (sizeof(T) < sizeof(double))
+        {
+            /* 比最大值大不到半个最小精度的数值会舍入为最大值，不算溢出 */
+            double limit = (double) std::numeric_limits<T>::max()
+                + std::ldexp(1.0, std::numeric_limits<T>::max_exponent
+                                  - std::numeric_limits<T>::digits - 1);
+            if (real >= limit || real <= -limit)
+            {
+                return shellCppNumberOverflow(shell, string);
+            }
+        }
+        *value = (T) real;
+        return 0;
+    }
+};
+
+/**
+ * @brief 字符串参数，签名为`s`
+ */
+template <>
+struct ShellCppParam<char *, void>
+{
+    static constexpr char sign = 's';
+
+    static int parse(Shell *shell, char *string, char **value)
+    {
+        *value = string;
+        return 0;
+    }
+};
+
+template <>
+struct ShellCppParam<const char *, void> : ShellCppParam<char *, void>
+{
+    static int parse(Shell *shell, char *string, const char **value)
+    {
+        *value = string;
+        return 0;
+    }
+};
+
+/**
+ * @brief 指针参数，签名为`p`，参数为地址或者变量
+ */
+template <typename T>
+struct ShellCppParam<T *, void>
+{
+    static constexpr char sign = 'p';
+
+    static int parse(Shell *shell, char *string, T **value)
+    {
+        size_t address;
+        if (ShellCppParam<size_t>::parse(shell, string, &address) != 0)
+        {
+            return -1;
+        }
+        *value = (T *) address;
+        return 0;
+    }
+};
+
+/**
+ * @brief 编译期参数索引序列
+ */
+template <unsigned int... Index>
+struct ShellCppIndex {};
+
+template <unsigned int N, unsigned int... Index>
+struct ShellCppMakeIndex : ShellCppMakeIndex<N - 1, N - 1, Index...> {};
+
+template <unsigned int... Index>
+struct ShellCppMakeIndex<0, Index...>
+{
+    typedef ShellCppIndex<Index...> type;
+};
+
+/**
+ * @brief cpp命令函数签名，由参数类型在编译期生成
+ */
+template <typename... Args>
+struct ShellCppSignature
+{
+    static const char value[sizeof...(Args) + 1];
+};
+
+template <typename... Args>
+const char ShellCppSignature<Args...>::value[sizeof...(Args) + 1] =
+    { ShellCppParam<Args>::sign..., '\0' };
+
+/**
+ * @brief cpp命令返回值转换
+ *        shell命令的返回值为`int`，整型以及枚举经过`size_t`转换后保留低位，
+ *        浮点型截断为整数并限制在`int`的范围内，其他类型在导出命令时会编译失败
+ */
+template <typename R, typename Enable = void>
+struct ShellCppReturn
+{
+    static_assert(std::is_integral<R>::value || std::is_enum<R>::value,
+                  "shell cpp command must return void, arithmetic, enum or pointer type");
+
+    static int convert(R value)
+    {
+        return (int) (size_t) value;
+    }
+};
+
+/**
+ * @brief 指针返回值，经过`intptr_t`转换后保留低位
+ */
+template <typename R>
+struct ShellCppReturn<R *, void>
+{
+    static int convert(R *value)
+    {
+        return (int) (std::intptr_t) value;
+    }
+};
+
+/**
+ * @brief 浮点型返回值
+ */
+template <typename R>
+struct ShellCppReturn<R, typename std::enable_if<std::is_floating_point<R>::value>::type>
+{
+    static int convert(R value)
+    {
+        if (value != value)
+        {
+            return 0;
+        }
+        if (value >= (R) std::numeric_limits<int>::max())
+        {
+            return std::numeric_limits<int>::max();
+        }
+        if (value <= (R) std::numeric_limits<int>::min())
+        {
+            return std::numeric_limits<int>::min();
+        }
+        return (int) value;
+    }
+};
+
+/**
+ * @brief cpp命令函数调用
+ *        返回值为`void`的函数返回0
+ */
+template <typename R>
+struct ShellCppCall
+{
+    template <typename F, typename... Args>
+    static int call(F func, Args... args)
+    {
+        return ShellCppReturn<typename std::decay<R>::type>::convert(func(args...));
+    }
+};
+
+template <>
+struct ShellCppCall<void>
+{
+    template <typename F, typename... Args>
+    static int call(F func, Args... args)
+    {
+        func(args...);
+        return 0;
+    }
+};
+
+/**
+ * @brief cpp命令
+ *        根据函数类型生成main形式的命令函数，按照参数类型依次解析参数后直接调用命令函数
+ * 
+ * @tparam F 命令函数类型
+ * @tparam func 命令函数
+ */
+template <typename F, F func>
+struct ShellCppCommand;
+
+template <typename R, typename... Args, R (*func)(Args...)>
+struct ShellCppCommand<R (*)(Args...), func>
+{
+    typedef ShellCppSignature<typename std::decay<Args>::type...> Signature;
+
+    template <unsigned int... Index>
+    static int invoke(Shell *shell, char *argv[], ShellCppIndex<Index...>)
+    {
+        std::tuple<typename std::decay<Args>::type...> params;
+        int ret = 0;
+        int results[] = {
+            (ret != 0 ? -1 : (ret = ShellCppParam<typename std::decay<Args>::type>::parse(
+                shell, argv[Index + 1], &std::get<Index>(params))))..., 0
+        };
+        (void) results;
+        if (ret != 0)
+        {
+            return -1;
+        }
+        return ShellCppCall<R>::call(func, std::get<Index>(params)...);
+    }
+
+    static int run(int argc, char *argv[])
+    {
+        Shell *shell = shellGetCurrent();
+        if (argc - 1 != (int) sizeof...(Args))
+        {
+            shellWriteString(shell, "Parameters number incorrect\r\n");
+            return -1;
+        }
+        return invoke(shell, argv, typename ShellCppMakeIndex<sizeof...(Args)>::type());
+    }
+};
+
+#if SHELL_USING_CMD_EXPORT == 1
+
+#if SHELL_USING_FUNC_SIGNATURE == 1
+    /**
+     * @brief shell cpp命令签名，仅用于记录，命令执行时不解析签名
+     */
+    #define SHELL_CPP_FUNC_SIGNATURE(_func) \
+            , ShellCppCommand<decltype(&_func), &_func>::Signature::value
+#else
+    #define SHELL_CPP_FUNC_SIGNATURE(_func)
+#endif
+
+    /**
+     * @brief shell cpp命令定义
+     *        在编译期根据命令函数的参数类型生成函数签名以及调用函数，命令以main形式导出，
+     *        执行时按照参数类型解析参数，并以正确的类型直接调用命令函数
+     *        支持整型，字符，布尔，浮点型，字符串以及指针类型的参数
+     * 
+     * @param _attr 命令属性
+     * @param _name 命令名
+     * @param _func 命令函数
+     * @param _desc 命令描述
+     */
+    #define SHELL_EXPORT_CPP_FUNC(_attr, _name, _func, _desc) \
+            const char shellCmd##_name[] = #_name; \
+            const char shellDesc##_name[] = #_desc; \
+            extern "C" SHELL_USED const ShellCommandCppCmd \
+            shellCommand##_name SHELL_SECTION("shellCommand") =  \
+            { \
+                _attr|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN), \
+                shellCmd##_name, \
+                (int (*)())ShellCppCommand<decltype(&_func), &_func>::run, \
+                shellDesc##_name \
+                SHELL_CPP_FUNC_SIGNATURE(_func) \
+            }
+#endif /** SHELL_USING_CMD_EXPORT == 1 */
+
 #endif /**< defined __cplusplus */
 
 #endif /**< __SHELL_CPP_H__ */
@@ -11,6 +11,20 @@
 #include "shell_fs.h"
 #include "shell.h"
 #include "stdio.h"
+#include "string.h"
+
+#if SHELL_USING_COMPANION == 1
+/**
+ * @brief 内存文件表
+ *        文件操作接口没有上下文参数，所以内存文件表由所有`ShellFs`对象共享
+ */
+static struct
+{
+    ShellFsMemFile *files;              /**< 内存文件 */
+    unsigned short count;               /**< 内存文件数量 */
+    ShellFile next;                     /**< 其他文件使用的文件操作接口 */
+} shellFsMem;
+#endif /** SHELL_USING_COMPANION == 1 */
 
 /**
  * @brief 改变当前路径(shell调用)
@@ -29,6 +43,7 @@ void shellCD(char *dir)
         shellWriteString(shell, " is not a directory\r\n");
     }
     shellFs->getcwd(shellFs->info.path, shellFs->info.pathLen);
+    shellSetPath(shell, shellFs->info.path);
 }
 SHELL_EXPORT_CMD(
 SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
@@ -72,3 +87,142 @@ void shellFsInit(ShellFs *shellFs, char *pathBuffer, size_t pathLen)
     shellFs->info.pathLen = pathLen;
     shellFs->getcwd(shellFs->info.path, pathLen);
 }
+
+
+#if SHELL_USING_COMPANION == 1
+/**
+ * @brief 查找内存文件
+ * 
+ * @param file 文件
+ * @return ShellFsMemFile* 内存文件，不是内存文件时返回NULL
+ */
+static ShellFsMemFile *shellFsMemFind(void *file)
+{
+    for (unsigned short i = 0; i < shellFsMem.count; i++)
+    {
+        if (file == &shellFsMem.files[i])
+        {
+            return &shellFsMem.files[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 打开文件，文件名和内存文件匹配时打开内存文件，否则使用其他文件操作接口打开
+ * 
+ * @param path 文件路径
+ * @param mode 打开方式，"w"清空内存文件，"a"追加到末尾，"r"从头读取
+ * @return void* 文件
+ */
+static void *shellFsMemOpen(const char *path, const char *mode)
+{
+    for (unsigned short i = 0; i < shellFsMem.count; i++)
+    {
+        if (strcmp(path, shellFsMem.files[i].name) == 0)
+        {
+            if (mode[0] == 'w')
+            {
+                shellFsMem.files[i].length = 0;
+            }
+            shellFsMem.files[i].offset = 0;
+            return &shellFsMem.files[i];
+        }
+    }
+    return shellFsMem.next.open ? shellFsMem.next.open(path, mode) : NULL;
+}
+
+/**
+ * @brief 关闭文件
+ * 
+ * @param file 文件
+ * @return int 0 成功
+ */
+static int shellFsMemClose(void *file)
+{
+    if (shellFsMemFind(file))
+    {
+        return 0;
+    }
+    return shellFsMem.next.close ? shellFsMem.next.close(file) : -1;
+}
+
+/**
+ * @brief 读文件
+ * 
+ * @param file 文件
+ * @param buffer 数据缓冲
+ * @param len 读取长度
+ * @return int 实际读取长度
+ */
+static int shellFsMemRead(void *file, char *buffer, unsigned short len)
+{
+    ShellFsMemFile *memFile = shellFsMemFind(file);
+
+    if (memFile == NULL)
+    {
+        return shellFsMem.next.read ? shellFsMem.next.read(file, buffer, len) : -1;
+    }
+    if (len > memFile->length - memFile->offset)
+    {
+        len = memFile->length - memFile->offset;
+    }
+    memcpy(buffer, memFile->buffer + memFile->offset, len);
+    memFile->offset += len;
+    return len;
+}
+
+/**
+ * @brief 写文件，内存文件写满时只写入部分数据，写满后返回0
+ * 
+ * @param file 文件
+ * @param buffer 数据
+ * @param len 数据长度
+ * @return int 实际写入长度
+ */
+static int shellFsMemWrite(void *file, const char *buffer, unsigned short len)
+{
+    ShellFsMemFile *memFile = shellFsMemFind(file);
+
+    if (memFile == NULL)
+    {
+        return shellFsMem.next.write ? shellFsMem.next.write(file, buffer, len) : -1;
+    }
+    if (len > memFile->size - memFile->length)
+    {
+        len = memFile->size - memFile->length;
+    }
+    memcpy(memFile->buffer + memFile->length, buffer, len);
+    memFile->length += len;
+    return len;
+}
+
+/**
+ * @brief 初始化内存文件
+ *        内存文件可以作为重定向的目标，比如`cmds > log`，`grep Test < log`，
+ *        文件名和内存文件不匹配时，使用调用前`shellFs->file`中的文件操作接口，
+ *        需要在设置`shellFs->file`之后调用
+ * 
+ * @param shellFs shell文件系统对象
+ * @param files 内存文件
+ * @param count 内存文件数量
+ */
+void shellFsMemInit(ShellFs *shellFs, ShellFsMemFile *files, unsigned short count)
+{
+    for (unsigned short i = 0; i < count; i++)
+    {
+        files[i].length = 0;
+        files[i].offset = 0;
+    }
+    shellFsMem.files = files;
+    shellFsMem.count = count;
+    if (shellFs->file.open != shellFsMemOpen)
+    {
+        shellFsMem.next = shellFs->file;
+    }
+    shellFs->file.open = shellFsMemOpen;
+    shellFs->file.close = shellFsMemClose;
+    shellFs->file.read = shellFsMemRead;
+    shellFs->file.write = shellFsMemWrite;
+}
+#endif /** SHELL_USING_COMPANION == 1 */
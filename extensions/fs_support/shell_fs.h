@@ -16,16 +16,33 @@
 
 #define     SHELL_FS_VERSION                "1.0.0"
 
-#define     SHELL_COMPANION_ID_FS           -1
-
 #define     SHELL_FS_LIST_FILE_BUFFER_MAX   4096
 
+#if SHELL_USING_COMPANION == 1
+/**
+ * @brief shell内存文件
+ *        作为重定向的目标，数据保存在用户提供的缓冲中，写满后的数据被丢弃
+ */
+typedef struct shell_fs_mem_file
+{
+    const char *name;                   /**< 文件名，重定向时按照完整的文件名匹配 */
+    char *buffer;                       /**< 文件数据缓冲 */
+    size_t size;                        /**< 缓冲大小 */
+    size_t length;                      /**< 文件数据长度 */
+    size_t offset;                      /**< 读取位置 */
+} ShellFsMemFile;
+#endif /** SHELL_USING_COMPANION == 1 */
+
 /**
  * @brief shell文件系统支持结构体
- * 
+ *        `file`为文件操作接口，用于命令的输入输出重定向，需要作为`SHELL_COMPANION_ID_FILE`伴生对象添加，
+ *        不使用重定向时可以不设置
  */
 typedef struct shell_fs
 {
+#if SHELL_USING_COMPANION == 1
+    ShellFile file;
+#endif
     size_t (*getcwd)(char *, size_t);
     size_t (*chdir)(char *);
     size_t (*listdir)(char *dir, char *buffer, size_t maxLen);
@@ -37,5 +54,8 @@ typedef struct shell_fs
 } ShellFs;
 
 void shellFsInit(ShellFs *shellFs, char *pathBuffer, size_t pathLen);
+#if SHELL_USING_COMPANION == 1
+void shellFsMemInit(ShellFs *shellFs, ShellFsMemFile *files, unsigned short count);
+#endif
 
 #endif
@@ -17,23 +17,40 @@
 #define getchar()   shellGetChar(shell2048)
 
 #define SIZE 4
+#define BOARD_WIDTH (SIZE*7)
 uint32_t score=0;
 uint8_t scheme=0;
+uint16_t margin=0;
 
 Shell *shell2048 = NULL;
 
 char shellGetChar(Shell *shell) {
     char data;
-    if (shell->read && shell->read(&data, 1) == 1) {
-        return data;
-    } else {
-        return -1;
+    while (shell->read) {
+        if (shell->read(&data, 1) == 1) {
+            return data;
+        }
+#if SHELL_SUPPORT_CANCEL == 1
+        if (shellIsCancelled()) {
+            break;
+        }
+#endif
+        if (shell->waitInput == NULL) {
+            break;
+        }
+        shellWaitInput(shell, SHELL_WAIT_FOREVER);
     }
+    return -1;
 }
 
-void sleep(int ms) {
+static void delay(int ms) {
     int time = SHELL_GET_TICK();
-    while (SHELL_GET_TICK() - time < ms) ;
+    int remain;
+    while ((remain = ms - (int)(SHELL_GET_TICK() - time)) > 0) {
+        if (!shellWaitInput(shell2048, remain) && shell2048->waitInput) {
+            break;
+        }
+    }
 }
 
 void getColor(uint8_t value, char *color, size_t length) {
@@ -57,9 +74,10 @@ void drawBoard(uint8_t board[SIZE][SIZE]) {
 	char color[40], reset[] = "\033[m";
 	printf("\033[H");
 
-	printf("2048.c %17d pts\n\n",score);
+	printf("%*s2048.c %17d pts\n\n",margin,"",score);
 
 	for (y=0;y<SIZE;y++) {
+		printf("%*s",margin,"");
 		for (x=0;x<SIZE;x++) {
 			getColor(board[x][y],color,40);
 			printf("%s",color);
@@ -67,6 +85,7 @@ void drawBoard(uint8_t board[SIZE][SIZE]) {
 			printf("%s",reset);
 		}
 		printf("\n");
+		printf("%*s",margin,"");
 		for (x=0;x<SIZE;x++) {
 			getColor(board[x][y],color,40);
 			printf("%s",color);
@@ -81,6 +100,7 @@ void drawBoard(uint8_t board[SIZE][SIZE]) {
 			printf("%s",reset);
 		}
 		printf("\n");
+		printf("%*s",margin,"");
 		for (x=0;x<SIZE;x++) {
 			getColor(board[x][y],color,40);
 			printf("%s",color);
@@ -90,7 +110,7 @@ void drawBoard(uint8_t board[SIZE][SIZE]) {
 		printf("\n");
 	}
 	printf("\n");
-	printf("        ←,↑,→,↓ or q        \n");
+	printf("%*s        ←,↑,→,↓ or q        \n",margin,"");
 	printf("\033[A"); // one line up
 }
 
@@ -361,6 +381,9 @@ int main_2048(int argc, char *argv[]) {
 		scheme = 2;
 	}
 
+	// center the board when the terminal width is known
+	margin = shell2048->info.width > BOARD_WIDTH ? (shell2048->info.width-BOARD_WIDTH)/2 : 0;
+
 	printf("\033[?25l\033[2J");
 
 	initBoard(board);
@@ -391,16 +414,16 @@ int main_2048(int argc, char *argv[]) {
 		}
 		if (success) {
 			drawBoard(board);
-			sleep(150);
+			delay(150);
 			addRandom(board);
 			drawBoard(board);
 			if (gameEnded(board)) {
-				printf("         GAME OVER          \n");
+				printf("%*s         GAME OVER          \n",margin,"");
 				break;
 			}
 		}
 		if (c=='q') {
-			printf("        QUIT? (y/n)         \n");
+			printf("%*s        QUIT? (y/n)         \n",margin,"");
 			c=getchar();
 			if (c=='y') {
 				break;
@@ -408,7 +431,7 @@ int main_2048(int argc, char *argv[]) {
 			drawBoard(board);
 		}
 		if (c=='r') {
-			printf("       RESTART? (y/n)       \n");
+			printf("%*s       RESTART? (y/n)       \n",margin,"");
 			c=getchar();
 			if (c=='y') {
 				initBoard(board);
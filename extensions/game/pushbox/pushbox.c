@@ -14,11 +14,21 @@ Shell *shellPushbox = NULL;
 
 static char shellGetChar(Shell *shell) {
     char data;
-    if (shell->read && shell->read(&data, 1) == 1) {
-        return data;
-    } else {
-        return -1;
+    while (shell->read) {
+        if (shell->read(&data, 1) == 1) {
+            return data;
+        }
+#if SHELL_SUPPORT_CANCEL == 1
+        if (shellIsCancelled()) {
+            break;
+        }
+#endif
+        if (shell->waitInput == NULL) {
+            break;
+        }
+        shellWaitInput(shell, SHELL_WAIT_FOREVER);
     }
+    return -1;
 }
 
 
@@ -63,9 +73,11 @@ void pushbox_init()
 //打印地图
 void pushbox_print_map()
 {
-    printf( "\r\n  LetterShell PushBox!\r\n");
+    //终端宽度已知时居中显示，每次从左上角重绘，不滚动屏幕
+    int margin = shellPushbox->info.width > 22 ? (shellPushbox->info.width - 22) / 2 : 0;
+    printf( "\033[H\r\n%*s  LetterShell PushBox!\r\n", margin, "");
     for (int i = 0; i < 7; i++) {
-        printf( "  ");
+        printf( "%*s  ", margin, "");
         for (int j = 0; j < 8; j++) {
             switch (boards[i][j]) {
             case 0:
@@ -89,7 +101,7 @@ void pushbox_print_map()
         }
         printf( "\r\n");
     }
-	printf("w,a,s,d or q\n");
+	printf("%*sw,a,s,d or q\n", margin, "");
 }
 
 //推箱子
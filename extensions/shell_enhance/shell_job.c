@@ -0,0 +1,500 @@
+/**
+ * @file shell_job.c
+ * @author Letter(nevermindzzt@gmail.com)
+ * @brief shell background job
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#include "shell_job.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#if SHELL_SUPPORT_BACKGROUND == 1
+
+#if SHELL_SUPPORT_END_LINE != 1
+#error "shell_job requires SHELL_SUPPORT_END_LINE"
+#endif
+
+#if SHELL_USING_LOCK != 1
+#error "shell_job requires SHELL_USING_LOCK"
+#endif
+
+extern unsigned int shellRunCommand(Shell *shell, ShellCommand *command);
+
+static ShellJob shellJobTable[SHELL_JOB_MAX_NUMBER];
+static ShellJobNewThread shellJobNewThread = NULL;
+static ShellJobDelay shellJobDelay = NULL;
+static unsigned short shellJobCount = 0;
+
+
+/**
+ * @brief 查找运行命令的shell对应的后台任务
+ *
+ * @param shell shell对象
+ *
+ * @return ShellJob* 后台任务，不是后台任务时返回NULL
+ */
+static ShellJob *shellJobFind(Shell *shell)
+{
+    for (short i = 0; shell && i < SHELL_JOB_MAX_NUMBER; i++)
+    {
+        if (SHELL_ATOMIC_LOAD(&shellJobTable[i].state) == SHELL_JOB_RUNNING && shellJobTable[i].shell == shell)
+        {
+            return &shellJobTable[i];
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief 根据任务号查找后台任务
+ *
+ * @param owner 所属shell
+ * @param id 任务号，为0时查找最近的一个任务
+ *
+ * @return ShellJob* 后台任务，未找到时返回NULL
+ */
+static ShellJob *shellJobGet(Shell *owner, unsigned short id)
+{
+    ShellJob *job = NULL;
+    for (short i = 0; i < SHELL_JOB_MAX_NUMBER; i++)
+    {
+        if (shellJobTable[i].state != SHELL_JOB_FREE && shellJobTable[i].owner == owner
+            && (id == 0 ? (job == NULL || shellJobTable[i].id > job->id)
+                        : shellJobTable[i].id == id))
+        {
+            job = &shellJobTable[i];
+        }
+    }
+    return job;
+}
+
+
+/**
+ * @brief 通过所属shell的尾行模式写入后台任务的输出，任务已和所属shell分离时丢弃
+ *
+ * @param job 后台任务
+ * @param data 数据
+ * @param len 数据长度
+ */
+static void shellJobOutput(ShellJob *job, char *data, int len)
+{
+    unsigned char state = SHELL_JOB_OUTPUT_IDLE;
+    if (SHELL_ATOMIC_CAS(&job->outputState, &state, SHELL_JOB_OUTPUT_BUSY))
+    {
+        shellWriteEndLine(job->owner, data, len);
+        SHELL_ATOMIC_STORE(&job->outputState, SHELL_JOB_OUTPUT_IDLE);
+    }
+}
+
+
+/**
+ * @brief 后台任务写函数
+ *        后台任务的输出按行缓冲，遇到换行或者缓冲满时通过所属shell的尾行模式写入，
+ *        不会打断正在输入的命令行
+ *
+ * @param data 数据
+ * @param len 数据长度
+ *
+ * @return signed short 写入的数据长度
+ */
+static signed short shellJobWrite(char *data, unsigned short len)
+{
+    ShellJob *job = shellJobFind(shellGetCurrent());
+    if (job == NULL)
+    {
+        return 0;
+    }
+    for (unsigned short i = 0; i < len; i++)
+    {
+        job->output[job->length++] = data[i];
+        if (data[i] == '\n' || job->length == SHELL_JOB_OUTPUT_SIZE)
+        {
+            shellJobOutput(job, job->output, job->length);
+            job->length = 0;
+        }
+    }
+    return len;
+}
+
+
+/**
+ * @brief 后台任务读函数，后台任务没有输入
+ *
+ * @param data 数据
+ * @param len 数据长度
+ *
+ * @return signed short 0
+ */
+static signed short shellJobRead(char *data, unsigned short len)
+{
+    (void) data;
+    (void) len;
+    return 0;
+}
+
+
+/**
+ * @brief 后台任务线程
+ *
+ * @param param 后台任务
+ *
+ * @return void* NULL
+ */
+static void *shellJobEntry(void *param)
+{
+    ShellJob *job = (ShellJob *)param;
+    char buffer[48];
+    int length;
+
+    job->retVal = (int)shellRunCommand(job->shell, job->command);
+    if (job->length > 0)
+    {
+        shellJobOutput(job, job->output, job->length);
+        job->length = 0;
+    }
+
+    length = snprintf(buffer, sizeof(buffer), "[%d] %s: %s\r\n", job->id,
+                      SHELL_ATOMIC_LOAD(&job->killed) ? "Killed" : "Done", job->command->data.cmd.name);
+    if (length > (int)sizeof(buffer) - 1)
+    {
+        length = sizeof(buffer) - 1;
+    }
+    shellJobOutput(job, buffer, length);
+
+    SHELL_FREE(job->shell);
+    job->shell = NULL;
+    SHELL_ATOMIC_STORE(&job->state, SHELL_JOB_DONE);
+    return NULL;
+}
+
+
+/**
+ * @brief 在后台运行命令
+ *        占用任务表中空闲或者已结束的任务，复制所属shell以及命令参数，然后在新线程中运行命令
+ *
+ * @param shell 解析命令的shell对象
+ * @param command 命令
+ * @param argc 参数数量
+ * @param argv 参数
+ *
+ * @return int 派发成功返回0，否则返回-1
+ */
+static int shellJobRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
+{
+    ShellJob *job = NULL;
+    unsigned short offset = 0;
+
+    if (command->attr.attrs.type != SHELL_TYPE_CMD_MAIN
+        && command->attr.attrs.type != SHELL_TYPE_CMD_FUNC)
+    {
+        return -1;
+    }
+    for (short i = 0; job == NULL && i < SHELL_JOB_MAX_NUMBER; i++)
+    {
+        unsigned char state = SHELL_ATOMIC_LOAD(&shellJobTable[i].state);
+        if (state != SHELL_JOB_RUNNING
+            && SHELL_ATOMIC_CAS(&shellJobTable[i].state, &state, SHELL_JOB_RUNNING))
+        {
+            job = &shellJobTable[i];
+        }
+    }
+    if (job == NULL)
+    {
+        shellWriteString(shell, "Job table full\r\n");
+        return -1;
+    }
+
+    job->owner = shell;
+    job->command = command;
+    job->killed = 0;
+    job->outputState = SHELL_JOB_OUTPUT_IDLE;
+    job->length = 0;
+    job->shell = SHELL_MALLOC(sizeof(Shell));
+    if (job->shell == NULL)
+    {
+        job->state = SHELL_JOB_FREE;
+        return -1;
+    }
+    memcpy(job->shell, shell, sizeof(Shell));
+#if SHELL_SUPPORT_CANCEL == 1
+    job->shell->cancel.flag = 0;
+    job->shell->cancel.timeout = 0;
+    job->shell->cancel.pendingLength = 0;
+#endif
+    for (short i = 0; i < argc; i++)
+    {
+        unsigned short length = strlen(argv[i]) + 1;
+        if (offset + length > SHELL_JOB_BUFFER_SIZE)
+        {
+            SHELL_FREE(job->shell);
+            job->shell = NULL;
+            job->state = SHELL_JOB_FREE;
+            return -1;
+        }
+        memcpy(job->buffer + offset, argv[i], length);
+        if (job->shell->parser.token[i].start == argv[i])
+        {
+            job->shell->parser.token[i].start = job->buffer + offset;
+        }
+        job->shell->parser.param[i] = job->buffer + offset;
+        offset += length;
+    }
+    job->shell->parser.paramCount = argc;
+    job->shell->parser.buffer = job->buffer;
+    job->shell->parser.bufferSize = SHELL_JOB_BUFFER_SIZE;
+    job->shell->parser.length = 0;
+    job->shell->parser.cursor = 0;
+    job->shell->read = shellJobRead;
+    job->shell->write = shellJobWrite;
+    job->shell->waitInput = NULL;
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    job->shell->status.isMachine = 0;
+#endif
+
+    job->id = ++shellJobCount;
+    if (job->id == 0)
+    {
+        job->id = shellJobCount = 1;
+    }
+    shellPrint(shell, "[%d] %s\r\n", job->id, command->data.cmd.name);
+    if (shellJobNewThread == NULL || shellJobNewThread(shellJobEntry, job) != 0)
+    {
+        SHELL_FREE(job->shell);
+        job->shell = NULL;
+        job->state = SHELL_JOB_FREE;
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief 判断当前后台任务是否被请求结束
+ *        `kill`只设置结束标志，长时间运行的命令需要周期调用此函数，返回非0时尽快返回
+ *
+ * @return int 被请求结束返回1，否则返回0，不是后台任务时返回0
+ */
+int shellJobKilled(void)
+{
+    ShellJob *job = shellJobFind(shellGetCurrent());
+    return job ? SHELL_ATOMIC_LOAD(&job->killed) : 0;
+}
+
+
+/**
+ * @brief 移除shell时分离其后台任务
+ *        运行中的任务被请求结束，之后的输出被丢弃，正在写入的输出结束后才返回
+ *
+ * @param shell 被移除的shell对象
+ */
+static void shellJobRemove(Shell *shell)
+{
+    for (short i = 0; i < SHELL_JOB_MAX_NUMBER; i++)
+    {
+        ShellJob *job = &shellJobTable[i];
+        unsigned char state = SHELL_JOB_OUTPUT_IDLE;
+
+        if (SHELL_ATOMIC_LOAD(&job->state) == SHELL_JOB_FREE || job->owner != shell)
+        {
+            continue;
+        }
+        SHELL_ATOMIC_STORE(&job->killed, 1);
+        while (!SHELL_ATOMIC_CAS(&job->outputState, &state, SHELL_JOB_OUTPUT_DETACHED)
+               && state != SHELL_JOB_OUTPUT_DETACHED)
+        {
+            state = SHELL_JOB_OUTPUT_IDLE;
+            if (shellJobDelay)
+            {
+                shellJobDelay(1);
+            }
+        }
+        job->owner = NULL;
+    }
+}
+
+
+/**
+ * @brief 后台任务初始化
+ *
+ * @param newThread 新线程接口
+ * @param delay 延时接口，为NULL时不支持`fg`
+ *
+ * @return int 0
+ */
+int shellJobInit(ShellJobNewThread newThread, ShellJobDelay delay)
+{
+    SHELL_ASSERT(newThread, return -1);
+    shellJobNewThread = newThread;
+    shellJobDelay = delay;
+    shellSetBackground(shellJobRun, shellJobRemove);
+    return 0;
+}
+
+
+/**
+ * @brief 列出后台任务
+ *
+ * @return int 0
+ */
+int shellJobList(void)
+{
+    Shell *shell = shellGetCurrent();
+    SHELL_ASSERT(shell, return -1);
+    for (short i = 0; i < SHELL_JOB_MAX_NUMBER; i++)
+    {
+        ShellJob *job = &shellJobTable[i];
+        if (job->state != SHELL_JOB_FREE && job->owner == shell)
+        {
+            shellPrint(shell, "[%d] %-8s%s\r\n", job->id,
+                       job->state == SHELL_JOB_DONE ? "Done" : (job->killed ? "Killing" : "Running"),
+                       job->command->data.cmd.name);
+        }
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+jobs, shellJobList, list background jobs);
+
+
+/**
+ * @brief 检查`fg`等待的后台任务是否仍在运行
+ *        `fg`被取消时请求任务结束
+ *
+ * @param job 后台任务
+ *
+ * @return int 1 仍在运行 0 已结束
+ */
+static int shellJobRunning(ShellJob *job)
+{
+#if SHELL_SUPPORT_CANCEL == 1
+    if (shellIsCancelled())
+    {
+        SHELL_ATOMIC_STORE(&job->killed, 1);
+    }
+#endif
+    return SHELL_ATOMIC_LOAD(&job->state) == SHELL_JOB_RUNNING;
+}
+
+
+#if SHELL_SUPPORT_YIELD == 1
+/**
+ * @brief 等待后台任务结束
+ *        可挂起命令，等待期间不阻塞shell的主循环，telnet等在同一个线程中处理多个shell的场景中
+ *        也不会阻塞其他shell，等待期间输入`SHELL_CANCEL_KEY`取消命令并请求任务结束
+ *
+ * @param yield 命令上下文
+ * @param argc 参数数量
+ * @param argv 参数，argv[1]为任务号，不指定时等待最近的一个任务
+ *
+ * @return ShellYieldState 挂起状态，返回值为后台任务的返回值
+ */
+ShellYieldState shellJobForeground(ShellYield *yield, int argc, char *argv[])
+{
+    ShellJob **job = SHELL_YIELD_CONTEXT(yield, ShellJob *);
+    Shell *shell = shellGetCurrent();
+    int retVal;
+
+    SHELL_YIELD_BEGIN(yield);
+    *job = shell ? shellJobGet(shell, argc > 1 ? (unsigned short)atoi(argv[1]) : 0) : NULL;
+    if (*job == NULL)
+    {
+        if (shell)
+        {
+            shellWriteString(shell, "No such job\r\n");
+        }
+        SHELL_YIELD_RETURN(yield, -1);
+    }
+    SHELL_YIELD_UNTIL(yield, !shellJobRunning(*job));
+    retVal = (*job)->retVal;
+    (*job)->state = SHELL_JOB_FREE;
+    SHELL_YIELD_RETURN(yield, retVal);
+    SHELL_YIELD_END(yield);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_YIELD),
+fg, shellJobForeground, wait for a background job\r\nfg [id]);
+#else
+/**
+ * @brief 等待后台任务结束
+ *        在当前线程中阻塞等待，等待期间释放输入处理持有的shell锁，任务才能通过尾行模式输出
+ *
+ * @param id 任务号，为0时等待最近的一个任务
+ *
+ * @return int 后台任务的返回值
+ */
+int shellJobForeground(int id)
+{
+    Shell *shell = shellGetCurrent();
+    ShellJob *job;
+    int retVal;
+    unsigned char locked;
+
+    SHELL_ASSERT(shell, return -1);
+    job = shellJobGet(shell, (unsigned short)id);
+    if (job == NULL || shellJobDelay == NULL)
+    {
+        shellWriteString(shell, "No such job\r\n");
+        return -1;
+    }
+    locked = shellLockRelease(shell);
+    while (shellJobRunning(job))
+    {
+        char data;
+        /* 等待期间的输入被丢弃，取消键请求任务结束，有输入时继续等待，不会一直轮询 */
+        if (shell->read && shell->read(&data, 1) == 1)
+        {
+            if (data == SHELL_CANCEL_KEY)
+            {
+                SHELL_ATOMIC_STORE(&job->killed, 1);
+            }
+            continue;
+        }
+        if (shell->waitInput)
+        {
+            shellWaitInput(shell, 10);
+        }
+        else
+        {
+            shellJobDelay(10);
+        }
+    }
+    shellLockRestore(shell, locked);
+    retVal = job->retVal;
+    job->state = SHELL_JOB_FREE;
+    return retVal;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_PARAM_NUM(1),
+fg, shellJobForeground, wait for a background job\r\nfg [id]);
+#endif /** SHELL_SUPPORT_YIELD == 1 */
+
+
+/**
+ * @brief 请求结束后台任务
+ *
+ * @param id 任务号
+ *
+ * @return int 0 成功 -1 任务不存在
+ */
+int shellJobKill(int id)
+{
+    Shell *shell = shellGetCurrent();
+    ShellJob *job;
+    SHELL_ASSERT(shell, return -1);
+    job = shellJobGet(shell, (unsigned short)id);
+    if (id == 0 || job == NULL || job->state != SHELL_JOB_RUNNING)
+    {
+        shellWriteString(shell, "No such job\r\n");
+        return -1;
+    }
+    SHELL_ATOMIC_STORE(&job->killed, 1);
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_PARAM_NUM(1),
+kill, shellJobKill, request a background job to stop\r\nkill id);
+
+#endif /** SHELL_SUPPORT_BACKGROUND == 1 */
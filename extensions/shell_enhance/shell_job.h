@@ -0,0 +1,95 @@
+/**
+ * @file shell_job.h
+ * @author Letter(nevermindzzt@gmail.com)
+ * @brief shell background job
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#ifndef __SHELL_JOB_H__
+#define __SHELL_JOB_H__
+
+#include "shell.h"
+
+/**
+ * @brief 任务表大小，同时存在的后台任务数量
+ */
+#ifndef SHELL_JOB_MAX_NUMBER
+#define     SHELL_JOB_MAX_NUMBER        4
+#endif
+
+/**
+ * @brief 后台任务参数缓冲大小，用于保存命令参数的副本
+ */
+#ifndef SHELL_JOB_BUFFER_SIZE
+#define     SHELL_JOB_BUFFER_SIZE       128
+#endif
+
+/**
+ * @brief 后台任务输出行缓冲大小，输出按行写入所属shell的尾行，减少命令行重绘
+ */
+#ifndef SHELL_JOB_OUTPUT_SIZE
+#define     SHELL_JOB_OUTPUT_SIZE       64
+#endif
+
+/**
+ * @brief 新线程接口原型，与telnetd的`NewThread`相同
+ *
+ * @param handler 线程函数，原型为`void *(*)(void *)`
+ * @param param 线程参数
+ *
+ * @return int 启动成功返回0
+ */
+typedef int (*ShellJobNewThread)(void *handler, void *param);
+
+/**
+ * @brief 延时接口原型，`fg`等待后台任务时使用
+ *
+ * @param ms 延时时间(ms)
+ */
+typedef void (*ShellJobDelay)(unsigned int ms);
+
+/**
+ * @brief 后台任务状态
+ */
+typedef enum
+{
+    SHELL_JOB_FREE = 0,                                     /**< 空闲 */
+    SHELL_JOB_RUNNING,                                      /**< 运行中 */
+    SHELL_JOB_DONE,                                         /**< 运行结束 */
+} ShellJobState;
+
+/**
+ * @brief 后台任务输出状态
+ */
+typedef enum
+{
+    SHELL_JOB_OUTPUT_IDLE = 0,                              /**< 空闲 */
+    SHELL_JOB_OUTPUT_BUSY,                                  /**< 正在写入所属shell */
+    SHELL_JOB_OUTPUT_DETACHED,                              /**< 所属shell已移除，输出被丢弃 */
+} ShellJobOutputState;
+
+/**
+ * @brief 后台任务
+ */
+typedef struct
+{
+    Shell *shell;                                           /**< 运行命令的shell，为所属shell的副本 */
+    Shell *owner;                                           /**< 所属shell，任务的输出通过其尾行模式写入 */
+    ShellCommand *command;                                  /**< 命令 */
+    char buffer[SHELL_JOB_BUFFER_SIZE];                     /**< 命令参数副本 */
+    char output[SHELL_JOB_OUTPUT_SIZE];                     /**< 输出行缓冲 */
+    unsigned short length;                                  /**< 输出行缓冲数据长度 */
+    int retVal;                                             /**< 命令返回值 */
+    unsigned short id;                                      /**< 任务号 */
+    volatile unsigned char state;                           /**< 任务状态 */
+    volatile unsigned char killed;                          /**< 任务被请求结束 */
+    volatile unsigned char outputState;                     /**< 输出状态 */
+} ShellJob;
+
+int shellJobInit(ShellJobNewThread newThread, ShellJobDelay delay);
+int shellJobKilled(void);
+
+#endif
@@ -62,6 +62,19 @@ unsigned int shellPassthrough(Shell *shell, const char *prompt, ShellPassthrough
                     shellHandler(shell, data);
                 }
             }
+        #if SHELL_SUPPORT_CANCEL == 1
+            else if (shellIsCancelled())
+            {
+                shellWriteString(shell, "\r\n");
+                shell->parser.length = 0;
+                shell->parser.cursor = 0;
+                return (unsigned int)(-1);
+            }
+        #endif
+            else
+            {
+                shellWaitInput(shell, SHELL_WAIT_FOREVER);
+            }
         }
     }
     return 0;
@@ -11,8 +11,15 @@
 #include "telnetd.h"
 
 #include "sys/socket.h"
+#include "sys/epoll.h"
+#include "sys/eventfd.h"
 #include "arpa/inet.h"
 #include "netinet/in.h"
+#include "fcntl.h"
+#include "errno.h"
+#include "unistd.h"
+#include "string.h"
+#include "pthread.h"
 
 #include "shell.h"
 #include "shell_cmd_group.h"
@@ -21,6 +28,78 @@
 #error telent for letter shell can not be used while shell companion is diabled
 #endif
 
+/**
+ * @brief telnet 协议字节
+ */
+#define TELNET_IAC                  0xFF
+#define TELNET_SB                   0xFA
+#define TELNET_SE                   0xF0
+#define TELNET_WILL                 0xFB
+#define TELNET_WONT                 0xFC
+#define TELNET_DO                   0xFD
+#define TELNET_DONT                 0xFE
+
+/**
+ * @brief telnet 选项
+ */
+#define TELNET_OPT_ECHO             0x01
+#define TELNET_OPT_SGA              0x03
+#define TELNET_OPT_TTYPE            0x18
+#define TELNET_OPT_NAWS             0x1F
+
+/**
+ * @brief telnet TTYPE子协商命令
+ */
+#define TELNET_TTYPE_IS             0x00
+#define TELNET_TTYPE_SEND           0x01
+
+/**
+ * @brief telnet 接收数据解析状态
+ */
+typedef enum
+{
+    TELNETD_STATE_DATA = 0,                                 /**< 普通数据 */
+    TELNETD_STATE_IAC,                                      /**< 收到IAC */
+    TELNETD_STATE_OPTION,                                   /**< 收到IAC WILL/WONT/DO/DONT，等待选项 */
+    TELNETD_STATE_SB_OPTION,                                /**< 收到IAC SB，等待子协商选项 */
+    TELNETD_STATE_SB,                                       /**< 子协商数据 */
+    TELNETD_STATE_SB_IAC,                                   /**< 子协商中收到IAC */
+} TelnetdState;
+
+/**
+ * @brief telnet 会话
+ *        会话在初始化时一次性分配，连接断开后复用，不会释放
+ */
+typedef struct telnetd_session
+{
+    Shell shell;                                            /**< 会话shell */
+    ShellCompanionObj companion;                            /**< 会话shell的伴生对象节点 */
+    int client;                                             /**< 客户端连接socket */
+    pthread_mutex_t lock;                                   /**< 发送缓冲锁 */
+#if SHELL_USING_LOCK == 1
+    pthread_mutex_t shellLock;                              /**< 会话shell锁(递归锁) */
+#endif
+    char buffer[TELNETD_SHELL_BUFFER_SIZE];                 /**< shell缓冲区 */
+    char output[TELNETD_SEND_BUFFER_SIZE];                  /**< 发送缓冲区(环形) */
+    unsigned short head;                                    /**< 发送缓冲区数据起始位置 */
+    unsigned short length;                                  /**< 发送缓冲区数据长度 */
+    unsigned char used;                                     /**< 会话正在使用 */
+    unsigned char state;                                    /**< 接收数据解析状态 */
+    unsigned char command;                                  /**< 正在解析的协商命令或者子协商选项 */
+    unsigned char options;                                  /**< 服务端已启用的选项(ECHO, SGA) */
+    unsigned char sbLength;                                 /**< 子协商数据长度 */
+    unsigned char sb[TELNETD_TERMINAL_TYPE_SIZE + 1];       /**< 子协商数据 */
+    char terminal[TELNETD_TERMINAL_TYPE_SIZE];              /**< 客户端终端类型 */
+    unsigned char deferred;                                 /**< 正在处理输入，输出在处理完成后统一发送 */
+    unsigned char waiting;                                  /**< 等待socket可写，暂停接收 */
+    volatile unsigned char closed;                          /**< 连接已断开 */
+#if TELNETD_IDLE_TIMEOUT > 0
+    unsigned int active;                                    /**< 最后一次接收数据的时间 */
+    struct telnetd_session *prev;                           /**< 时间轮槽中的上一个会话 */
+    struct telnetd_session *next;                           /**< 时间轮槽中的下一个会话 */
+#endif
+} TelnetdSession;
+
 /**
  * @brief 新线程接口实例
  */
@@ -29,60 +108,189 @@ static NewThread newThread;
 /**
  * @brief telnet server socket
  */
-static int telnetdSocket;
+static int telnetdSocket = -1;
+
+/**
+ * @brief telnet server epoll
+ */
+static int telnetdEpoll = -1;
+
+/**
+ * @brief telnet server 停止事件
+ */
+static int telnetdEvent = -1;
+
+/**
+ * @brief telnet server 运行线程
+ */
+static pthread_t telnetdThread;
+
+/**
+ * @brief telnet server 正在运行
+ */
+static volatile int telnetdRunning = 0;
+
+/**
+ * @brief telnet server 线程中正在处理的会话
+ */
+static TelnetdSession *telnetdActive = NULL;
+
+/**
+ * @brief telnet 会话池
+ */
+static TelnetdSession *telnetdSessions = NULL;
+
+/**
+ * @brief telnet 会话池大小
+ */
+static unsigned short telnetdPoolSize = 0;
+
+/**
+ * @brief telnet 最大会话数量
+ */
+static unsigned short telnetdMaxSession = 0;
+
+/**
+ * @brief telnet 当前会话数量
+ */
+static unsigned short telnetdSessionCount = 0;
 
+#if TELNETD_IDLE_TIMEOUT > 0
 /**
- * @brief telent server shell
+ * @brief telnet 空闲超时时间轮
  */
-static Shell *telnetdShell;
+static TelnetdSession *telnetdWheel[TELNETD_WHEEL_SIZE];
+
+/**
+ * @brief telnet 时间轮下一个待检查的槽
+ */
+static unsigned short telnetdWheelCursor = 0;
+
+/**
+ * @brief telnet 时间轮上一次转动的时间
+ */
+static unsigned int telnetdWheelTick = 0;
+#endif
 
 /**
  * @brief telnet server 监听端口
  */
 static int telnetdPort = TELNETD_DEFAULT_SERVER_PORT;
 
-static void telnetdServer(void);
-static void telnetdConnection(int client);
-static void telentdWrite(char *data, short len);
+static void *telnetdServer(void *param);
+static signed short telnetdWrite(char *data, unsigned short len);
+static void telnetdClose(TelnetdSession *session);
 
 /**
  * @brief telnet 协议命令
+ *        服务端回显(WILL ECHO)，字符模式(WILL SGA)，请求客户端发送窗口大小(DO NAWS)和终端类型(DO TTYPE)
+ */
+static char telnetCmd[] = {
+    TELNET_IAC, TELNET_WILL, TELNET_OPT_ECHO,
+    TELNET_IAC, TELNET_WILL, TELNET_OPT_SGA,
+    TELNET_IAC, TELNET_DO, TELNET_OPT_NAWS,
+    TELNET_IAC, TELNET_DO, TELNET_OPT_TTYPE
+};
+
+/**
+ * @brief telnet 请求客户端发送终端类型
+ */
+static const char telnetTtypeSend[] = {
+    TELNET_IAC, TELNET_SB, TELNET_OPT_TTYPE, TELNET_TTYPE_SEND, TELNET_IAC, TELNET_SE
+};
+
+/**
+ * @brief telnet 拒绝连接时发送的信息
+ */
+static const char telnetdBusyInfo[] = "\r\ntoo many telnet sessions, try again later\r\n";
+
+#if TELNETD_IDLE_TIMEOUT > 0
+/**
+ * @brief telnet 空闲超时关闭会话时发送的信息
  */
-static char telnetCmd[] = {0xff, 0xfb, 0x01, 0xff, 0xfb, 0x03, 0xff, 0xfc, 0x1f};
+static const char telnetdTimeoutInfo[] = "\r\ntelnet session timeout\r\n";
+#endif
 
 /**
  * @brief telnet server初始化
+ *        一次性分配会话池，之后建立连接不再分配内存
  * 
- * @param newThreadInterface 新线程接口 
+ * @param newThreadInterface 新线程接口
+ * @param maxSession 会话池大小，传入0时使用`TELNETD_DEFAULT_MAX_SESSION`
  * 
  * @return int 0 启动telent成功 -1 启动失败
  */
-int telentdInit(NewThread newThreadInterface)
+int telentdInit(NewThread newThreadInterface, unsigned short maxSession)
 {
+#if SHELL_USING_LOCK == 1
+    pthread_mutexattr_t attr;
+
+#endif
+    if (telnetdRunning || telnetdSessions)
+    {
+        return -1;
+    }
+    if (maxSession == 0)
+    {
+        maxSession = TELNETD_DEFAULT_MAX_SESSION;
+    }
+    telnetdSessions = SHELL_MALLOC(sizeof(TelnetdSession) * maxSession);
+    if (telnetdSessions == NULL)
+    {
+        return -1;
+    }
+    memset(telnetdSessions, 0, sizeof(TelnetdSession) * maxSession);
+#if SHELL_USING_LOCK == 1
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+#endif
+    for (unsigned short i = 0; i < maxSession; i++)
+    {
+        pthread_mutex_init(&telnetdSessions[i].lock, NULL);
+    #if SHELL_USING_LOCK == 1
+        pthread_mutex_init(&telnetdSessions[i].shellLock, &attr);
+    #endif
+    }
+#if SHELL_USING_LOCK == 1
+    pthread_mutexattr_destroy(&attr);
+#endif
+    telnetdPoolSize = telnetdMaxSession = maxSession;
     newThread = newThreadInterface;
     return newThread ? 0 : -1;
 }
 
 /**
  * @brief 启动 telnet server
+ *        所有会话在同一个线程中通过epoll处理
  * 
  * @return int 0 启动telent成功 -1 启动失败
  */
 int telnetdStart()
 {
-    return newThread ? newThread(telnetdServer, NULL) : -1;
+    if (newThread == NULL || telnetdSessions == NULL || telnetdRunning)
+    {
+        return -1;
+    }
+    telnetdRunning = 1;
+    if (newThread(telnetdServer, NULL) != 0)
+    {
+        telnetdRunning = 0;
+        return -1;
+    }
+    return 0;
 }
 
 /**
  * @brief 停止 telnet server
+ *        通知server线程关闭所有会话后退出
  * 
  */
 void telnetdStop()
 {
-    close(telnetdSocket);
-    if (telnetdShell != NULL)
+    unsigned long long value = 1;
+    if (telnetdRunning && telnetdEvent >= 0)
     {
-        close((int) shellCompanionGet(telnetdShell, SHELL_COMPANION_ID_TELNETD));
+        write(telnetdEvent, &value, sizeof(value));
     }
 }
 
@@ -98,101 +306,774 @@ void telnetdSetPort(int port)
 }
 
 /**
- * @brief telent 服务
+ * @brief 设置telnet server 最大会话数量
+ *        超过最大数量的连接会收到提示信息后被关闭，已经建立的会话不受影响
  * 
+ * @param max 最大会话数量，不能超过会话池大小
  * 
+ * @return int 设置后的最大会话数量
  */
-static void telnetdServer(void)
+int telnetdSetMaxSession(int max)
 {
-    struct sockaddr_in telnetdAddr;
-    int client;
-    struct sockaddr_in clientAddr;
-    int addrLen = sizeof(clientAddr);
+    telnetdMaxSession = max < 0 ? 0 : (max > telnetdPoolSize ? telnetdPoolSize : max);
+    return telnetdMaxSession;
+}
 
-    telnetdSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    memset(&telnetdAddr, 0, sizeof(telnetdAddr));
-    telnetdAddr.sin_family = AF_INET,
-    telnetdAddr.sin_addr.s_addr = inet_addr(TELNETD_SERVER_ADDRESS);
-    telnetdAddr.sin_port  = htons(telnetdPort);
-    if (bind(telnetdSocket, (struct sockaddr *)&telnetdAddr, sizeof(telnetdAddr)) == 0 &&
-        listen(telnetdSocket, 5) == 0)
+/**
+ * @brief 获取telnet客户端终端类型
+ *        客户端通过TTYPE选项上报，shell不是telnet会话或者客户端未上报时返回NULL
+ * 
+ * @param shell shell对象
+ * 
+ * @return const char* 终端类型
+ */
+const char *telnetdGetTerminalType(Shell *shell)
+{
+    TelnetdSession *session = shell ? shellCompanionGet(shell, SHELL_COMPANION_ID_TELNETD) : NULL;
+    return (session && session->terminal[0]) ? session->terminal : NULL;
+}
+
+/**
+ * @brief 设置socket为非阻塞
+ * 
+ * @param fd socket
+ * 
+ * @return int 0 成功 -1 失败
+ */
+static int telnetdSetNonBlock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags < 0 ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ * @brief 获取shell对应的会话
+ *        server线程中返回正在处理的会话，其他线程(比如后台命令)通过当前执行命令的shell查找
+ * 
+ * @return TelnetdSession* 会话，未找到时返回NULL
+ */
+static TelnetdSession *telnetdGetSession(void)
+{
+    Shell *shell;
+    if (telnetdRunning && pthread_equal(pthread_self(), telnetdThread))
     {
-        while (1)
+        return telnetdActive;
+    }
+    shell = shellGetCurrent();
+    return shell ? shellCompanionGet(shell, SHELL_COMPANION_ID_TELNETD) : NULL;
+}
+
+#if SHELL_USING_LOCK == 1
+/**
+ * @brief 会话shell加锁
+ *        server线程处理输入和后台命令的尾行输出互斥，递归锁允许命令执行期间再次加锁
+ * 
+ * @param shell shell对象
+ * 
+ * @return int 0 成功
+ */
+static int telnetdShellLock(Shell *shell)
+{
+    TelnetdSession *session = shellCompanionGet(shell, SHELL_COMPANION_ID_TELNETD);
+    return session ? pthread_mutex_lock(&session->shellLock) : -1;
+}
+
+/**
+ * @brief 会话shell解锁
+ * 
+ * @param shell shell对象
+ * 
+ * @return int 0 成功
+ */
+static int telnetdShellUnlock(Shell *shell)
+{
+    TelnetdSession *session = shellCompanionGet(shell, SHELL_COMPANION_ID_TELNETD);
+    return session ? pthread_mutex_unlock(&session->shellLock) : -1;
+}
+#endif
+
+/**
+ * @brief 发送会话发送缓冲区中的数据
+ *        socket不能写入全部数据时，改为等待socket可写，同时暂停接收，直到缓冲区中的数据发送完成，
+ *        调用时需要持有会话的发送缓冲锁
+ * 
+ * @param session 会话
+ */
+static void telnetdFlush(TelnetdSession *session)
+{
+    struct epoll_event event;
+
+    while (session->length > 0 && !session->closed)
+    {
+        unsigned short size = TELNETD_SEND_BUFFER_SIZE - session->head;
+        ssize_t ret;
+        if (size > session->length)
+        {
+            size = session->length;
+        }
+        ret = send(session->client, session->output + session->head, size,
+                   MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret > 0)
+        {
+            session->head = (session->head + ret) % TELNETD_SEND_BUFFER_SIZE;
+            session->length -= ret;
+        }
+        else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else if (ret < 0 && errno != EINTR)
         {
-            client = accept(telnetdSocket, (struct sockaddr *) &clientAddr, (socklen_t *) &addrLen);
-            if (client > 0)
+            session->closed = 1;
+        }
+    }
+    if (session->closed || (session->length > 0) == session->waiting)
+    {
+        return;
+    }
+    session->waiting = session->length > 0;
+    event.events = session->waiting ? EPOLLOUT : EPOLLIN;
+    event.data.ptr = session;
+    epoll_ctl(telnetdEpoll, EPOLL_CTL_MOD, session->client, &event);
+}
+
+/**
+ * @brief 写入会话发送缓冲区
+ *        缓冲区满时先尝试发送，客户端接收不及时则丢弃剩余数据，不阻塞server线程
+ * 
+ * @param session 会话
+ * @param data 数据
+ * @param len 数据长度
+ */
+static void telnetdSend(TelnetdSession *session, const char *data, unsigned short len)
+{
+    pthread_mutex_lock(&session->lock);
+    for (unsigned short i = 0; i < len; i++)
+    {
+        if (session->length == TELNETD_SEND_BUFFER_SIZE)
+        {
+            telnetdFlush(session);
+            if (session->length == TELNETD_SEND_BUFFER_SIZE)
             {
-                newThread(telnetdConnection, (void *) client);
+                break;
             }
-            else if (client <= 0)
+        }
+        session->output[(session->head + session->length) % TELNETD_SEND_BUFFER_SIZE] = data[i];
+        session->length++;
+    }
+    if (!session->deferred)
+    {
+        telnetdFlush(session);
+    }
+    pthread_mutex_unlock(&session->lock);
+}
+
+/**
+ * @brief 开始处理会话
+ *        处理期间shell的输出先写入发送缓冲区
+ * 
+ * @param session 会话
+ */
+static void telnetdBegin(TelnetdSession *session)
+{
+    pthread_mutex_lock(&session->lock);
+    session->deferred = 1;
+    pthread_mutex_unlock(&session->lock);
+    telnetdActive = session;
+}
+
+/**
+ * @brief 结束处理会话，发送处理期间的输出
+ * 
+ * @param session 会话
+ */
+static void telnetdEnd(TelnetdSession *session)
+{
+    telnetdActive = NULL;
+    pthread_mutex_lock(&session->lock);
+    session->deferred = 0;
+    telnetdFlush(session);
+    pthread_mutex_unlock(&session->lock);
+}
+
+#if TELNETD_IDLE_TIMEOUT > 0
+/**
+ * @brief 将会话加入时间轮
+ *        会话放入空闲超时到期的槽，超过时间轮一圈的放入最后一个槽，到期时再次检查
+ * 
+ * @param session 会话
+ * @param tick 当前时间
+ */
+static void telnetdWheelAdd(TelnetdSession *session, unsigned int tick)
+{
+    unsigned int remain = TELNETD_IDLE_TIMEOUT - (tick - session->active);
+    unsigned int slot = remain / TELNETD_WHEEL_INTERVAL;
+    if (slot >= TELNETD_WHEEL_SIZE)
+    {
+        slot = TELNETD_WHEEL_SIZE - 1;
+    }
+    slot = (telnetdWheelCursor + slot) % TELNETD_WHEEL_SIZE;
+    session->prev = NULL;
+    session->next = telnetdWheel[slot];
+    if (session->next)
+    {
+        session->next->prev = session;
+    }
+    telnetdWheel[slot] = session;
+}
+
+/**
+ * @brief 将会话移出时间轮
+ * 
+ * @param session 会话
+ */
+static void telnetdWheelDel(TelnetdSession *session)
+{
+    if (session->prev)
+    {
+        session->prev->next = session->next;
+    }
+    else
+    {
+        for (short i = 0; i < TELNETD_WHEEL_SIZE; i++)
+        {
+            if (telnetdWheel[i] == session)
             {
+                telnetdWheel[i] = session->next;
                 break;
             }
         }
     }
-    close(telnetdSocket);
+    if (session->next)
+    {
+        session->next->prev = session->prev;
+    }
+    session->prev = session->next = NULL;
+}
+
+/**
+ * @brief 转动时间轮，关闭空闲超时的会话
+ *        接收数据时只更新会话的活动时间，槽到期时才检查，未超时的会话重新放入对应的槽
+ * 
+ */
+static void telnetdWheelTurn(void)
+{
+    unsigned int tick = SHELL_GET_TICK();
+    unsigned short turns = 0;
+
+    while (tick - telnetdWheelTick >= TELNETD_WHEEL_INTERVAL)
+    {
+        TelnetdSession *session = telnetdWheel[telnetdWheelCursor];
+        telnetdWheel[telnetdWheelCursor] = NULL;
+        telnetdWheelCursor = (telnetdWheelCursor + 1) % TELNETD_WHEEL_SIZE;
+        telnetdWheelTick += TELNETD_WHEEL_INTERVAL;
+        while (session)
+        {
+            TelnetdSession *next = session->next;
+            if (tick - session->active >= TELNETD_IDLE_TIMEOUT)
+            {
+                session->prev = session->next = NULL;
+                telnetdSend(session, telnetdTimeoutInfo, sizeof(telnetdTimeoutInfo) - 1);
+                session->closed = 1;
+            }
+            else
+            {
+                telnetdWheelAdd(session, tick);
+            }
+            session = next;
+        }
+        if (++turns == TELNETD_WHEEL_SIZE)
+        {
+            telnetdWheelTick = tick;
+        }
+    }
 }
+#endif
 
 /**
- * @brief telnet server 连接处理
+ * @brief 新建会话
+ *        从会话池中取出空闲的会话，不分配内存
  * 
  * @param client 客户端连接socket
  * 
+ * @return int 0 成功，或者shell注册失败时会话连同连接已经关闭 -1 失败，连接需要由调用者关闭
  */
-static void telnetdConnection(int client)
+static int telnetdOpen(int client)
 {
-    int len = 0;
-    char *data = SHELL_MALLOC(16);
-    char *shellBuffer = SHELL_MALLOC(TELNETD_SHELL_BUFFER_SIZE);
-    telnetdShell = SHELL_MALLOC(sizeof(Shell));
+    TelnetdSession *session = NULL;
+    struct epoll_event event;
 
-    /** 处理 telent 协议 */
-    send(client, telnetCmd, 9, 0);
-    recv(client, data, 6, 0);
+    for (unsigned short i = 0; i < telnetdPoolSize; i++)
+    {
+        if (!telnetdSessions[i].used)
+        {
+            session = &telnetdSessions[i];
+            break;
+        }
+    }
+    if (session == NULL || telnetdSessionCount >= telnetdMaxSession
+        || telnetdSetNonBlock(client) != 0)
+    {
+        send(client, telnetdBusyInfo, sizeof(telnetdBusyInfo) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+        return -1;
+    }
+    memset(&session->shell, 0, sizeof(Shell));
+    session->client = client;
+    session->head = session->length = 0;
+    session->state = session->deferred = session->waiting = session->closed = 0;
+    session->options = (1 << TELNET_OPT_ECHO) | (1 << TELNET_OPT_SGA);
+    session->terminal[0] = 0;
 
-    telnetdShell->write = telentdWrite;
-    shellCompanionAdd(telnetdShell, SHELL_COMPANION_ID_TELNETD, (void *)client);
-    shellInit(telnetdShell, shellBuffer, TELNETD_SHELL_BUFFER_SIZE);
+    event.events = EPOLLIN;
+    event.data.ptr = session;
+    if (epoll_ctl(telnetdEpoll, EPOLL_CTL_ADD, client, &event) != 0)
+    {
+        return -1;
+    }
+    session->used = 1;
+    telnetdSessionCount++;
+#if TELNETD_IDLE_TIMEOUT > 0
+    session->active = SHELL_GET_TICK();
+    telnetdWheelAdd(session, session->active);
+#endif
 
+    telnetdBegin(session);
+    /** 处理 telent 协议 */
+    telnetdSend(session, telnetCmd, sizeof(telnetCmd));
+    session->shell.write = telnetdWrite;
+#if SHELL_USING_LOCK == 1
+    session->shell.lock = telnetdShellLock;
+    session->shell.unlock = telnetdShellUnlock;
+#endif
+    session->companion.id = SHELL_COMPANION_ID_TELNETD;
+    session->companion.obj = session;
+    session->companion.next = NULL;
+    session->shell.info.companions = &session->companion;
+    if (shellInit(&session->shell, session->buffer, TELNETD_SHELL_BUFFER_SIZE) != 0)
+    {
+        /* shell注册表已满，会话关闭时连接同时关闭 */
+        telnetdWrite((char *) telnetdBusyInfo, sizeof(telnetdBusyInfo) - 1);
+        telnetdEnd(session);
+        telnetdClose(session);
+        return 0;
+    }
     if (TELNETD_SHELL_USER)
     {
-        shellRun(telnetdShell, TELNETD_SHELL_USER);
+        shellRun(&session->shell, TELNETD_SHELL_USER);
     }
+    telnetdEnd(session);
+    return 0;
+}
+
+/**
+ * @brief 关闭会话，会话归还会话池
+ *        先移除shell，结束会话的后台命令并等待正在进行的输出完成，之后才关闭连接，
+ *        避免后台命令写入已关闭或者被新会话复用的连接
+ * 
+ * @param session 会话
+ */
+static void telnetdClose(TelnetdSession *session)
+{
+    shellDeInit(&session->shell);
+#if TELNETD_IDLE_TIMEOUT > 0
+    telnetdWheelDel(session);
+#endif
+    epoll_ctl(telnetdEpoll, EPOLL_CTL_DEL, session->client, NULL);
+    close(session->client);
+    pthread_mutex_lock(&session->lock);
+    session->shell.info.companions = NULL;
+    session->client = -1;
+    session->used = 0;
+    pthread_mutex_unlock(&session->lock);
+    telnetdSessionCount--;
+}
 
-    while (1)
+/**
+ * @brief 处理telnet选项协商
+ *        只接受服务端的ECHO，SGA和客户端的NAWS，TTYPE，其他选项一律拒绝，
+ *        只在选项状态改变时应答，避免和客户端循环协商
+ * 
+ * @param session 会话
+ * @param command 协商命令 WILL/WONT/DO/DONT
+ * @param option 选项
+ */
+static void telnetdNegotiate(TelnetdSession *session, unsigned char command, unsigned char option)
+{
+    char reply[3] = {TELNET_IAC, 0, option};
+    unsigned char mask = (option == TELNET_OPT_ECHO || option == TELNET_OPT_SGA) ? 1 << option : 0;
+
+    switch (command)
     {
-        len = recv(client, data, 1, 0);
-        if (len == 0)
+    case TELNET_DO:
+        if (mask == 0)
+        {
+            reply[1] = TELNET_WONT;
+        }
+        else if (!(session->options & mask))
+        {
+            session->options |= mask;
+            reply[1] = TELNET_WILL;
+        }
+        break;
+    case TELNET_DONT:
+        if (session->options & mask)
+        {
+            session->options &= ~mask;
+            reply[1] = TELNET_WONT;
+        }
+        break;
+    case TELNET_WILL:
+        if (option == TELNET_OPT_TTYPE)
+        {
+            telnetdSend(session, telnetTtypeSend, sizeof(telnetTtypeSend));
+        }
+        else if (option != TELNET_OPT_NAWS)
         {
+            reply[1] = TELNET_DONT;
+        }
+        break;
+    default:
+        break;
+    }
+    if (reply[1])
+    {
+        telnetdSend(session, reply, sizeof(reply));
+    }
+}
+
+/**
+ * @brief 处理telnet子协商
+ *        NAWS设置会话shell的终端大小，TTYPE记录客户端终端类型
+ * 
+ * @param session 会话
+ */
+static void telnetdSubnegotiate(TelnetdSession *session)
+{
+    if (session->command == TELNET_OPT_NAWS && session->sbLength == 4)
+    {
+        shellSetTerminalSize(&session->shell,
+                             (session->sb[0] << 8) | session->sb[1],
+                             (session->sb[2] << 8) | session->sb[3]);
+    }
+    else if (session->command == TELNET_OPT_TTYPE && session->sbLength > 1
+             && session->sb[0] == TELNET_TTYPE_IS)
+    {
+        /* 终端类型过长时截断，保留结束符的位置 */
+        unsigned char length = session->sbLength - 1;
+        if (length > sizeof(session->terminal) - 1)
+        {
+            length = sizeof(session->terminal) - 1;
+        }
+        memcpy(session->terminal, session->sb + 1, length);
+        session->terminal[length] = 0;
+    }
+}
+
+/**
+ * @brief 解析telnet协议命令
+ *        流式解析，协议命令可以跨越多次接收的数据，协议命令和子协商数据从数据中剔除，
+ *        `IAC IAC`转换为0xFF
+ * 
+ * @param session 会话
+ * @param data 接收的数据
+ * @param len 数据长度
+ * 
+ * @return int 过滤后的数据长度
+ */
+static int telnetdFilter(TelnetdSession *session, char *data, int len)
+{
+    int count = 0;
+    for (int i = 0; i < len; i++)
+    {
+        unsigned char byte = (unsigned char) data[i];
+        switch (session->state)
+        {
+        case TELNETD_STATE_DATA:
+            if (byte == TELNET_IAC)
+            {
+                session->state = TELNETD_STATE_IAC;
+            }
+            else
+            {
+                data[count++] = byte;
+            }
             break;
+        case TELNETD_STATE_IAC:
+            session->state = TELNETD_STATE_DATA;
+            if (byte == TELNET_IAC)
+            {
+                data[count++] = byte;
+            }
+            else if (byte == TELNET_SB)
+            {
+                session->state = TELNETD_STATE_SB_OPTION;
+            }
+            else if (byte >= TELNET_WILL && byte <= TELNET_DONT)
+            {
+                session->command = byte;
+                session->state = TELNETD_STATE_OPTION;
+            }
+            break;
+        case TELNETD_STATE_OPTION:
+            telnetdNegotiate(session, session->command, byte);
+            session->state = TELNETD_STATE_DATA;
+            break;
+        case TELNETD_STATE_SB_OPTION:
+            session->command = byte;
+            session->sbLength = 0;
+            session->state = TELNETD_STATE_SB;
+            break;
+        case TELNETD_STATE_SB:
+            if (byte == TELNET_IAC)
+            {
+                session->state = TELNETD_STATE_SB_IAC;
+            }
+            else if (session->sbLength < sizeof(session->sb))
+            {
+                session->sb[session->sbLength++] = byte;
+            }
+            break;
+        case TELNETD_STATE_SB_IAC:
+            if (byte == TELNET_IAC)
+            {
+                if (session->sbLength < sizeof(session->sb))
+                {
+                    session->sb[session->sbLength++] = byte;
+                }
+                session->state = TELNETD_STATE_SB;
+            }
+            else
+            {
+                if (byte == TELNET_SE)
+                {
+                    telnetdSubnegotiate(session);
+                }
+                session->state = TELNETD_STATE_DATA;
+            }
+            break;
+        default:
+            session->state = TELNETD_STATE_DATA;
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 接收会话数据
+ *        每次接收一块数据，过滤协议命令后整块交给shell处理
+ * 
+ * @param session 会话
+ */
+static void telnetdReceive(TelnetdSession *session)
+{
+    char data[TELNETD_RECV_SIZE];
+    ssize_t len;
+
+    len = recv(session->client, data, sizeof(data), MSG_DONTWAIT);
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        session->closed = 1;
+        return;
+    }
+#if TELNETD_IDLE_TIMEOUT > 0
+    if (len > 0)
+    {
+        session->active = SHELL_GET_TICK();
+    }
+#endif
+    if (len > 0)
+    {
+        telnetdBegin(session);
+        len = telnetdFilter(session, data, len);
+        if (len > 0)
+        {
+            shellInput(&session->shell, data, len);
+        }
+        telnetdEnd(session);
+    }
+}
+
+/**
+ * @brief 接受新的连接
+ * 
+ */
+static void telnetdAccept(void)
+{
+    struct sockaddr_in clientAddr;
+    socklen_t addrLen = sizeof(clientAddr);
+    int client;
+
+    while ((client = accept(telnetdSocket, (struct sockaddr *) &clientAddr, &addrLen)) >= 0)
+    {
+        if (telnetdOpen(client) != 0)
+        {
+            close(client);
+        }
+        addrLen = sizeof(clientAddr);
+    }
+}
+
+#if SHELL_SUPPORT_YIELD == 1
+/**
+ * @brief 恢复会话中挂起的命令
+ * 
+ * @return int 仍有挂起的命令返回1，否则返回0
+ */
+static int telnetdPoll(void)
+{
+    int pending = 0;
+    for (unsigned short i = 0; i < telnetdPoolSize; i++)
+    {
+        TelnetdSession *session = &telnetdSessions[i];
+        if (session->used && session->shell.yield.command)
+        {
+            telnetdBegin(session);
+            pending |= shellPoll(&session->shell);
+            telnetdEnd(session);
         }
-        else if (len == 1)
+    }
+    return pending;
+}
+#endif
+
+/**
+ * @brief telent 服务
+ *        单线程epoll事件循环，处理监听socket，所有会话的收发以及停止事件
+ * 
+ * @param param 参数
+ * 
+ * @return void* NULL
+ */
+static void *telnetdServer(void *param)
+{
+    struct sockaddr_in telnetdAddr;
+    struct epoll_event events[32];
+    struct epoll_event event;
+    int timeout = -1;
+    int reuse = 1;
+
+    (void) param;
+    telnetdThread = pthread_self();
+#if TELNETD_IDLE_TIMEOUT > 0
+    memset(telnetdWheel, 0, sizeof(telnetdWheel));
+    telnetdWheelCursor = 0;
+    telnetdWheelTick = SHELL_GET_TICK();
+#endif
+    telnetdSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    telnetdEpoll = epoll_create1(0);
+    telnetdEvent = eventfd(0, EFD_NONBLOCK);
+    setsockopt(telnetdSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    memset(&telnetdAddr, 0, sizeof(telnetdAddr));
+    telnetdAddr.sin_family = AF_INET,
+    telnetdAddr.sin_addr.s_addr = inet_addr(TELNETD_SERVER_ADDRESS);
+    telnetdAddr.sin_port  = htons(telnetdPort);
+    if (telnetdSocket >= 0 && telnetdEpoll >= 0 && telnetdEvent >= 0
+        && bind(telnetdSocket, (struct sockaddr *)&telnetdAddr, sizeof(telnetdAddr)) == 0
+        && listen(telnetdSocket, 16) == 0
+        && telnetdSetNonBlock(telnetdSocket) == 0)
+    {
+        event.events = EPOLLIN;
+        event.data.ptr = &telnetdSocket;
+        epoll_ctl(telnetdEpoll, EPOLL_CTL_ADD, telnetdSocket, &event);
+        event.data.ptr = &telnetdEvent;
+        epoll_ctl(telnetdEpoll, EPOLL_CTL_ADD, telnetdEvent, &event);
+
+        while (1)
         {
-            shellHandler(telnetdShell, data[0]);
+            int count = epoll_wait(telnetdEpoll, events, sizeof(events) / sizeof(events[0]), timeout);
+            if (count < 0 && errno != EINTR)
+            {
+                break;
+            }
+            for (int i = 0; i < count; i++)
+            {
+                TelnetdSession *session = events[i].data.ptr;
+                if (events[i].data.ptr == &telnetdEvent)
+                {
+                    telnetdRunning = 0;
+                }
+                else if (events[i].data.ptr == &telnetdSocket)
+                {
+                    telnetdAccept();
+                }
+                else if (events[i].events & (EPOLLERR | EPOLLHUP))
+                {
+                    session->closed = 1;
+                }
+                else if (events[i].events & EPOLLOUT)
+                {
+                    pthread_mutex_lock(&session->lock);
+                    telnetdFlush(session);
+                    pthread_mutex_unlock(&session->lock);
+                }
+                else if (events[i].events & EPOLLIN)
+                {
+                    telnetdReceive(session);
+                }
+            }
+        #if TELNETD_IDLE_TIMEOUT > 0
+            telnetdWheelTurn();
+        #endif
+            for (unsigned short i = 0; i < telnetdPoolSize; i++)
+            {
+                if (telnetdSessions[i].used && telnetdSessions[i].closed)
+                {
+                    telnetdClose(&telnetdSessions[i]);
+                }
+            }
+            if (!telnetdRunning)
+            {
+                break;
+            }
+            timeout = -1;
+        #if TELNETD_IDLE_TIMEOUT > 0
+            if (telnetdSessionCount > 0)
+            {
+                timeout = TELNETD_WHEEL_INTERVAL;
+            }
+        #endif
+        #if SHELL_SUPPORT_YIELD == 1
+            if (telnetdPoll())
+            {
+                timeout = TELNETD_POLL_INTERVAL;
+            }
+        #endif
         }
     }
-    shellDeInit(telnetdShell);
-    SHELL_FREE(data);
-    SHELL_FREE(shellBuffer);
-    SHELL_FREE(telnetdShell);
-    telnetdShell = NULL;
-    close(client);
+    for (unsigned short i = 0; i < telnetdPoolSize; i++)
+    {
+        if (telnetdSessions[i].used)
+        {
+            telnetdClose(&telnetdSessions[i]);
+        }
+    }
+    close(telnetdSocket);
+    close(telnetdEpoll);
+    close(telnetdEvent);
+    telnetdSocket = telnetdEpoll = telnetdEvent = -1;
+    telnetdRunning = 0;
+    return NULL;
 }
 
 /**
  * @brief telnet server数据写
+ *        写入所属会话的发送缓冲区
  * 
  * @param data 写入的数据
  * @param len 数据长度
  * 
+ * @return signed short 写入的数据长度
  */
-static void telentdWrite(char *data, short len)
+static signed short telnetdWrite(char *data, unsigned short len)
 {
-    int client = (int) shellCompanionGet(telnetdShell, SHELL_COMPANION_ID_TELNETD);
-    if (client != 0)
+    TelnetdSession *session = telnetdGetSession();
+    if (session == NULL)
     {
-        send(client, data, len, 0);
+        return 0;
     }
+    telnetdSend(session, data, len);
+    return len;
 }
 
 
@@ -201,6 +1082,7 @@ ShellCommand telnetdGroup[] =
     SHELL_CMD_GROUP_ITEM(SHELL_TYPE_CMD_FUNC, start, telnetdStart, start telnet server),
     SHELL_CMD_GROUP_ITEM(SHELL_TYPE_CMD_FUNC, stop, telnetdStop, stop telnet server),
     SHELL_CMD_GROUP_ITEM(SHELL_TYPE_CMD_FUNC, setPort, telnetdSetPort, set telnet server port),
+    SHELL_CMD_GROUP_ITEM(SHELL_TYPE_CMD_FUNC, setMax, telnetdSetMaxSession, set max telnet sessions),
     SHELL_CMD_GROUP_END()
 };
 SHELL_EXPORT_CMD_GROUP(
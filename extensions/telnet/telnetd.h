@@ -11,10 +11,12 @@
 #ifndef __TELNETD_H__
 #define __TELNETD_H__
 
+#include "shell.h"
+
 /**
  * @brief 版本
  */
-#define TELNET_VERSION              "1.0.0"
+#define TELNET_VERSION              "2.0.0"
 
 /**
  * @brief telnetd shell伴生对象ID
@@ -41,6 +43,47 @@
  */
 #define TELNETD_SHELL_USER          NULL
 
+/**
+ * @brief telnet 默认最大会话数量，`telentdInit`传入0时使用
+ */
+#define TELNETD_DEFAULT_MAX_SESSION 8
+
+/**
+ * @brief telnet 会话空闲超时时间，超时没有输入的会话会被关闭，设置为0时不超时
+ *        时间单位为`SHELL_GET_TICK()`单位，需要与毫秒一致
+ */
+#define TELNETD_IDLE_TIMEOUT        (10 * 60 * 1000)
+
+/**
+ * @brief telnet 空闲超时时间轮的槽数
+ */
+#define TELNETD_WHEEL_SIZE          64
+
+/**
+ * @brief telnet 空闲超时时间轮每个槽的时间跨度(ms)，也是空闲超时检查的精度
+ */
+#define TELNETD_WHEEL_INTERVAL      1000
+
+/**
+ * @brief telnet 会话发送缓冲区大小，缓冲区满时丢弃多余的输出
+ */
+#define TELNETD_SEND_BUFFER_SIZE    2048
+
+/**
+ * @brief telnet 每次接收数据的最大长度
+ */
+#define TELNETD_RECV_SIZE           256
+
+/**
+ * @brief telnet 客户端终端类型(TTYPE)的最大长度
+ */
+#define TELNETD_TERMINAL_TYPE_SIZE  32
+
+/**
+ * @brief telnet 有挂起的命令时，恢复命令执行的周期(ms)
+ */
+#define TELNETD_POLL_INTERVAL       10
+
 /**
  * @brief 新线程接口
  * 
@@ -55,10 +98,11 @@ typedef int (*NewThread)(void *, void *);
  * @brief telnet server初始化
  * 
  * @param newThreadInterface 新线程接口 
+ * @param maxSession 会话池大小，即最多同时连接的会话数量，传入0时使用`TELNETD_DEFAULT_MAX_SESSION`
  * 
  * @return int 0 启动telent server成功 -1 启动失败
  */
-int telentdInit(NewThread newThreadInterface);
+int telentdInit(NewThread newThreadInterface, unsigned short maxSession);
 
 /**
  * @brief 启动 telnet server
@@ -73,4 +117,22 @@ int telnetdStart();
  */
 void telnetdStop();
 
+/**
+ * @brief 设置telnet server 最大会话数量
+ * 
+ * @param max 最大会话数量，不能超过会话池大小
+ * 
+ * @return int 设置后的最大会话数量
+ */
+int telnetdSetMaxSession(int max);
+
+/**
+ * @brief 获取telnet客户端终端类型
+ * 
+ * @param shell shell对象
+ * 
+ * @return const char* 终端类型，未知时返回NULL
+ */
+const char *telnetdGetTerminalType(Shell *shell);
+
 #endif
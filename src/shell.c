@@ -16,6 +16,13 @@
 #include "shell_ext.h"
 
 
+/**
+ * @brief 命令行需要按语句解析(管道，多语句，重定向，后台命令)
+ */
+#define SHELL_USING_STATEMENT \
+    (SHELL_PIPE_BUFFER > 0 || SHELL_SUPPORT_MULTI_STATEMENT == 1 || SHELL_REDIRECT_BUFFER > 0 \
+     || SHELL_SUPPORT_BACKGROUND == 1)
+
 #if SHELL_USING_CMD_EXPORT == 1
 /**
  * @brief 默认用户
@@ -79,6 +86,22 @@ enum
 #if SHELL_EXEC_UNDEF_FUNC == 1
     SHELL_TEXT_PARAM_ERROR,                             /**< 参数错误 */
 #endif
+#if SHELL_PIPE_BUFFER > 0
+    SHELL_TEXT_PIPE_TOO_DEEP,                           /**< 管道级数过多 */
+#endif
+#if SHELL_REDIRECT_BUFFER > 0
+    SHELL_TEXT_REDIRECT_ERROR,                          /**< 重定向失败 */
+    SHELL_TEXT_REDIRECT_WRITE_ERROR,                    /**< 重定向写文件失败 */
+#endif
+#if SHELL_SUPPORT_BACKGROUND == 1
+    SHELL_TEXT_BACKGROUND_ERROR,                        /**< 后台执行失败 */
+#endif
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    SHELL_TEXT_QUEUE_FULL,                              /**< 执行队列已满 */
+#endif
+#if SHELL_USING_STATEMENT && SHELL_SUPPORT_EXPRESSION == 1
+    SHELL_TEXT_EXPR_OPERATOR,                           /**< 表达式中的运算符被识别为语句连接符 */
+#endif
 };
 
 
@@ -141,6 +164,28 @@ static const char *shellText[] =
     [SHELL_TEXT_PARAM_ERROR] = 
         "Parameter error\r\n",
 #endif
+#if SHELL_PIPE_BUFFER > 0
+    [SHELL_TEXT_PIPE_TOO_DEEP] = 
+        "Too many pipes\r\n",
+#endif
+#if SHELL_REDIRECT_BUFFER > 0
+    [SHELL_TEXT_REDIRECT_ERROR] = 
+        "Can't redirect: ",
+    [SHELL_TEXT_REDIRECT_WRITE_ERROR] = 
+        "Redirect write failed, output truncated\r\n",
+#endif
+#if SHELL_SUPPORT_BACKGROUND == 1
+    [SHELL_TEXT_BACKGROUND_ERROR] = 
+        "Can't run in background\r\n",
+#endif
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    [SHELL_TEXT_QUEUE_FULL] = 
+        "Command queue full\r\n",
+#endif
+#if SHELL_USING_STATEMENT && SHELL_SUPPORT_EXPRESSION == 1
+    [SHELL_TEXT_EXPR_OPERATOR] = 
+        "Operator after $var must be in parentheses or separated by spaces\r\n",
+#endif
 };
 
 
@@ -157,13 +202,69 @@ unsigned char pairedChars[][2] = {
 };
 
 
+#if SHELL_SUPPORT_EXPRESSION == 1
+/**
+ * @brief shell 判断`(`是否为表达式的括号
+ *        只有参数开头或者运算符之后的`(`才是表达式的括号，括号内的空格以及连接符不分割参数和语句，
+ *        `foo(`中的`(`是普通字符
+ * 
+ * @param prev `(`之前的字符，参数开头为0
+ * 
+ * @return int 1 表达式的括号 0 普通字符
+ */
+static int shellIsExprParen(char prev)
+{
+    return prev == 0 || strchr(" ,[(+-*/%<>&|^~", prev) != NULL;
+}
+#endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+
+
 /**
  * @brief shell对象表
  */
-static Shell *shellList[SHELL_MAX_NUMBER] = {NULL};
+/**
+ * @brief shell注册表
+ *        按照`SHELL_MAX_NUMBER`个shell一块组成链表，扩展的块只会追加不会释放，
+ *        所以遍历过程中可以安全地注册和移除shell
+ */
+typedef struct shell_registry
+{
+    Shell *slot[SHELL_MAX_NUMBER];                      /**< shell */
+    struct shell_registry *next;                        /**< 下一块 */
+} ShellRegistry;
+
+static ShellRegistry shellRegistry = {{NULL}, NULL};
+
+#if !defined(SHELL_GET_CURRENT) || !defined(SHELL_SET_CURRENT)
+/**
+ * @brief 当前执行命令的shell
+ */
+static SHELL_THREAD_LOCAL Shell *shellCurrent = NULL;
+#define     SHELL_GET_CURRENT()         shellCurrent
+#define     SHELL_SET_CURRENT(shell)    (shellCurrent = (shell))
+#endif
+
+#if SHELL_EXEC_QUEUE_SIZE > 0
+/**
+ * @brief 获取shell的读写函数
+ *        使能执行队列时，执行上下文之外(输入处理，尾行输出等)使用保存的端口读写函数，
+ *        执行上下文中命令替换的读写函数(取消，管道，重定向)只对命令有效，需要当前shell为线程局部
+ */
+#define     SHELL_IO(shell, io) \
+            (((shell)->queue.enable && SHELL_GET_CURRENT() != (shell)) ? (shell)->queue.io : (shell)->io)
+#else
+#define     SHELL_IO(shell, io)         ((shell)->io)
+#endif
+
+#if SHELL_SUPPORT_BACKGROUND == 1
+/**
+ * @brief shell 移除shell时结束后台命令的函数
+ */
+static ShellBackgroundRemove shellBackgroundRemove = NULL;
+#endif
 
 
-static void shellAdd(Shell *shell);
+static int shellAdd(Shell *shell);
 static void shellWritePrompt(Shell *shell, unsigned char newline);
 static void shellWriteReturnValue(Shell *shell, int value);
 static int shellShowVar(Shell *shell, ShellCommand *command);
@@ -172,19 +273,68 @@ ShellCommand* shellSeekCommand(Shell *shell,
                                const char *cmd,
                                ShellCommand *base,
                                unsigned short compareLength);
+ShellCommand* shellSeekVar(Shell *shell, const char *name);
+int shellGetVarValue(Shell *shell, ShellCommand *command);
 static void shellWriteCommandHelp(Shell *shell, char *cmd);
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+static void shellMachineInput(Shell *shell, char data);
+#endif
+#if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+static void shellEndLineFlush(Shell *shell);
+#endif
 
 /**
  * @brief shell 初始化
+ *        shell注册失败时仍然可以使用，但是不能通过`shellForEach`遍历到
  * 
  * @param shell shell对象
+ * 
+ * @return int 0 初始化成功 -1 shell注册表已满或者扩展注册表时分配内存失败
  */
-void shellInit(Shell *shell, char *buffer, unsigned short size)
+int shellInit(Shell *shell, char *buffer, unsigned short size)
 {
+    int ret;
+
     shell->parser.length = 0;
     shell->parser.cursor = 0;
     shell->info.user = NULL;
     shell->status.isChecked = 1;
+#if SHELL_PROMPT_BUFFER > 0
+    shell->prompt.length = 0;
+#endif
+#if SHELL_PARAM_ARENA_SIZE > 0
+    shell->arena.top = 0;
+#endif
+#if SHELL_VAR_CACHE_SIZE > 0
+    shell->varCache.base = NULL;
+#endif
+#if SHELL_SUPPORT_EXPRESSION == 1 && SHELL_EXPR_CACHE_SIZE > 0
+    for (short i = 0; i < SHELL_EXPR_CACHE_SIZE; i++)
+    {
+        shell->exprCache.program[i].length = 0;
+    }
+    shell->exprCache.next = 0;
+#endif
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    shell->queue.head = 0;
+    shell->queue.tail = 0;
+    shell->queue.enable = 0;
+#endif
+#if SHELL_SUPPORT_CANCEL == 1
+    shell->cancel.pendingLength = 0;
+#endif
+#if SHELL_SUPPORT_YIELD == 1
+    shell->yield.command = NULL;
+    shell->yield.suspend = 0;
+#endif
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    shell->status.isMachine = 0;
+    shell->status.machineOverflow = 0;
+    shell->status.escapeState = 0;
+#endif
+#if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+    shell->status.endLinePending = 0;
+#endif
 
     shell->parser.buffer = buffer;
     shell->parser.bufferSize = size / (SHELL_HISTORY_MAX_NUMBER + 1);
@@ -224,1277 +374,3604 @@ void shellInit(Shell *shell, char *buffer, unsigned short size)
     shell->commandList.count = shellCommandCount;
 #endif
 
-    shellAdd(shell);
+    ret = shellAdd(shell);
 
     shellSetUser(shell, shellSeekCommand(shell,
                                          SHELL_DEFAULT_USER,
                                          shell->commandList.base,
                                          0));
     shellWritePrompt(shell, 1);
+    return ret;
 }
 
 
 /**
  * @brief 添加shell
+ *        使用原子操作占用注册表中的空位，注册表满时，使能`SHELL_REGISTRY_GROW`的情况下追加新的一块
  * 
  * @param shell shell对象
+ * 
+ * @return int 0 添加成功 -1 注册表已满或者分配内存失败
  */
-static void shellAdd(Shell *shell)
+static int shellAdd(Shell *shell)
 {
-    for (short i = 0; i < SHELL_MAX_NUMBER; i++)
+    ShellRegistry *registry = &shellRegistry;
+
+    while (registry)
     {
-        if (shellList[i] == NULL)
+        for (short i = 0; i < SHELL_MAX_NUMBER; i++)
         {
-            shellList[i] = shell;
-            return;
+            Shell *expected = NULL;
+            if (SHELL_ATOMIC_LOAD(&registry->slot[i]) == NULL
+                && SHELL_ATOMIC_CAS(&registry->slot[i], &expected, shell))
+            {
+                return 0;
+            }
+        }
+    #if SHELL_REGISTRY_GROW == 1
+        if (SHELL_ATOMIC_LOAD(&registry->next) == NULL)
+        {
+            ShellRegistry *block = SHELL_MALLOC(sizeof(ShellRegistry));
+            ShellRegistry *expected = NULL;
+            if (block == NULL)
+            {
+                return -1;
+            }
+            memset(block, 0, sizeof(ShellRegistry));
+            if (!SHELL_ATOMIC_CAS(&registry->next, &expected, block))
+            {
+                SHELL_FREE(block);
+            }
         }
+    #endif /** SHELL_REGISTRY_GROW == 1 */
+        registry = SHELL_ATOMIC_LOAD(&registry->next);
     }
+    return -1;
 }
 
 /**
  * @brief 移除shell
+ *        使能后台命令时，同时结束该shell的后台命令，不能在持有该shell的锁时调用
  * 
  * @param shell shell对象
  * 
  */
 void shellRemove(Shell *shell)
 {
-    for (short i = 0; i < SHELL_MAX_NUMBER; i++)
+#if SHELL_SUPPORT_BACKGROUND == 1
+    if (shellBackgroundRemove)
     {
-        if (shellList[i] == shell)
+        shellBackgroundRemove(shell);
+    }
+#endif
+    for (ShellRegistry *registry = &shellRegistry;
+         registry;
+         registry = SHELL_ATOMIC_LOAD(&registry->next))
+    {
+        for (short i = 0; i < SHELL_MAX_NUMBER; i++)
         {
-            shellList[i] = NULL;
-            return;
+            Shell *expected = shell;
+            if (SHELL_ATOMIC_LOAD(&registry->slot[i]) == shell
+                && SHELL_ATOMIC_CAS(&registry->slot[i], &expected, NULL))
+            {
+                return;
+            }
         }
     }
 }
 
 /**
- * @brief 获取当前活动shell
+ * @brief 遍历注册的shell
+ *        遍历过程中可以注册或者移除shell，遍历开始后注册的shell可能不会被遍历到
  * 
- * @return Shell* 当前活动shell对象
+ * @param handler 处理函数
+ * @param param 处理函数参数
  */
-Shell* shellGetCurrent(void)
+void shellForEach(void (*handler)(Shell *shell, void *param), void *param)
 {
-    for (short i = 0; i < SHELL_MAX_NUMBER; i++)
+    SHELL_ASSERT(handler, return);
+    for (ShellRegistry *registry = &shellRegistry;
+         registry;
+         registry = SHELL_ATOMIC_LOAD(&registry->next))
     {
-        if (shellList[i] && shellList[i]->status.isActive)
+        for (short i = 0; i < SHELL_MAX_NUMBER; i++)
         {
-            return shellList[i];
+            Shell *shell = SHELL_ATOMIC_LOAD(&registry->slot[i]);
+            if (shell)
+            {
+                handler(shell, param);
+            }
         }
     }
-    return NULL;
 }
 
-
 /**
- * @brief shell写字符
+ * @brief 获取当前活动shell
+ *        返回当前线程中正在执行命令的shell，由`shellRunCommand`记录
  * 
- * @param shell shell对象
- * @param data 字符数据
+ * @return Shell* 当前活动shell对象
  */
-static void shellWriteByte(Shell *shell, char data)
+Shell* shellGetCurrent(void)
 {
-    shell->write(&data, 1);
+    return SHELL_GET_CURRENT();
 }
 
 
+#if SHELL_USING_LOCK == 1
 /**
- * @brief shell 写字符串
+ * @brief shell 命令等待时释放输入处理持有的shell锁
+ *        命令在`shellHandler`等输入处理中执行时持有shell锁，长时间等待前释放，
+ *        其他线程(比如后台任务的尾行输出)才能加锁，使用执行队列时命令执行期间不持有锁
  * 
  * @param shell shell对象
- * @param string 字符串数据
  * 
- * @return unsigned short 写入字符的数量
+ * @return unsigned char 1 释放了锁 0 没有持有锁，作为`shellLockRestore`的参数
  */
-unsigned short shellWriteString(Shell *shell, const char *string)
+unsigned char shellLockRelease(Shell *shell)
 {
-    unsigned short count = 0;
-    const char *p = string;
-    SHELL_ASSERT(shell->write, return 0);
-    while(*p++)
+    SHELL_ASSERT(shell, return 0);
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    if (shell->queue.enable)
     {
-        count ++;
+        return 0;
+    }
+#endif
+    if (!shell->status.isLocked)
+    {
+        return 0;
     }
-    return shell->write((char *)string, count);
+    shell->status.isLocked = 0;
+    SHELL_UNLOCK(shell);
+    return 1;
 }
 
 
 /**
- * @brief shell 写命令描述字符串
+ * @brief shell 命令等待结束后重新获取`shellLockRelease`释放的shell锁
  * 
  * @param shell shell对象
- * @param string 字符串数据
- * 
- * @return unsigned short 写入字符的数量
+ * @param locked `shellLockRelease`的返回值
  */
-static unsigned short shellWriteCommandDesc(Shell *shell, const char *string)
+void shellLockRestore(Shell *shell, unsigned char locked)
 {
-    unsigned short count = 0;
-    const char *p = string;
-    SHELL_ASSERT(shell->write, return 0);
-    while (*p && *p != '\r' && *p != '\n')
-    {
-        p++;
-        count++;
-    }
-    
-    if (count > 36)
-    {
-        shell->write((char *)string, 36);
-        shell->write("...", 3);
-    }
-    else
+    SHELL_ASSERT(shell, return);
+    if (locked)
     {
-        shell->write((char *)string, count);
+        SHELL_LOCK(shell);
+        shell->status.isLocked = 1;
     }
-    return count > 36 ? 36 : 39;
+}
+#endif /** SHELL_USING_LOCK == 1 */
+#if SHELL_SUPPORT_CANCEL == 1
+/**
+ * @brief shell 开始一行命令时重置取消标志和超时
+ * 
+ * @param shell shell对象
+ */
+static void shellCancelReset(Shell *shell)
+{
+    SHELL_ATOMIC_STORE(&shell->cancel.flag, 0);
+    shell->cancel.start = SHELL_GET_TICK();
+    shell->cancel.timeout = SHELL_CANCEL_TIMEOUT;
 }
 
 
 /**
- * @brief shell写命令提示符
+ * @brief shell 检查命令是否被取消
+ *        超时后同时设置取消标志
  * 
  * @param shell shell对象
- * @param newline 新行
  * 
+ * @return int 1 已取消 0 未取消
  */
-static void shellWritePrompt(Shell *shell, unsigned char newline)
+static int shellCheckCancel(Shell *shell)
 {
-    if (shell->status.isChecked)
+    if (shell == NULL)
     {
-        if (newline)
-        {
-            shellWriteString(shell, "\r\n");
-        }
-        shellWriteString(shell, shell->info.user->data.user.name);
-        shellWriteString(shell, ":");
-        shellWriteString(shell, shell->info.path ? shell->info.path : "/");
-        shellWriteString(shell, "$ ");
+        return 0;
     }
-    else
+    if (!SHELL_ATOMIC_LOAD(&shell->cancel.flag) && shell->cancel.timeout
+        && SHELL_GET_TICK() - shell->cancel.start >= shell->cancel.timeout)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_PASSWORD_HINT]);
+        SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
     }
+    return SHELL_ATOMIC_LOAD(&shell->cancel.flag);
 }
 
 
-#if SHELL_PRINT_BUFFER > 0
 /**
- * @brief shell格式化输出
+ * @brief shell 检查是否有命令正在执行
+ *        使用执行队列时，命令在执行上下文中执行，队列不为空时认为有命令正在执行
  * 
  * @param shell shell对象
- * @param fmt 格式化字符串
- * @param ... 参数
+ * 
+ * @return int 1 有命令正在执行 0 没有命令正在执行
  */
-void shellPrint(Shell *shell, const char *fmt, ...)
+static int shellIsBusy(Shell *shell)
 {
-    char buffer[SHELL_PRINT_BUFFER];
-    va_list vargs;
-    int len;
-
-    SHELL_ASSERT(shell, return);
-
-    va_start(vargs, fmt);
-    len = vsnprintf(buffer, SHELL_PRINT_BUFFER, fmt, vargs);
-    va_end(vargs);
-    if (len > SHELL_PRINT_BUFFER)
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    if (shell->queue.enable)
     {
-        len = SHELL_PRINT_BUFFER;
+        return SHELL_ATOMIC_LOAD(&shell->queue.head) != shell->queue.tail;
     }
-    shell->write(buffer, len);
-}
 #endif
+    return shell->status.isActive;
+}
 
 
-#if SHELL_SCAN_BUFFER > 0
 /**
- * @brief shell格式化输入
+ * @brief shell 取消正在执行的命令
+ *        只设置取消标志，命令需要自行查询并返回，可以在其他线程或者中断中调用
  * 
  * @param shell shell对象
- * @param fmt 格式化字符串
- * @param ... 参数
  */
-void shellScan(Shell *shell, char *fmt, ...)
+void shellCancel(Shell *shell)
 {
-    char buffer[SHELL_SCAN_BUFFER];
-    va_list vargs;
-    short index = 0;
-
     SHELL_ASSERT(shell, return);
-
-    if (shell->read)
-    {
-        do {
-            if (shell->read(&buffer[index], 1) == 1)
-            {
-                shell->write(&buffer[index], 1);
-                index++;
-            }
-        } while (buffer[index -1] != '\r' && buffer[index -1] != '\n' && index < SHELL_SCAN_BUFFER);
-        shellWriteString(shell, "\r\n");
-        buffer[index] = '\0';
-    }
-
-    va_start(vargs, fmt);
-    vsscanf(buffer, fmt, vargs);
-    va_end(vargs);
+    SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
 }
-#endif
 
 
 /**
- * @brief shell 检查命令权限
+ * @brief shell 设置当前命令的超时时间
+ *        从调用时开始计时，覆盖`SHELL_CANCEL_TIMEOUT`的默认值
  * 
  * @param shell shell对象
- * @param command ShellCommand
- * 
- * @return signed char 0 当前用户具有该命令权限
- * @return signec char -1 当前用户不具有该命令权限
+ * @param timeout 超时时间，为0时不超时
  */
-signed char shellCheckPermission(Shell *shell, ShellCommand *command)
+void shellSetTimeout(Shell *shell, unsigned int timeout)
 {
-    return ((!command->attr.attrs.permission
-                || command->attr.attrs.type == SHELL_TYPE_USER
-                || (shell->info.user
-                    && (command->attr.attrs.permission 
-                        & shell->info.user->attr.attrs.permission)))
-            && (shell->status.isChecked
-                || command->attr.attrs.enableUnchecked))
-            ? 0 : -1;
+    SHELL_ASSERT(shell, return);
+    shell->cancel.start = SHELL_GET_TICK();
+    shell->cancel.timeout = timeout;
 }
 
 
 /**
- * @brief int转16进制字符串
+ * @brief shell 从被替换的读函数读取输入，过滤取消按键并设置取消标志
+ *        先返回查询取消时保存的待处理输入
  * 
- * @param value 数值
- * @param buffer 缓冲
+ * @param shell shell对象
+ * @param data 数据
+ * @param len 数据长度
  * 
- * @return signed char 转换后有效数据长度
+ * @return signed short 过滤后的数据长度
  */
-signed char shellToHex(unsigned int value, char *buffer)
+static signed short shellCancelReadInput(Shell *shell, char *data, unsigned short len)
 {
-    char byte;
-    unsigned char i = 8;
-    buffer[8] = 0;
-    while (value)
+    signed short length;
+    signed short count = 0;
+
+    if (shell->cancel.pendingLength > 0)
     {
-        byte = value & 0x0000000F;
-        buffer[--i] = (byte > 9) ? (byte + 87) : (byte + 48);
-        value >>= 4;
+        count = shell->cancel.pendingLength < len ? shell->cancel.pendingLength : len;
+        memcpy(data, shell->cancel.pending, count);
+        shell->cancel.pendingLength -= count;
+        memmove(shell->cancel.pending, shell->cancel.pending + count, shell->cancel.pendingLength);
+        return count;
     }
-    return 8 - i;
+    if (shell->cancel.read == NULL)
+    {
+        return 0;
+    }
+    length = shell->cancel.read(data, len);
+    for (signed short i = 0; i < length; i++)
+    {
+        if (data[i] == SHELL_CANCEL_KEY)
+        {
+            SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
+        }
+        else
+        {
+            data[count++] = data[i];
+        }
+    }
+    return length < 0 ? length : count;
 }
 
 
 /**
-* @brief int转10进制字符串
+ * @brief shell 命令执行期间的读函数
+ *        调用原有的读函数，过滤取消按键并设置取消标志
  * 
- * @param value 数值
- * @param buffer 缓冲
+ * @param data 数据
+ * @param len 数据长度
  * 
- * @return signed char 转换后有效数据长度
+ * @return signed short 过滤后的数据长度
  */
-signed char shellToDec(int value, char *buffer)
+static signed short shellCancelRead(char *data, unsigned short len)
 {
-    unsigned char i = 11;
-    int v = value;
-    if (value < 0)
-    {
-        v = -value;
-    }
-    buffer[11] = 0;
-    while (v)
-    {
-        buffer[--i] = v % 10 + 48;
-        v /= 10;
-    }
-    if (value < 0)
+    Shell *shell = shellGetCurrent();
+
+    if (shell == NULL)
     {
-        buffer[--i] = '-';
-    }
-    if (value == 0) {
-        buffer[--i] = '0';
+        return 0;
     }
-    return 11 - i;
+    return shellCancelReadInput(shell, data, len);
 }
 
 
 /**
- * @brief shell字符串复制
+ * @brief shell 读取命令没有读取的输入，检查取消按键
+ *        其他输入保存为待处理输入，之后由命令或者`shellTask`读取，超出缓冲时丢弃最早的输入
  * 
- * @param dest 目标字符串
- * @param src 源字符串
- * @return unsigned short 字符串长度
+ * @param shell shell对象
  */
-static unsigned short shellStringCopy(char *dest, char* src)
+static void shellCancelDrain(Shell *shell)
 {
-    unsigned short count = 0;
-    while (*(src + count))
+    char buffer[SHELL_CANCEL_PENDING_SIZE];
+    signed short length;
+
+    if (shell->read != shellCancelRead || shell->cancel.read == NULL)
     {
-        *(dest + count) = *(src + count);
-        count++;
+        return;
+    }
+    length = shell->cancel.read(buffer, sizeof(buffer));
+    for (signed short i = 0; i < length; i++)
+    {
+        if (buffer[i] == SHELL_CANCEL_KEY)
+        {
+            SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
+            continue;
+        }
+        if (shell->cancel.pendingLength == SHELL_CANCEL_PENDING_SIZE)
+        {
+            memmove(shell->cancel.pending, shell->cancel.pending + 1, SHELL_CANCEL_PENDING_SIZE - 1);
+            shell->cancel.pendingLength--;
+        }
+        shell->cancel.pending[shell->cancel.pendingLength++] = buffer[i];
     }
-    *(dest + count) = 0;
-    return count;
 }
 
 
 /**
- * @brief shell字符串比较
+ * @brief shell 查询当前命令是否被取消
+ *        长时间运行或者循环读取输入的命令需要周期调用，返回1时尽快返回，
+ *        命令从端口读取输入时，同时读取端口上的输入检查取消按键
  * 
- * @param dest 目标字符串
- * @param src 源字符串
- * @return unsigned short 匹配长度
+ * @return int 1 已取消 0 未取消
  */
-static unsigned short shellStringCompare(char* dest, char *src)
+int shellIsCancelled(void)
 {
-    unsigned short match = 0;
-    unsigned short i = 0;
+    Shell *shell = shellGetCurrent();
 
-    while (*(dest +i) && *(src + i))
+    if (shell != NULL && !SHELL_ATOMIC_LOAD(&shell->cancel.flag))
     {
-        if (*(dest + i) != *(src +i))
-        {
-            break;
-        }
-        match ++;
-        i++;
+        shellCancelDrain(shell);
     }
-    return match;
+    return shellCheckCancel(shell);
 }
+#endif /** SHELL_SUPPORT_CANCEL == 1 */
 
 
+#if SHELL_SUPPORT_MACHINE_MODE == 1
 /**
- * @brief shell获取命令名
+ * @brief shell 机器模式过滤转义序列
+ *        过滤`ESC [ 参数 结束字符`形式的控制序列以及`ESC 字符`形式的双字节序列
  * 
- * @param command 命令
- * @return const char* 命令名
+ * @param state 过滤状态
+ * @param data 字符数据
+ * 
+ * @return unsigned char 1 字符需要输出 0 字符被过滤
  */
-static const char* shellGetCommandName(ShellCommand *command)
+static unsigned char shellEscapeFilter(unsigned char *state, char data)
 {
-    static char buffer[9];
-    for (unsigned char i = 0; i < 9; i++)
-    {
-        buffer[i] = '0';
-    }
-    if (command->attr.attrs.type <= SHELL_TYPE_CMD_FUNC)
-    {
-        return command->data.cmd.name;
-    }
-    else if (command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
-    {
-        return command->data.var.name;
-    }
-    else if (command->attr.attrs.type <= SHELL_TYPE_USER)
+    switch (*state)
     {
-        return command->data.user.name;
-    }
-#if SHELL_USING_FUNC_SIGNATURE == 1
-    else if (command->attr.attrs.type == SHELL_TYPE_PARAM_PARSER)
-    {
-        return command->data.paramParser.type;
-    }
-#endif
-    else
-    {
-        shellToHex(command->data.key.value, buffer);
-        return buffer;
+    case 0:
+        if (data == 0x1B)
+        {
+            *state = 1;
+            return 0;
+        }
+        return 1;
+    case 1:
+        *state = (data == '[') ? 2 : 0;
+        return 0;
+    default:
+        if (data >= 0x40 && data <= 0x7E)
+        {
+            *state = 0;
+        }
+        return 0;
     }
 }
 
 
 /**
- * @brief shell获取命令描述
+ * @brief shell 机器模式写数据帧
+ *        数据中的转义序列会被过滤，转义序列跨越多次写入时同样可以被过滤
  * 
- * @param command 命令
- * @return const char* 命令描述
+ * @param shell shell对象
+ * @param type 帧类型
+ * @param data 数据
+ * @param len 数据长度
  */
-static const char* shellGetCommandDesc(ShellCommand *command)
+static void shellWriteFrame(Shell *shell, ShellFrameType type, const char *data, unsigned short len)
 {
-    if (command->attr.attrs.type <= SHELL_TYPE_CMD_FUNC)
+    unsigned char state = shell->status.escapeState;
+    unsigned short count = 0;
+    unsigned short start = 0;
+    char head[4];
+
+    for (unsigned short i = 0; i < len; i++)
     {
-        return command->data.cmd.desc;
+        count += shellEscapeFilter(&state, data[i]);
     }
-    else if (command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    if (count > 0)
     {
-        return command->data.var.desc;
+        head[0] = (char) SHELL_FRAME_HEAD;
+        head[1] = (char) type;
+        head[2] = (char) (count & 0xFF);
+        head[3] = (char) (count >> 8);
+        SHELL_IO(shell, write)(head, 4);
+
+        state = shell->status.escapeState;
+        for (unsigned short i = 0; i < len; i++)
+        {
+            if (!shellEscapeFilter(&state, data[i]))
+            {
+                if (i > start)
+                {
+                    SHELL_IO(shell, write)((char *)data + start, i - start);
+                }
+                start = i + 1;
+            }
+        }
+        if (len > start)
+        {
+            SHELL_IO(shell, write)((char *)data + start, len - start);
+        }
     }
-    else if (command->attr.attrs.type <= SHELL_TYPE_USER)
+    shell->status.escapeState = state;
+}
+
+
+/**
+ * @brief shell 机器模式写命令结果帧
+ * 
+ * @param shell shell对象
+ * @param status 结果状态
+ * @param value 命令返回值
+ */
+static void shellWriteResult(Shell *shell, ShellResultStatus status, int value)
+{
+    char frame[9];
+    frame[0] = (char) SHELL_FRAME_HEAD;
+    frame[1] = (char) SHELL_FRAME_RESULT;
+    frame[2] = 5;
+    frame[3] = 0;
+    frame[4] = (char) status;
+    for (short i = 0; i < 4; i++)
     {
-        return command->data.user.desc;
+        frame[5 + i] = (char) (((unsigned int) value >> (i * 8)) & 0xFF);
     }
-    else
+    SHELL_IO(shell, write)(frame, 9);
+}
+#endif /** SHELL_SUPPORT_MACHINE_MODE == 1 */
+
+
+/**
+ * @brief shell 写数据
+ *        机器模式下，数据会作为输出帧写入
+ * 
+ * @param shell shell对象
+ * @param data 数据
+ * @param len 数据长度
+ * 
+ * @return unsigned short 写入数据的长度
+ */
+static unsigned short shellWriteData(Shell *shell, const char *data, unsigned short len)
+{
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    if (shell->status.isMachine)
     {
-        return command->data.key.desc;
+        shellWriteFrame(shell, SHELL_FRAME_OUTPUT, data, len);
+        return len;
     }
+#endif
+    return SHELL_IO(shell, write)((char *)data, len);
 }
 
+
 /**
- * @brief shell 列出命令条目
+ * @brief shell写字符
  * 
  * @param shell shell对象
- * @param item 命令条目
+ * @param data 字符数据
  */
-void shellListItem(Shell *shell, ShellCommand *item)
+static void shellWriteByte(Shell *shell, char data)
 {
-    short spaceLength;
+    shellWriteData(shell, &data, 1);
+}
 
-    spaceLength = 22 - shellWriteString(shell, shellGetCommandName(item));
-    spaceLength = (spaceLength > 0) ? spaceLength : 4;
-    do {
-        shellWriteByte(shell, ' ');
-    } while (--spaceLength);
-    if (item->attr.attrs.type <= SHELL_TYPE_CMD_FUNC)
+
+/**
+ * @brief shell 写字符串
+ * 
+ * @param shell shell对象
+ * @param string 字符串数据
+ * 
+ * @return unsigned short 写入字符的数量
+ */
+unsigned short shellWriteString(Shell *shell, const char *string)
+{
+    unsigned short count = 0;
+    const char *p = string;
+    SHELL_ASSERT(shell->write, return 0);
+    while(*p++)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_TYPE_CMD]);
+        count ++;
     }
-    else if (item->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    return shellWriteData(shell, string, count);
+}
+
+
+/**
+ * @brief shell 写命令描述字符串
+ *        只写第一行，终端宽度已知时按剩余宽度截断，否则最多写36个字符
+ * 
+ * @param shell shell对象
+ * @param string 字符串数据
+ * @param column 当前光标所在列
+ * 
+ * @return unsigned short 写入字符的数量
+ */
+static unsigned short shellWriteCommandDesc(Shell *shell, const char *string, unsigned short column)
+{
+    unsigned short count = 0;
+    unsigned short limit = 36;
+    const char *p = string;
+    SHELL_ASSERT(shell->write, return 0);
+    while (*p && *p != '\r' && *p != '\n')
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_TYPE_VAR]);
+        p++;
+        count++;
     }
-    else if (item->attr.attrs.type <= SHELL_TYPE_USER)
+    if (shell->info.width > 0)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_TYPE_USER]);
+        limit = shell->info.width > column + 4 ? shell->info.width - column - 4 : 0;
     }
-    else if (item->attr.attrs.type <= SHELL_TYPE_KEY)
+    
+    if (count > limit)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_TYPE_KEY]);
+        shellWriteData(shell, string, limit);
+        shellWriteData(shell, "...", 3);
     }
     else
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_TYPE_NONE]);
-    }
-#if SHELL_HELP_SHOW_PERMISSION == 1
-    shellWriteString(shell, "  ");
-    for (signed char i = 7; i >= 0; i--)
-    {
-        shellWriteByte(shell, item->attr.attrs.permission & (1 << i) ? 'x' : '-');
+        shellWriteData(shell, string, count);
     }
-#endif
-    shellWriteString(shell, "  ");
-    shellWriteCommandDesc(shell, shellGetCommandDesc(item));
-    shellWriteString(shell, "\r\n");
+    return count > limit ? limit + 3 : count;
 }
 
 
+#if SHELL_PROMPT_BUFFER > 0
 /**
- * @brief shell列出可执行命令
+ * @brief shell 生成命令提示符缓存
+ *        提示符格式为`\r\n用户名:路径$ `，设置用户，路径以及锁定状态改变时重新生成，长度超过缓冲区时，
+ *        将长度设置为大于缓冲区的值，表示不使用缓存
  * 
  * @param shell shell对象
  */
-void shellListCommand(Shell *shell)
+static void shellUpdatePrompt(Shell *shell)
 {
-    ShellCommand *base = (ShellCommand *)shell->commandList.base;
-    shellWriteString(shell, shellText[SHELL_TEXT_CMD_LIST]);
-    for (short i = 0; i < shell->commandList.count; i++)
+    const char *items[] = {
+        "\r\n",
+        shell->info.user->data.user.name,
+        ":",
+        shell->info.path ? shell->info.path : "/",
+        "$ "
+    };
+    unsigned short length = 0;
+
+    for (unsigned short i = 0; i < sizeof(items) / sizeof(char *); i++)
     {
-        if (base[i].attr.attrs.type <= SHELL_TYPE_CMD_FUNC
-            && shellCheckPermission(shell, &base[i]) == 0)
+        const char *p = items[i];
+        while (*p)
         {
-            shellListItem(shell, &base[i]);
+            if (length >= SHELL_PROMPT_BUFFER)
+            {
+                shell->prompt.length = SHELL_PROMPT_BUFFER + 1;
+                return;
+            }
+            shell->prompt.buffer[length++] = *p++;
         }
     }
+    shell->prompt.length = length;
 }
+#endif /** SHELL_PROMPT_BUFFER > 0 */
 
 
 /**
- * @brief shell列出变量
+ * @brief shell写命令提示符
  * 
  * @param shell shell对象
+ * @param newline 新行
+ * 
  */
-void shellListVar(Shell *shell)
+static void shellWritePrompt(Shell *shell, unsigned char newline)
 {
-    ShellCommand *base = (ShellCommand *)shell->commandList.base;
-    shellWriteString(shell, shellText[SHELL_TEXT_VAR_LIST]);
-    for (short i = 0; i < shell->commandList.count; i++)
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    if (shell->status.isMachine)
     {
-        if (base[i].attr.attrs.type > SHELL_TYPE_CMD_FUNC
-            && base[i].attr.attrs.type <= SHELL_TYPE_VAR_NODE
-            && shellCheckPermission(shell, &base[i]) == 0)
+        return;
+    }
+#endif
+    if (shell->status.isChecked)
+    {
+#if SHELL_PROMPT_BUFFER > 0
+        if (shell->prompt.length == 0)
         {
-            shellListItem(shell, &base[i]);
+            shellUpdatePrompt(shell);
+        }
+        if (shell->prompt.length <= SHELL_PROMPT_BUFFER)
+        {
+            SHELL_IO(shell, write)(shell->prompt.buffer + (newline ? 0 : 2),
+                                   shell->prompt.length - (newline ? 0 : 2));
+            return;
+        }
+#endif /** SHELL_PROMPT_BUFFER > 0 */
+        if (newline)
+        {
+            shellWriteString(shell, "\r\n");
         }
+        shellWriteString(shell, shell->info.user->data.user.name);
+        shellWriteString(shell, ":");
+        shellWriteString(shell, shell->info.path ? shell->info.path : "/");
+        shellWriteString(shell, "$ ");
+    }
+    else
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_PASSWORD_HINT]);
     }
 }
 
 
+#if SHELL_PRINT_BUFFER > 0
 /**
- * @brief shell列出用户
+ * @brief shell格式化输出
  * 
  * @param shell shell对象
+ * @param fmt 格式化字符串
+ * @param ... 参数
  */
-void shellListUser(Shell *shell)
+void shellPrint(Shell *shell, const char *fmt, ...)
 {
-    ShellCommand *base = (ShellCommand *)shell->commandList.base;
-    shellWriteString(shell, shellText[SHELL_TEXT_USER_LIST]);
-    for (short i = 0; i < shell->commandList.count; i++)
+    char buffer[SHELL_PRINT_BUFFER];
+    va_list vargs;
+    int len;
+
+    SHELL_ASSERT(shell, return);
+
+    va_start(vargs, fmt);
+    len = vsnprintf(buffer, SHELL_PRINT_BUFFER, fmt, vargs);
+    va_end(vargs);
+    if (len > SHELL_PRINT_BUFFER)
     {
-        if (base[i].attr.attrs.type > SHELL_TYPE_VAR_NODE
-            && base[i].attr.attrs.type <= SHELL_TYPE_USER
-            && shellCheckPermission(shell, &base[i]) == 0)
-        {
-            shellListItem(shell, &base[i]);
-        }
+        len = SHELL_PRINT_BUFFER;
     }
+    shellWriteData(shell, buffer, len);
 }
+#endif
 
 
 /**
- * @brief shell列出按键
+ * @brief shell 等待输入
+ *        没有输入时，阻塞读取输入的循环调用此函数让出CPU，未设置`waitInput`时直接返回，
+ *        使能取消时，等待时间不超过命令剩余的超时时间
  * 
  * @param shell shell对象
+ * @param timeout 等待时间，单位为`SHELL_GET_TICK()`单位，`SHELL_WAIT_FOREVER`表示一直等待
+ * 
+ * @return int 1 有输入 0 超时或者未设置等待函数
  */
-void shellListKey(Shell *shell)
+int shellWaitInput(Shell *shell, unsigned int timeout)
 {
-    ShellCommand *base = (ShellCommand *)shell->commandList.base;
-    shellWriteString(shell, shellText[SHELL_TEXT_KEY_LIST]);
-    for (short i = 0; i < shell->commandList.count; i++)
+    SHELL_ASSERT(shell, return 0);
+    if (shell->waitInput == NULL)
     {
-        if (base[i].attr.attrs.type > SHELL_TYPE_USER
-            && base[i].attr.attrs.type <= SHELL_TYPE_KEY
-            && shellCheckPermission(shell, &base[i]) == 0)
+        return 0;
+    }
+#if SHELL_SUPPORT_CANCEL == 1
+    if (shell->status.isActive && shell->cancel.timeout)
+    {
+        unsigned int elapsed = SHELL_GET_TICK() - shell->cancel.start;
+        unsigned int remain = elapsed >= shell->cancel.timeout
+                              ? 0 : shell->cancel.timeout - elapsed;
+        if (remain < timeout)
         {
-            shellListItem(shell, &base[i]);
+            timeout = remain;
         }
     }
+#endif
+    return timeout > 0 && shell->waitInput(timeout) > 0;
 }
 
 
+#if SHELL_SCAN_BUFFER > 0
 /**
- * @brief shell列出所有命令
+ * @brief shell格式化输入
  * 
  * @param shell shell对象
+ * @param fmt 格式化字符串
+ * @param ... 参数
  */
-void shellListAll(Shell *shell)
+void shellScan(Shell *shell, char *fmt, ...)
 {
-#if SHELL_HELP_LIST_USER == 1
+    char buffer[SHELL_SCAN_BUFFER];
+    va_list vargs;
+    short index = 0;
+
+    SHELL_ASSERT(shell, return);
+
+    if (shell->read)
+    {
+        do {
+            if (shell->read(&buffer[index], 1) == 1)
+            {
+            #if SHELL_SUPPORT_MACHINE_MODE == 1
+                if (!shell->status.isMachine)
+            #endif
+                {
+                    shell->write(&buffer[index], 1);
+                }
+                index++;
+            }
+        #if SHELL_SUPPORT_CANCEL == 1
+            else if (shellCheckCancel(shell))
+            {
+                shellWriteString(shell, "\r\n");
+                return;
+            }
+        #endif
+            else
+            {
+                shellWaitInput(shell, SHELL_WAIT_FOREVER);
+            }
+        } while ((index == 0 || (buffer[index -1] != '\r' && buffer[index -1] != '\n'))
+                 && index < SHELL_SCAN_BUFFER);
+    #if SHELL_SUPPORT_MACHINE_MODE == 1
+        if (!shell->status.isMachine)
+    #endif
+        {
+            shellWriteString(shell, "\r\n");
+        }
+        buffer[index] = '\0';
+    }
+
+    va_start(vargs, fmt);
+    vsscanf(buffer, fmt, vargs);
+    va_end(vargs);
+}
+#endif
+
+
+/**
+ * @brief shell 检查命令权限
+ * 
+ * @param shell shell对象
+ * @param command ShellCommand
+ * 
+ * @return signed char 0 当前用户具有该命令权限
+ * @return signec char -1 当前用户不具有该命令权限
+ */
+signed char shellCheckPermission(Shell *shell, ShellCommand *command)
+{
+    return ((!command->attr.attrs.permission
+                || command->attr.attrs.type == SHELL_TYPE_USER
+                || (shell->info.user
+                    && (command->attr.attrs.permission 
+                        & shell->info.user->attr.attrs.permission)))
+            && (shell->status.isChecked
+                || command->attr.attrs.enableUnchecked))
+            ? 0 : -1;
+}
+
+
+/**
+ * @brief int转16进制字符串
+ * 
+ * @param value 数值
+ * @param buffer 缓冲
+ * 
+ * @return signed char 转换后有效数据长度
+ */
+signed char shellToHex(unsigned int value, char *buffer)
+{
+    char byte;
+    unsigned char i = 8;
+    buffer[8] = 0;
+    while (value)
+    {
+        byte = value & 0x0000000F;
+        buffer[--i] = (byte > 9) ? (byte + 87) : (byte + 48);
+        value >>= 4;
+    }
+    return 8 - i;
+}
+
+
+/**
+* @brief int转10进制字符串
+ * 
+ * @param value 数值
+ * @param buffer 缓冲
+ * 
+ * @return signed char 转换后有效数据长度
+ */
+signed char shellToDec(int value, char *buffer)
+{
+    unsigned char i = 11;
+    int v = value;
+    if (value < 0)
+    {
+        v = -value;
+    }
+    buffer[11] = 0;
+    while (v)
+    {
+        buffer[--i] = v % 10 + 48;
+        v /= 10;
+    }
+    if (value < 0)
+    {
+        buffer[--i] = '-';
+    }
+    if (value == 0) {
+        buffer[--i] = '0';
+    }
+    return 11 - i;
+}
+
+
+/**
+ * @brief shell字符串复制
+ * 
+ * @param dest 目标字符串
+ * @param src 源字符串
+ * @return unsigned short 字符串长度
+ */
+static unsigned short shellStringCopy(char *dest, char* src)
+{
+    unsigned short count = 0;
+    while (*(src + count))
+    {
+        *(dest + count) = *(src + count);
+        count++;
+    }
+    *(dest + count) = 0;
+    return count;
+}
+
+
+/**
+ * @brief shell字符串比较
+ * 
+ * @param dest 目标字符串
+ * @param src 源字符串
+ * @return unsigned short 匹配长度
+ */
+static unsigned short shellStringCompare(char* dest, char *src)
+{
+    unsigned short match = 0;
+    unsigned short i = 0;
+
+    while (*(dest +i) && *(src + i))
+    {
+        if (*(dest + i) != *(src +i))
+        {
+            break;
+        }
+        match ++;
+        i++;
+    }
+    return match;
+}
+
+
+/**
+ * @brief shell获取命令名
+ * 
+ * @param command 命令
+ * @return const char* 命令名
+ */
+static const char* shellGetCommandName(ShellCommand *command)
+{
+    static SHELL_THREAD_LOCAL char buffer[9];
+    for (unsigned char i = 0; i < 9; i++)
+    {
+        buffer[i] = '0';
+    }
+    if (command->attr.attrs.type <= SHELL_TYPE_CMD_YIELD)
+    {
+        return command->data.cmd.name;
+    }
+    else if (command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    {
+        return command->data.var.name;
+    }
+    else if (command->attr.attrs.type <= SHELL_TYPE_USER)
+    {
+        return command->data.user.name;
+    }
+#if SHELL_USING_FUNC_SIGNATURE == 1
+    else if (command->attr.attrs.type == SHELL_TYPE_PARAM_PARSER)
+    {
+        return command->data.paramParser.type;
+    }
+#endif
+    else
+    {
+        shellToHex(command->data.key.value, buffer);
+        return buffer;
+    }
+}
+
+
+/**
+ * @brief shell获取命令描述
+ * 
+ * @param command 命令
+ * @return const char* 命令描述
+ */
+static const char* shellGetCommandDesc(ShellCommand *command)
+{
+    if (command->attr.attrs.type <= SHELL_TYPE_CMD_YIELD)
+    {
+        return command->data.cmd.desc;
+    }
+    else if (command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    {
+        return command->data.var.desc;
+    }
+    else if (command->attr.attrs.type <= SHELL_TYPE_USER)
+    {
+        return command->data.user.desc;
+    }
+    else
+    {
+        return command->data.key.desc;
+    }
+}
+
+/**
+ * @brief shell 列出命令条目
+ * 
+ * @param shell shell对象
+ * @param item 命令条目
+ */
+void shellListItem(Shell *shell, ShellCommand *item)
+{
+    short spaceLength;
+    unsigned short column;
+
+    column = shellWriteString(shell, shellGetCommandName(item));
+    spaceLength = 22 - column;
+    spaceLength = (spaceLength > 0) ? spaceLength : 4;
+    column += spaceLength;
+    do {
+        shellWriteByte(shell, ' ');
+    } while (--spaceLength);
+    if (item->attr.attrs.type <= SHELL_TYPE_CMD_YIELD)
+    {
+        column += shellWriteString(shell, shellText[SHELL_TEXT_TYPE_CMD]);
+    }
+    else if (item->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    {
+        column += shellWriteString(shell, shellText[SHELL_TEXT_TYPE_VAR]);
+    }
+    else if (item->attr.attrs.type <= SHELL_TYPE_USER)
+    {
+        column += shellWriteString(shell, shellText[SHELL_TEXT_TYPE_USER]);
+    }
+    else if (item->attr.attrs.type <= SHELL_TYPE_KEY)
+    {
+        column += shellWriteString(shell, shellText[SHELL_TEXT_TYPE_KEY]);
+    }
+    else
+    {
+        column += shellWriteString(shell, shellText[SHELL_TEXT_TYPE_NONE]);
+    }
+#if SHELL_HELP_SHOW_PERMISSION == 1
+    column += shellWriteString(shell, "  ") + 8;
+    for (signed char i = 7; i >= 0; i--)
+    {
+        shellWriteByte(shell, item->attr.attrs.permission & (1 << i) ? 'x' : '-');
+    }
+#endif
+    column += shellWriteString(shell, "  ");
+    shellWriteCommandDesc(shell, shellGetCommandDesc(item), column);
+    shellWriteString(shell, "\r\n");
+}
+
+
+/**
+ * @brief shell列出可执行命令
+ * 
+ * @param shell shell对象
+ */
+void shellListCommand(Shell *shell)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+    shellWriteString(shell, shellText[SHELL_TEXT_CMD_LIST]);
+    for (short i = 0; i < shell->commandList.count; i++)
+    {
+        if (base[i].attr.attrs.type <= SHELL_TYPE_CMD_YIELD
+            && shellCheckPermission(shell, &base[i]) == 0)
+        {
+            shellListItem(shell, &base[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief shell列出变量
+ * 
+ * @param shell shell对象
+ */
+void shellListVar(Shell *shell)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+    shellWriteString(shell, shellText[SHELL_TEXT_VAR_LIST]);
+    for (short i = 0; i < shell->commandList.count; i++)
+    {
+        if (base[i].attr.attrs.type > SHELL_TYPE_CMD_YIELD
+            && base[i].attr.attrs.type <= SHELL_TYPE_VAR_NODE
+            && shellCheckPermission(shell, &base[i]) == 0)
+        {
+            shellListItem(shell, &base[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief shell列出用户
+ * 
+ * @param shell shell对象
+ */
+void shellListUser(Shell *shell)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+    shellWriteString(shell, shellText[SHELL_TEXT_USER_LIST]);
+    for (short i = 0; i < shell->commandList.count; i++)
+    {
+        if (base[i].attr.attrs.type > SHELL_TYPE_VAR_NODE
+            && base[i].attr.attrs.type <= SHELL_TYPE_USER
+            && shellCheckPermission(shell, &base[i]) == 0)
+        {
+            shellListItem(shell, &base[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief shell列出按键
+ * 
+ * @param shell shell对象
+ */
+void shellListKey(Shell *shell)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+    shellWriteString(shell, shellText[SHELL_TEXT_KEY_LIST]);
+    for (short i = 0; i < shell->commandList.count; i++)
+    {
+        if (base[i].attr.attrs.type > SHELL_TYPE_USER
+            && base[i].attr.attrs.type <= SHELL_TYPE_KEY
+            && shellCheckPermission(shell, &base[i]) == 0)
+        {
+            shellListItem(shell, &base[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief shell列出所有命令
+ * 
+ * @param shell shell对象
+ */
+void shellListAll(Shell *shell)
+{
+#if SHELL_HELP_LIST_USER == 1
     shellListUser(shell);
 #endif
-    shellListCommand(shell);
-#if SHELL_HELP_LIST_VAR == 1
-    shellListVar(shell);
+    shellListCommand(shell);
+#if SHELL_HELP_LIST_VAR == 1
+    shellListVar(shell);
+#endif
+#if SHELL_HELP_LIST_KEY == 1
+    shellListKey(shell);
+#endif
+}
+
+
+/**
+ * @brief shell删除命令行数据
+ * 
+ * @param shell shell对象
+ * @param length 删除长度
+ */
+void shellDeleteCommandLine(Shell *shell, unsigned char length)
+{
+    while (length--)
+    {
+        shellWriteString(shell, "\b \b");
+    }
+}
+
+
+/**
+ * @brief shell 清空命令行输入
+ * 
+ * @param shell shell对象
+ */
+void shellClearCommandLine(Shell *shell)
+{
+    for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+    {
+        shellWriteByte(shell, ' ');
+    }
+    shellDeleteCommandLine(shell, shell->parser.length);
+}
+
+
+/**
+ * @brief shell插入一个字符到光标位置
+ * 
+ * @param shell shell对象
+ * @param data 字符数据
+ */
+void shellInsertByte(Shell *shell, char data)
+{
+    /* 判断输入数据是否过长 */
+    if (shell->parser.length >= shell->parser.bufferSize - 1)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_CMD_TOO_LONG]);
+        shellWritePrompt(shell, 1);
+        shellWriteString(shell, shell->parser.buffer);
+        return;
+    }
+
+    /* 插入数据 */
+    if (shell->parser.cursor == shell->parser.length)
+    {
+        shell->parser.buffer[shell->parser.length++] = data;
+        shell->parser.buffer[shell->parser.length] = 0;
+        shell->parser.cursor++;
+        shellWriteByte(shell, shell->status.isChecked ? data : '*');
+    }
+    else if (shell->parser.cursor < shell->parser.length)
+    {
+        for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+        {
+            shell->parser.buffer[shell->parser.cursor + i] = 
+                shell->parser.buffer[shell->parser.cursor + i - 1];
+        }
+        shell->parser.buffer[shell->parser.cursor++] = data;
+        shell->parser.buffer[++shell->parser.length] = 0;
+        for (short i = shell->parser.cursor - 1; i < shell->parser.length; i++)
+        {
+            shellWriteByte(shell, 
+                           shell->status.isChecked ? shell->parser.buffer[i] : '*');
+        }
+        for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+        {
+            shellWriteByte(shell, '\b');
+        }
+    }
+}
+
+
+/**
+ * @brief shell 删除字节
+ * 
+ * @param shell shell对象
+ * @param direction 删除方向 {@code 1}删除光标前字符 {@code -1}删除光标处字符
+ */
+void shellDeleteByte(Shell *shell, signed char direction)
+{
+    char offset = (direction == -1) ? 1 : 0;
+
+    if ((shell->parser.cursor == 0 && direction == 1)
+        || (shell->parser.cursor == shell->parser.length && direction == -1))
+    {
+        return;
+    }
+    if (shell->parser.cursor == shell->parser.length && direction == 1)
+    {
+        shell->parser.cursor--;
+        shell->parser.length--;
+        shell->parser.buffer[shell->parser.length] = 0;
+        shellDeleteCommandLine(shell, 1);
+    }
+    else
+    {
+        for (short i = offset; i < shell->parser.length - shell->parser.cursor; i++)
+        {
+            shell->parser.buffer[shell->parser.cursor + i - 1] = 
+                shell->parser.buffer[shell->parser.cursor + i];
+        }
+        shell->parser.length--;
+        if (!offset)
+        {
+            shell->parser.cursor--;
+            shellWriteByte(shell, '\b');
+        }
+        shell->parser.buffer[shell->parser.length] = 0;
+        for (short i = shell->parser.cursor; i < shell->parser.length; i++)
+        {
+            shellWriteByte(shell, shell->parser.buffer[i]);
+        }
+        shellWriteByte(shell, ' ');
+        for (short i = shell->parser.length - shell->parser.cursor + 1; i > 0; i--)
+        {
+            shellWriteByte(shell, '\b');
+        }
+    }
+}
+
+
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+/**
+ * @brief shell 查找变量引用
+ *        `${name}`引用的变量存在时，返回变量值的字符串
+ * 
+ * @param shell shell对象
+ * @param string 从`${`开始的字符串
+ * @param length 字符串长度
+ * @param text 变量值字符串
+ * @param textLength 变量值字符串长度
+ * @param value 整型变量转换为字符串使用的缓冲，至少12字节
+ * 
+ * @return unsigned short 变量引用的长度，包括`${`和`}`，变量不存在时返回0
+ */
+static unsigned short shellFindVarRef(Shell *shell, char *string, unsigned short length,
+                                      const char **text, unsigned short *textLength, char *value)
+{
+    unsigned short end = 2;
+    ShellCommand *command;
+
+    while (end < length && string[end] != '}' && string[end] != ' ')
+    {
+        end++;
+    }
+    if (end >= length || string[end] != '}')
+    {
+        return 0;
+    }
+    string[end] = 0;
+    command = shellSeekVar(shell, string + 2);
+    string[end] = '}';
+    if (command == NULL || command->attr.attrs.type < SHELL_TYPE_VAR_INT
+        || command->attr.attrs.type > SHELL_TYPE_VAR_NODE)
+    {
+        return 0;
+    }
+    if (command->attr.attrs.type == SHELL_TYPE_VAR_STRING)
+    {
+        *text = command->data.var.value;
+        *textLength = strlen(*text);
+    }
+    else
+    {
+        *textLength = shellToDec(shellGetVarValue(shell, command), value);
+        *text = &value[11 - *textLength];
+    }
+    return end + 1;
+}
+#endif /** SHELL_SUPPORT_VAR_EXPAND == 1 */
+
+
+/**
+ * @brief shell 扫描一个参数
+ *        一次遍历完成参数分割，去除引号以及转义字符处理，括号内的内容保持原样，由后续的数组解析再次分割，
+ *        `shell`不为NULL时，同时把没有转义的`${name}`替换为变量的值，
+ *        以`\$`或者没有替换的`${`开头的参数标记为`literal`，不再作为`$name`变量引用解析，
+ *        结果写入`output`，不超过`size`的部分被写入，`output`为NULL时只计算结果的长度，
+ *        不替换变量时结果不会比原字符串长，`output`可以指向参数在原字符串中的起始位置
+ * 
+ * @param shell shell对象，为NULL时不替换变量
+ * @param string 字符串
+ * @param strLen 字符串长度
+ * @param output 结果缓冲
+ * @param size 结果缓冲大小
+ * @param token 分割得到的参数标记，`start`为参数在原字符串中的起始位置，`length`为结果的长度，
+ *              没有参数时`start`为NULL
+ * @param splitKey 分隔符，除分隔符外，空格同样会分割参数，为0时不分割
+ * 
+ * @return unsigned short 处理的字符数量，下一个参数从此位置开始分割
+ */
+static unsigned short shellTokenScan(Shell *shell, char *string, unsigned short strLen,
+                                     char *output, unsigned short size,
+                                     ShellToken *token, char splitKey)
+{
+    unsigned short depth = 0;
+    unsigned short paren = 0;
+    unsigned short index = 0;
+    unsigned short i = 0;
+    unsigned char quoted = 0;
+
+#if SHELL_SUPPORT_VAR_EXPAND != 1
+    (void) shell;
+#endif
+    token->start = NULL;
+    token->length = 0;
+    token->quoted = 0;
+    token->escaped = 0;
+    token->variable = 0;
+    token->literal = 0;
+
+    while (splitKey && i < strLen && (string[i] == splitKey || string[i] == ' '))
+    {
+        i++;
+    }
+    if (i >= strLen)
+    {
+        return strLen;
+    }
+
+    token->start = &string[i];
+    for (; i < strLen; i++)
+    {
+        char data = string[i];
+        if (splitKey && !quoted && depth == 0 && paren == 0 && (data == splitKey || data == ' '))
+        {
+            i++;
+            break;
+        }
+
+        if (data == '\\' && i + 1 < strLen)
+        {
+            if (depth == 0 && paren == 0)
+            {
+                data = shellExtEscapeChar(string[++i]);
+                token->escaped = 1;
+            #if SHELL_SUPPORT_VAR_EXPAND == 1
+                if (index == 0 && data == '$')
+                {
+                    token->literal = 1;
+                }
+            #endif /** SHELL_SUPPORT_VAR_EXPAND == 1 */
+            }
+            else
+            {
+                if (output && index < size)
+                {
+                    output[index] = data;
+                }
+                index++;
+                data = string[++i];
+            }
+            if (output && index < size)
+            {
+                output[index] = data;
+            }
+            index++;
+            continue;
+        }
+
+        if (data == '$' && i + 1 < strLen && string[i + 1] == '{')
+        {
+            token->variable = 1;
+        #if SHELL_SUPPORT_VAR_EXPAND == 1
+            const char *text;
+            unsigned short textLength;
+            unsigned short used;
+            char value[12];
+            if (shell && (used = shellFindVarRef(shell, string + i, strLen - i,
+                                                 &text, &textLength, value)) > 0)
+            {
+                if (output && index < size)
+                {
+                    memcpy(output + index, text,
+                           textLength < size - index ? textLength : size - index);
+                }
+                index += textLength;
+                i += used - 1;
+                continue;
+            }
+            if (index == 0 && depth == 0 && paren == 0)
+            {
+                token->literal = 1;
+            }
+        #endif /** SHELL_SUPPORT_VAR_EXPAND == 1 */
+        }
+        else if (data == '\"')
+        {
+            quoted = !quoted;
+            if (depth == 0 && paren == 0)
+            {
+                token->quoted = 1;
+                continue;
+            }
+        }
+        else if (!quoted)
+        {
+        #if SHELL_SUPPORT_EXPRESSION == 1
+            /* 写回原字符串时，结果不会超过当前位置，`string[i - 1]`仍然是原字符 */
+            if (data == '(' && shellIsExprParen(&string[i] > token->start ? string[i - 1] : 0))
+            {
+                paren++;
+            }
+            else if (data == ')' && paren > 0)
+            {
+                paren--;
+            }
+        #endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+            for (unsigned char j = 0; j < sizeof(pairedChars) / 2; j++)
+            {
+                if (data == pairedChars[j][0])
+                {
+                    depth++;
+                    break;
+                }
+                else if (data == pairedChars[j][1] && depth > 0)
+                {
+                    depth--;
+                    break;
+                }
+            }
+        }
+        if (output && index < size)
+        {
+            output[index] = data;
+        }
+        index++;
+    }
+    token->length = index;
+    return i;
+}
+
+
+/**
+ * @brief shell 分割一个参数
+ *        一次遍历完成参数分割，去除引号以及转义字符处理，处理结果直接写回原字符串，
+ *        括号内的内容保持原样，由后续的数组解析再次分割
+ * 
+ * @param string 字符串
+ * @param strLen 字符串长度
+ * @param token 分割得到的参数标记，没有参数时`start`为NULL
+ * @param splitKey 分隔符，除分隔符外，空格同样会分割参数，为0时不分割
+ * 
+ * @return unsigned short 处理的字符数量，下一个参数从此位置开始分割
+ */
+unsigned short shellTokenizeNext(char *string, unsigned short strLen, ShellToken *token, char splitKey)
+{
+    unsigned short start = 0;
+    unsigned short i;
+
+    while (splitKey && start < strLen && (string[start] == splitKey || string[start] == ' '))
+    {
+        start++;
+    }
+    i = shellTokenScan(NULL, string, strLen, string + start, strLen - start, token, splitKey);
+    if (token->start && token->start + token->length < string + i)
+    {
+        token->start[token->length] = 0;
+    }
+    return i;
+}
+
+
+/**
+ * @brief shell 字符串分割
+ * 
+ * @param string 字符串
+ * @param strLen 字符串长度
+ * @param tokens 分割后保存的参数标记
+ * @param maxNum 最大分割数量
+ * @param splitKey 分隔符，除分隔符外，空格同样会分割参数，为0时不分割
+ * 
+ * @return int 分割得到的字串数量
+ */
+int shellTokenize(char *string, unsigned short strLen, ShellToken *tokens, short maxNum, char splitKey)
+{
+    unsigned short offset = 0;
+    int count = 0;
+
+    for (short i = 0; i < maxNum; i++)
+    {
+        tokens[i].start = NULL;
+    }
+
+    while (offset < strLen && count < maxNum)
+    {
+        offset += shellTokenizeNext(string + offset, strLen - offset, &tokens[count], splitKey);
+        if (tokens[count].start == NULL)
+        {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+/**
+ * @brief shell 分割一个参数并替换其中的变量引用
+ *        参数包含`${name}`时，替换后的参数存放在参数内存池中，内存池空间不足时按照不替换变量处理，
+ *        转义的`\${name}`不会被替换
+ * 
+ * @param shell shell对象
+ * @param string 字符串
+ * @param strLen 字符串长度
+ * @param token 分割得到的参数标记
+ * 
+ * @return unsigned short 处理的字符数量
+ */
+static unsigned short shellTokenizeExpand(Shell *shell, char *string, unsigned short strLen,
+                                          ShellToken *token)
+{
+    unsigned short i = shellTokenScan(shell, string, strLen, NULL, 0, token, ' ');
+    unsigned short length = token->length;
+    char *buffer;
+
+    if (!token->variable || (buffer = shellArenaAlloc(shell, length + 1)) == NULL)
+    {
+        return shellTokenizeNext(string, strLen, token, ' ');
+    }
+    /* 两次查找之间变量的值可能改变，结果按照第一次计算的长度截断 */
+    shellTokenScan(shell, string, strLen, buffer, length, token, ' ');
+    if (token->length > length)
+    {
+        token->length = length;
+    }
+    buffer[token->length] = 0;
+    token->start = buffer;
+    return i;
+}
+#endif /** SHELL_SUPPORT_VAR_EXPAND == 1 */
+
+
+/**
+ * @brief shell 解析参数
+ *        使能变量替换时，参数在分割的同时完成`${name}`替换
+ * 
+ * @param shell shell对象
+ * @param string 命令字符串
+ * @param length 命令字符串长度
+ */
+static void shellParserParam(Shell *shell, char *string, unsigned short length)
+{
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    unsigned short offset = 0;
+    unsigned short count = 0;
+    char *dollar = memchr(string, '$', length);
+
+    for (short i = 0; i < SHELL_PARAMETER_MAX_NUMBER; i++)
+    {
+        shell->parser.token[i].start = NULL;
+    }
+    while (offset < length && count < SHELL_PARAMETER_MAX_NUMBER)
+    {
+        ShellToken *token = &shell->parser.token[count];
+        if (dollar && dollar < string + offset)
+        {
+            dollar = memchr(string + offset, '$', length - offset);
+        }
+        /* 剩余的字符串中没有`$`时，直接原地分割 */
+        offset += dollar ? shellTokenizeExpand(shell, string + offset, length - offset, token)
+                         : shellTokenizeNext(string + offset, length - offset, token, ' ');
+        if (token->start == NULL)
+        {
+            break;
+        }
+        count++;
+    }
+    shell->parser.paramCount = count;
+#else
+    shell->parser.paramCount = 
+        shellTokenize(string, length,
+                      shell->parser.token, SHELL_PARAMETER_MAX_NUMBER, ' ');
+#endif /** SHELL_SUPPORT_VAR_EXPAND == 1 */
+    for (short i = 0; i < SHELL_PARAMETER_MAX_NUMBER; i++)
+    {
+        shell->parser.param[i] = shell->parser.token[i].start;
+    }
+}
+
+
+/**
+ * @brief shell匹配命令
+ * 
+ * @param shell shell对象
+ * @param cmd 命令
+ * @param base 匹配命令表基址
+ * @param compareLength 匹配字符串长度
+ * @return ShellCommand* 匹配到的命令
+ */
+ShellCommand* shellSeekCommand(Shell *shell,
+                               const char *cmd,
+                               ShellCommand *base,
+                               unsigned short compareLength)
+{
+    const char *name;
+    unsigned short count = shell->commandList.count -
+        ((size_t)base - (size_t)shell->commandList.base) / sizeof(ShellCommand);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        if (base[i].attr.attrs.type == SHELL_TYPE_KEY
+            || shellCheckPermission(shell, &base[i]) != 0)
+        {
+            continue;
+        }
+        name = shellGetCommandName(&base[i]);
+        if (!compareLength)
+        {
+            if (strcmp(cmd, name) == 0)
+            {
+                return &base[i];
+            }
+        }
+        else
+        {
+            if (strncmp(cmd, name, compareLength) == 0)
+            {
+                return &base[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief shell 查找变量
+ *        配置了变量查找缓存时，优先从缓存中查找，命令表或者当前用户改变时缓存失效
+ * 
+ * @param shell shell对象
+ * @param name 变量名
+ * @return ShellCommand* 查找到的命令
+ */
+ShellCommand* shellSeekVar(Shell *shell, const char *name)
+{
+    ShellCommand *command;
+#if SHELL_VAR_CACHE_SIZE > 0
+    if (shell->varCache.base != shell->commandList.base
+        || shell->varCache.count != shell->commandList.count
+        || shell->varCache.user != shell->info.user)
+    {
+        memset(shell->varCache.item, 0, sizeof(shell->varCache.item));
+        shell->varCache.base = shell->commandList.base;
+        shell->varCache.count = shell->commandList.count;
+        shell->varCache.user = shell->info.user;
+        shell->varCache.next = 0;
+    }
+    for (unsigned short i = 0; i < SHELL_VAR_CACHE_SIZE; i++)
+    {
+        command = (ShellCommand *) shell->varCache.item[i];
+        if (command && strcmp(name, shellGetCommandName(command)) == 0)
+        {
+            return command;
+        }
+    }
+#endif /** SHELL_VAR_CACHE_SIZE > 0 */
+    command = shellSeekCommand(shell, name, shell->commandList.base, 0);
+#if SHELL_VAR_CACHE_SIZE > 0
+    if (command)
+    {
+        shell->varCache.item[shell->varCache.next] = command;
+        shell->varCache.next = (shell->varCache.next + 1) % SHELL_VAR_CACHE_SIZE;
+    }
+#endif /** SHELL_VAR_CACHE_SIZE > 0 */
+    return command;
+}
+
+
+/**
+ * @brief shell 获取变量值
+ * 
+ * @param shell shell对象
+ * @param command 命令
+ * @return int 变量值
+ */
+int shellGetVarValue(Shell *shell, ShellCommand *command)
+{
+    int value = 0;
+    switch (command->attr.attrs.type)
+    {
+    case SHELL_TYPE_VAR_INT:
+        value = *((int *)(command->data.var.value));
+        break;
+    case SHELL_TYPE_VAR_SHORT:
+        value = *((short *)(command->data.var.value));
+        break;
+    case SHELL_TYPE_VAR_CHAR:
+        value = *((char *)(command->data.var.value));
+        break;
+    case SHELL_TYPE_VAR_STRING:
+    case SHELL_TYPE_VAR_POINT:
+        value = (size_t)(command->data.var.value);
+        break;
+    case SHELL_TYPE_VAR_NODE: {
+        int (*func)(void *) = ((ShellNodeVarAttr *)command->data.var.value)->get;
+        value = func ? func(((ShellNodeVarAttr *)command->data.var.value)->var) : 0;
+        break;
+    }
+    default:
+        break;
+    }
+    return value;
+}
+
+
+/**
+ * @brief shell设置变量值
+ * 
+ * @param shell shell对象
+ * @param command 命令
+ * @param value 值
+ * @return int 返回变量值
+ */
+int shellSetVarValue(Shell *shell, ShellCommand *command, int value)
+{
+    if (command->attr.attrs.readOnly)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_VAR_READ_ONLY_CANNOT_MODIFY]);
+    }
+    else
+    {
+        switch (command->attr.attrs.type)
+        {
+        case SHELL_TYPE_VAR_INT:
+            *((int *)(command->data.var.value)) = value;
+            break;
+        case SHELL_TYPE_VAR_SHORT:
+            *((short *)(command->data.var.value)) = value;
+            break;
+        case SHELL_TYPE_VAR_CHAR:
+            *((char *)(command->data.var.value)) = value;
+            break;
+        case SHELL_TYPE_VAR_STRING:
+            shellStringCopy(((char *)(command->data.var.value)), (char *) (size_t) value);
+            break;
+        case SHELL_TYPE_VAR_POINT:
+            shellWriteString(shell, shellText[SHELL_TEXT_POINT_CANNOT_MODIFY]);
+            break;
+        case SHELL_TYPE_VAR_NODE:
+            if (((ShellNodeVarAttr *)command->data.var.value)->set)
+            {
+                if (((ShellNodeVarAttr *)command->data.var.value)->var)
+                {
+                    int (*func)(void *, int) = ((ShellNodeVarAttr *)command->data.var.value)->set;
+                    func(((ShellNodeVarAttr *)command->data.var.value)->var, value);
+                }
+                else
+                {
+                    int (*func)(int) = ((ShellNodeVarAttr *)command->data.var.value)->set;
+                    func(value);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return shellShowVar(shell, command);
+}
+
+
+/**
+ * @brief shell变量输出
+ * 
+ * @param shell shell对象
+ * @param command 命令
+ * @return int 返回变量值
+ */
+static int shellShowVar(Shell *shell, ShellCommand *command)
+{
+    char buffer[12] = "00000000000";
+    int value = shellGetVarValue(shell, command);
+    
+    shellWriteString(shell, command->data.var.name);
+    shellWriteString(shell, " = ");
+
+    switch (command->attr.attrs.type)
+    {
+    case SHELL_TYPE_VAR_STRING:
+        shellWriteString(shell, "\"");
+        shellWriteString(shell, (char *) (size_t) value);
+        shellWriteString(shell, "\"");
+        break;
+    // case SHELL_TYPE_VAR_INT:
+    // case SHELL_TYPE_VAR_SHORT:
+    // case SHELL_TYPE_VAR_CHAR:
+    // case SHELL_TYPE_VAR_POINT:
+    default:
+        shellWriteString(shell, &buffer[11 - shellToDec(value, buffer)]);
+        shellWriteString(shell, ", 0x");
+        for (short i = 0; i < 11; i++)
+        {
+            buffer[i] = '0';
+        }
+        shellToHex(value, buffer);
+        shellWriteString(shell, buffer);
+        break;
+    }
+
+    shellWriteString(shell, "\r\n");
+    return value;
+}
+
+
+/**
+ * @brief shell设置变量
+ * 
+ * @param name 变量名
+ * @param value 变量值
+ * @return int 返回变量值
+ */
+int shellSetVar(char *name, int value)
+{
+    Shell *shell = shellGetCurrent();
+    if (shell == NULL)
+    {
+        return 0;
+    }
+    ShellCommand *command = shellSeekCommand(shell,
+                                             name,
+                                             shell->commandList.base,
+                                             0);
+    if (!command)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_VAR_NOT_FOUND]);
+        return 0;
+    }
+    if (command->attr.attrs.type < SHELL_TYPE_VAR_INT
+        || command->attr.attrs.type > SHELL_TYPE_VAR_NODE)
+    {
+        shellWriteString(shell, name);
+        shellWriteString(shell, shellText[SHELL_TEXT_NOT_VAR]);
+        return 0;
+    }
+    return shellSetVarValue(shell, command, value);
+}
+SHELL_EXPORT_CMD(
+SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+setVar, shellSetVar, set var);
+
+
+#if SHELL_SUPPORT_YIELD == 1
+/**
+ * @brief shell 计算挂起的命令下次恢复执行前的等待时间
+ *        `SHELL_YIELD_DELAY`挂起时为剩余的延时时间，其他挂起方式为1个tick
+ * 
+ * @param yield 挂起的命令上下文
+ * 
+ * @return unsigned int 等待时间
+ */
+static unsigned int shellYieldWaitTime(ShellYield *yield)
+{
+    unsigned int elapsed = SHELL_GET_TICK() - yield->tick;
+    return yield->delay == 0 ? 1 : (elapsed >= yield->delay ? 0 : yield->delay - elapsed);
+}
+
+
+/**
+ * @brief shell 开始执行可挂起命令
+ *        命令挂起时，如果允许挂起，记录挂起的命令后返回，由`shellPoll`恢复执行，
+ *        否则(多语句中间，管道，重定向，执行队列，机器模式)在此处等待后恢复执行直到命令结束，
+ *        等待期间释放输入处理持有的shell锁，命令被取消时不再恢复执行
+ * 
+ * @param shell shell对象
+ * @param command 命令
+ * 
+ * @return int 命令返回值，命令挂起时返回0
+ */
+static int shellYieldStart(Shell *shell, ShellCommand *command)
+{
+    ShellYieldState (*func)(ShellYield *, int, char **) =
+        (ShellYieldState (*)(ShellYield *, int, char **))command->data.cmd.function;
+    ShellYield *yield = &shell->yield.context;
+
+    memset(yield, 0, sizeof(ShellYield));
+    while (func(yield, shell->parser.paramCount, shell->parser.param) == SHELL_YIELD_RUNNING)
+    {
+    #if SHELL_USING_LOCK == 1
+        unsigned char locked;
+    #endif
+        if (shell->yield.suspend)
+        {
+            shell->yield.command = command;
+            return 0;
+        }
+    #if SHELL_SUPPORT_CANCEL == 1
+        shellCancelDrain(shell);
+        if (shellCheckCancel(shell))
+        {
+            yield->retVal = -1;
+            break;
+        }
+    #endif
+    #if SHELL_USING_LOCK == 1
+        locked = shellLockRelease(shell);
+    #endif
+        shellWaitInput(shell, shellYieldWaitTime(yield));
+    #if SHELL_USING_LOCK == 1
+        shellLockRestore(shell, locked);
+    #endif
+    }
+    if (!command->attr.attrs.disableReturn)
+    {
+        shellWriteReturnValue(shell, yield->retVal);
+    }
+    return yield->retVal;
+}
+#endif /** SHELL_SUPPORT_YIELD == 1 */
+
+
+/**
+ * @brief shell运行命令
+ * 
+ * @param shell shell对象
+ * @param command 命令
+ * 
+ * @return unsigned int 命令返回值
+ */
+unsigned int shellRunCommand(Shell *shell, ShellCommand *command)
+{
+    int returnValue = 0;
+    Shell *current = SHELL_GET_CURRENT();
+    shell->status.isActive = 1;
+    SHELL_SET_CURRENT(shell);
+    if (command->attr.attrs.type == SHELL_TYPE_CMD_MAIN)
+    {
+        int (*func)(int, char **) = command->data.cmd.function;
+        returnValue = func(shell->parser.paramCount, shell->parser.param);
+        if (!command->attr.attrs.disableReturn)
+        {
+            shellWriteReturnValue(shell, returnValue);
+        }
+    }
+    else if (command->attr.attrs.type == SHELL_TYPE_CMD_FUNC)
+    {
+        returnValue = shellExtRun(shell,
+                                  command,
+                                  shell->parser.paramCount,
+                                  shell->parser.param);
+        if (!command->attr.attrs.disableReturn)
+        {
+            shellWriteReturnValue(shell, returnValue);
+        }
+    }
+#if SHELL_SUPPORT_YIELD == 1
+    else if (command->attr.attrs.type == SHELL_TYPE_CMD_YIELD)
+    {
+        returnValue = shellYieldStart(shell, command);
+    }
+#endif
+    else if (command->attr.attrs.type >= SHELL_TYPE_VAR_INT
+        && command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    {
+        shellShowVar(shell, command);
+    }
+    else if (command->attr.attrs.type == SHELL_TYPE_USER)
+    {
+        shellSetUser(shell, command);
+    }
+    SHELL_SET_CURRENT(current);
+    shell->status.isActive = 0;
+
+    return returnValue;
+}
+
+
+/**
+ * @brief shell校验密码
+ * 
+ * @param shell shell对象
+ */
+static void shellCheckPassword(Shell *shell)
+{
+    if (strcmp(shell->parser.buffer, shell->info.user->data.user.password) == 0)
+    {
+        shell->status.isChecked = 1;
+    #if SHELL_PROMPT_BUFFER > 0
+        shell->prompt.length = 0;
+    #endif
+    #if SHELL_SHOW_INFO == 1
+        shellWriteString(shell, shellText[SHELL_TEXT_INFO]);
+    #endif
+    }
+    else
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_PASSWORD_ERROR]);
+    }
+    shell->parser.length = 0;
+    shell->parser.cursor = 0;
+}
+
+
+/**
+ * @brief shell设置用户
+ * 
+ * @param shell shell对象
+ * @param user 用户
+ */
+void shellSetUser(Shell *shell, const ShellCommand *user)
+{
+    shell->info.user = user;
+#if SHELL_PROMPT_BUFFER > 0
+    shell->prompt.length = 0;
+#endif
+    shell->status.isChecked = 
+        ((user->data.user.password && strlen(user->data.user.password) != 0)
+            && (shell->parser.paramCount < 2
+                || strcmp(user->data.user.password, shell->parser.param[1]) != 0))
+         ? 0 : 1;
+        
+#if SHELL_CLS_WHEN_LOGIN == 1
+    shellWriteString(shell, shellText[SHELL_TEXT_CLEAR_CONSOLE]);
+#endif
+#if SHELL_SHOW_INFO == 1
+    if (shell->status.isChecked)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_INFO]);
+    }
+#endif
+}
+
+
+/**
+ * @brief shell写返回值
+ * 
+ * @param shell shell对象
+ * @param value 返回值
+ */
+static void shellWriteReturnValue(Shell *shell, int value)
+{
+    char buffer[12] = "00000000000";
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    if (shell->status.isMachine)
+    {
+    #if SHELL_KEEP_RETURN_VALUE == 1
+        shell->info.retVal = value;
+    #endif
+        return;
+    }
+#endif
+#if SHELL_PIPE_BUFFER > 0 || SHELL_REDIRECT_BUFFER > 0
+    if (shell->status.isRedirected)
+    {
+    #if SHELL_KEEP_RETURN_VALUE == 1
+        shell->info.retVal = value;
+    #endif
+        return;
+    }
+#endif
+    shellWriteString(shell, "Return: ");
+    shellWriteString(shell, &buffer[11 - shellToDec(value, buffer)]);
+    shellWriteString(shell, ", 0x");
+    for (short i = 0; i < 11; i++)
+    {
+        buffer[i] = '0';
+    }
+    shellToHex(value, buffer);
+    shellWriteString(shell, buffer);
+    shellWriteString(shell, "\r\n");
+#if SHELL_KEEP_RETURN_VALUE == 1
+    shell->info.retVal = value;
+#endif
+}
+
+
+#if SHELL_HISTORY_MAX_NUMBER > 0
+/**
+ * @brief shell历史记录添加
+ * 
+ * @param shell shell对象
+ */
+static void shellHistoryAdd(Shell *shell)
+{
+    shell->history.offset = 0;
+    if (shell->history.number > 0
+        && strcmp(shell->history.item[(shell->history.record == 0 ? 
+                SHELL_HISTORY_MAX_NUMBER : shell->history.record) - 1],
+                shell->parser.buffer) == 0)
+    {
+        return;
+    }
+    if (shellStringCopy(shell->history.item[shell->history.record],
+                        shell->parser.buffer) != 0)
+    {
+        shell->history.record++;
+    }
+    if (++shell->history.number > SHELL_HISTORY_MAX_NUMBER)
+    {
+        shell->history.number = SHELL_HISTORY_MAX_NUMBER;
+    }
+    if (shell->history.record >= SHELL_HISTORY_MAX_NUMBER)
+    {
+        shell->history.record = 0;
+    }
+}
+
+
+/**
+ * @brief shell历史记录查找
+ * 
+ * @param shell shell对象
+ * @param dir 方向 {@code <0}往上查找 {@code >0}往下查找
+ */
+static void shellHistory(Shell *shell, signed char dir)
+{
+    if (dir > 0)
+    {
+        if (shell->history.offset-- <= 
+            -((shell->history.number > shell->history.record) ?
+                shell->history.number : shell->history.record))
+        {
+            shell->history.offset = -((shell->history.number > shell->history.record)
+                                    ? shell->history.number : shell->history.record);
+        }
+    }
+    else if (dir < 0)
+    {
+        if (++shell->history.offset > 0)
+        {
+            shell->history.offset = 0;
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+    shellClearCommandLine(shell);
+    if (shell->history.offset == 0)
+    {
+        shell->parser.cursor = shell->parser.length = 0;
+    }
+    else
+    {
+        if ((shell->parser.length = shellStringCopy(shell->parser.buffer,
+                shell->history.item[(shell->history.record + SHELL_HISTORY_MAX_NUMBER
+                    + shell->history.offset) % SHELL_HISTORY_MAX_NUMBER])) == 0)
+        {
+            return;
+        }
+        shell->parser.cursor = shell->parser.length;
+        shellWriteString(shell, shell->parser.buffer);
+    }
+    
+}
+#endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+
+
+/**
+ * @brief shell 常规输入
+ * 
+ * @param shell shell 对象
+ * @param data 输入字符
+ */
+void shellNormalInput(Shell *shell, char data)
+{
+    shell->status.tabFlag = 0;
+    shellInsertByte(shell, data);
+}
+
+
+/**
+ * @brief shell 执行单条命令
+ *        命令执行期间，可以临时替换shell的读写函数，命令执行完成后恢复
+ * 
+ * @param shell shell对象
+ * @param string 命令字符串
+ * @param length 命令字符串长度
+ * @param read 命令执行期间使用的读函数，为NULL时不替换(使能取消时替换为过滤取消按键的读函数)
+ * @param write 命令执行期间使用的写函数，为NULL时不替换
+ * 
+ * @return int 命令返回值，命令未找到时返回-1
+ */
+static int shellExecCommand(Shell *shell, char *string, unsigned short length,
+                            signed short (*read)(char *, unsigned short),
+                            signed short (*write)(char *, unsigned short))
+{
+    signed short (*shellRead)(char *, unsigned short) = shell->read;
+    signed short (*shellWrite)(char *, unsigned short) = shell->write;
+    int ret;
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    unsigned short arenaTop = shell->arena.top;
+#endif
+
+    shellParserParam(shell, string, length);
+    if (shell->parser.paramCount == 0)
+    {
+        return 0;
+    }
+
+    ShellCommand *command = shellSeekCommand(shell,
+                                             shell->parser.param[0],
+                                             shell->commandList.base,
+                                             0);
+    if (command == NULL)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_CMD_NOT_FOUND]);
+    #if SHELL_SUPPORT_VAR_EXPAND == 1
+        shell->arena.top = arenaTop;
+    #endif
+        return -1;
+    }
+
+    if (read)
+    {
+        shell->read = read;
+    }
+#if SHELL_SUPPORT_CANCEL == 1
+    else if (shell->read != shellCancelRead)
+    {
+        shell->cancel.read = shell->read;
+        shell->read = shellCancelRead;
+    }
+#endif
+    if (write)
+    {
+        shell->write = write;
+    #if SHELL_PIPE_BUFFER > 0 || SHELL_REDIRECT_BUFFER > 0
+        shell->status.isRedirected = 1;
+    #endif
+    }
+    ret = shellRunCommand(shell, command);
+    shell->read = shellRead;
+    shell->write = shellWrite;
+#if SHELL_PIPE_BUFFER > 0 || SHELL_REDIRECT_BUFFER > 0
+    shell->status.isRedirected = 0;
+#endif
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    shell->arena.top = arenaTop;
 #endif
-#if SHELL_HELP_LIST_KEY == 1
-    shellListKey(shell);
+    return ret;
+}
+
+
+#if SHELL_USING_STATEMENT
+/**
+ * @brief shell 语句连接符
+ */
+typedef enum
+{
+    SHELL_STATEMENT_END = 0,                            /**< 行结束 */
+    SHELL_STATEMENT_PIPE,                               /**< 管道 `|` */
+    SHELL_STATEMENT_SEQUENCE,                           /**< 顺序执行 `;` */
+    SHELL_STATEMENT_AND,                                /**< 前一条语句返回0时执行 `&&` */
+    SHELL_STATEMENT_OR,                                 /**< 前一条语句返回非0时执行 `||` */
+    SHELL_STATEMENT_BACKGROUND,                         /**< 后台执行 `&` */
+#if SHELL_SUPPORT_EXPRESSION == 1
+    SHELL_STATEMENT_INVALID,                            /**< `$var`之后紧跟的运算符，如`$a<<2` */
 #endif
+} ShellStatementOp;
+
+
+/**
+ * @brief shell 匹配语句连接符
+ * 
+ * @param string 字符串
+ * @param length 字符串长度
+ * @param op 匹配到的连接符
+ * 
+ * @return unsigned char 连接符长度，不是连接符时返回0
+ */
+static unsigned char shellMatchStatementOp(const char *string, unsigned short length,
+                                           ShellStatementOp *op)
+{
+#if SHELL_SUPPORT_MULTI_STATEMENT == 1
+    if (string[0] == ';')
+    {
+        *op = SHELL_STATEMENT_SEQUENCE;
+        return 1;
+    }
+    if (length > 1 && string[0] == '&' && string[1] == '&')
+    {
+        *op = SHELL_STATEMENT_AND;
+        return 2;
+    }
+    if (length > 1 && string[0] == '|' && string[1] == '|')
+    {
+        *op = SHELL_STATEMENT_OR;
+        return 2;
+    }
+#endif /** SHELL_SUPPORT_MULTI_STATEMENT == 1 */
+#if SHELL_PIPE_BUFFER > 0
+    if (string[0] == '|')
+    {
+        *op = SHELL_STATEMENT_PIPE;
+        return 1;
+    }
+#endif /** SHELL_PIPE_BUFFER > 0 */
+#if SHELL_SUPPORT_BACKGROUND == 1
+    if (string[0] == '&' && !(length > 1 && string[1] == '&'))
+    {
+        *op = SHELL_STATEMENT_BACKGROUND;
+        return 1;
+    }
+#endif /** SHELL_SUPPORT_BACKGROUND == 1 */
+    return 0;
 }
 
 
 /**
- * @brief shell删除命令行数据
+ * @brief shell 语句分割
+ *        在引号，成对字符以及转义字符之外查找语句连接符，连接符的位置会被替换为字符串结束符，
+ *        表达式括号之外紧跟在`$var`之后的`<`，`>`，`|`以及`&`返回`SHELL_STATEMENT_INVALID`，并且不再分割剩余的命令行
  * 
- * @param shell shell对象
- * @param length 删除长度
+ * @param string 命令行
+ * @param length 命令行长度
+ * @param statementLength 语句长度
+ * @param redirect 语句中第一个重定向符的位置，没有重定向时等于语句长度
+ * @param op 语句之后的连接符
+ * 
+ * @return unsigned short 处理的字符数量，包括语句和连接符
  */
-void shellDeleteCommandLine(Shell *shell, unsigned char length)
+static unsigned short shellNextStatement(char *string, unsigned short length,
+                                         unsigned short *statementLength,
+                                         unsigned short *redirect, ShellStatementOp *op)
 {
-    while (length--)
+    unsigned short depth = 0;
+    unsigned char quoted = 0;
+    unsigned char opLength;
+#if SHELL_SUPPORT_EXPRESSION == 1
+    unsigned short word = 0;
+#endif
+
+    *op = SHELL_STATEMENT_END;
+    *redirect = length;
+    for (unsigned short i = 0; i < length; i++)
     {
-        shellWriteString(shell, "\b \b");
+        char data = string[i];
+        if (data == '\\')
+        {
+            i++;
+            continue;
+        }
+        if (data == '\"')
+        {
+            quoted = !quoted;
+            continue;
+        }
+        if (quoted)
+        {
+            continue;
+        }
+    #if SHELL_SUPPORT_EXPRESSION == 1
+        if (data == '(' && shellIsExprParen(i > 0 ? string[i - 1] : 0))
+        {
+            depth++;
+        }
+        else if (data == ')' && depth > 0)
+        {
+            depth--;
+        }
+        if (depth == 0 && data == ' ')
+        {
+            word = i + 1;
+        }
+        /* 括号之外紧跟在`$var`之后的运算符会被当作连接符，拒绝执行而不是改变语句的含义 */
+        if (depth == 0 && (data == '<' || data == '>' || data == '|' || data == '&')
+            && memchr(string + word, '$', i - word)
+            && (data == '<' || data == '>' ? SHELL_REDIRECT_BUFFER > 0
+                : shellMatchStatementOp(&string[i], length - i, op) > 0))
+        {
+            *op = SHELL_STATEMENT_INVALID;
+            *statementLength = i;
+            *redirect = i;
+            string[i] = 0;
+            return length;
+        }
+    #endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+        for (unsigned char j = 1; j < sizeof(pairedChars) / 2; j++)
+        {
+            if (data == pairedChars[j][0])
+            {
+                depth++;
+            }
+            else if (data == pairedChars[j][1] && depth > 0)
+            {
+                depth--;
+            }
+        }
+    #if SHELL_REDIRECT_BUFFER > 0
+        if (depth == 0 && *redirect == length && (data == '<' || data == '>'))
+        {
+            *redirect = i;
+        }
+    #endif /** SHELL_REDIRECT_BUFFER > 0 */
+        if (depth == 0 && (opLength = shellMatchStatementOp(&string[i], length - i, op)) > 0)
+        {
+            *statementLength = i;
+            if (*redirect == length)
+            {
+                *redirect = i;
+            }
+            string[i] = 0;
+            return i + opLength;
+        }
     }
+    *statementLength = length;
+    return length;
 }
+#endif /** SHELL_USING_STATEMENT */
 
 
+#if SHELL_PIPE_BUFFER > 0
 /**
- * @brief shell 清空命令行输入
+ * @brief shell 执行读取管道缓冲的命令
+ *        使用保存的参数执行命令，写入管道的命令在此期间暂停，它的参数以及读写函数在命令结束后恢复，
+ *        命令多次执行时，任意一次返回0即以0作为返回值，否则以最后一次的返回值作为返回值
  * 
  * @param shell shell对象
+ * @param level 命令读取的管道级数
  */
-void shellClearCommandLine(Shell *shell)
+static void shellPipeRun(Shell *shell, unsigned char level)
 {
-    for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+    ShellToken token[SHELL_PARAMETER_MAX_NUMBER];
+    unsigned short paramCount = shell->parser.paramCount;
+    signed short (*read)(char *, unsigned short) = shell->read;
+    signed short (*write)(char *, unsigned short) = shell->write;
+    unsigned char current = shell->pipe.current;
+    unsigned char isActive = shell->status.isActive;
+    unsigned char isRedirected = shell->status.isRedirected;
+    int ret;
+
+#if SHELL_SUPPORT_CANCEL == 1
+    if (shellCheckCancel(shell))
     {
-        shellWriteByte(shell, ' ');
+        return;
     }
-    shellDeleteCommandLine(shell, shell->parser.length);
+#endif
+    memcpy(token, shell->parser.token, sizeof(token));
+    memcpy(shell->parser.token, shell->pipe.stage[level].token, sizeof(token));
+    for (short i = 0; i < SHELL_PARAMETER_MAX_NUMBER; i++)
+    {
+        shell->parser.param[i] = shell->parser.token[i].start;
+    }
+    shell->parser.paramCount = shell->pipe.stage[level].paramCount;
+    shell->read = shell->pipe.stage[level].read;
+    shell->write = shell->pipe.stage[level].write;
+    shell->status.isRedirected = shell->pipe.stage[level].redirected;
+    shell->pipe.current = level + 1;
+
+    ret = shellRunCommand(shell, (ShellCommand *) shell->pipe.stage[level].command);
+
+    shell->pipe.current = current;
+    shell->status.isRedirected = isRedirected;
+    shell->status.isActive = isActive;
+    shell->read = read;
+    shell->write = write;
+    shell->parser.paramCount = paramCount;
+    memcpy(shell->parser.token, token, sizeof(token));
+    for (short i = 0; i < SHELL_PARAMETER_MAX_NUMBER; i++)
+    {
+        shell->parser.param[i] = shell->parser.token[i].start;
+    }
+    if (!shell->pipe.stage[level].executed || shell->pipe.stage[level].ret != 0)
+    {
+        shell->pipe.stage[level].ret = ret;
+    }
+    shell->pipe.stage[level].executed = 1;
 }
 
 
 /**
- * @brief shell插入一个字符到光标位置
+ * @brief shell 排空管道缓冲
+ *        使用缓冲中的数据执行读取管道的命令，写入管道的命令未结束时，只交出完整的行，
+ *        不完整的行留在缓冲中，和之后写入的数据一起交出，缓冲中没有换行时整块交出
  * 
  * @param shell shell对象
- * @param data 字符数据
+ * @param level 管道级数
+ * @param final 写入管道的命令已经结束
  */
-void shellInsertByte(Shell *shell, char data)
+static void shellPipeDrain(Shell *shell, unsigned char level, unsigned char final)
 {
-    /* 判断输入数据是否过长 */
-    if (shell->parser.length >= shell->parser.bufferSize - 1)
+    char *buffer = shell->pipe.buffer[level];
+    unsigned short length = shell->pipe.length[level];
+    unsigned short chunk = length;
+
+    if (!final)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_CMD_TOO_LONG]);
-        shellWritePrompt(shell, 1);
-        shellWriteString(shell, shell->parser.buffer);
-        return;
+        while (chunk > 0 && buffer[chunk - 1] != '\n')
+        {
+            chunk--;
+        }
+        if (chunk == 0)
+        {
+            chunk = length;
+        }
     }
+    shell->pipe.length[level] = chunk;
+    shell->pipe.offset[level] = 0;
+    shellPipeRun(shell, level);
+    memmove(buffer, buffer + chunk, length - chunk);
+    shell->pipe.length[level] = length - chunk;
+}
 
-    /* 插入数据 */
-    if (shell->parser.cursor == shell->parser.length)
+
+/**
+ * @brief shell 管道写
+ *        写入当前命令的输出管道缓冲，缓冲写满时先排空缓冲，再继续写入剩余的数据
+ * 
+ * @param data 数据
+ * @param len 数据长度
+ * 
+ * @return signed short 写入的数据长度
+ */
+static signed short shellPipeWrite(char *data, unsigned short len)
+{
+    Shell *shell = shellGetCurrent();
+    unsigned char level;
+    unsigned short size;
+
+    if (shell == NULL)
     {
-        shell->parser.buffer[shell->parser.length++] = data;
-        shell->parser.buffer[shell->parser.length] = 0;
-        shell->parser.cursor++;
-        shellWriteByte(shell, shell->status.isChecked ? data : '*');
+        return 0;
     }
-    else if (shell->parser.cursor < shell->parser.length)
+    level = shell->pipe.current;
+    for (unsigned short i = 0; i < len; i += size)
     {
-        for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+        if (shell->pipe.length[level] == SHELL_PIPE_BUFFER)
         {
-            shell->parser.buffer[shell->parser.cursor + i] = 
-                shell->parser.buffer[shell->parser.cursor + i - 1];
+            shellPipeDrain(shell, level, 0);
         }
-        shell->parser.buffer[shell->parser.cursor++] = data;
-        shell->parser.buffer[++shell->parser.length] = 0;
-        for (short i = shell->parser.cursor - 1; i < shell->parser.length; i++)
+        size = SHELL_PIPE_BUFFER - shell->pipe.length[level];
+        if (size > len - i)
         {
-            shellWriteByte(shell, 
-                           shell->status.isChecked ? shell->parser.buffer[i] : '*');
+            size = len - i;
         }
-        for (short i = shell->parser.length - shell->parser.cursor; i > 0; i--)
+        memcpy(shell->pipe.buffer[level] + shell->pipe.length[level], data + i, size);
+        shell->pipe.length[level] += size;
+    }
+    return len;
+}
+
+
+/**
+ * @brief shell 管道读
+ *        读取当前命令的输入管道缓冲，本次交出的数据读取完后返回0
+ * 
+ * @param data 数据
+ * @param len 读取长度
+ * 
+ * @return signed short 读取的数据长度
+ */
+static signed short shellPipeRead(char *data, unsigned short len)
+{
+    Shell *shell = shellGetCurrent();
+    unsigned char level;
+    unsigned short remain;
+
+    if (shell == NULL || shell->pipe.current == 0)
+    {
+        return 0;
+    }
+    level = shell->pipe.current - 1;
+    remain = shell->pipe.length[level] - shell->pipe.offset[level];
+    if (len > remain)
+    {
+        len = remain;
+    }
+    memcpy(data, shell->pipe.buffer[level] + shell->pipe.offset[level], len);
+    shell->pipe.offset[level] += len;
+    return len;
+}
+
+
+/**
+ * @brief shell 结束管道
+ *        管道中第一个命令结束后，依次使用各级缓冲中剩余的数据执行读取管道的命令，
+ *        没有执行过的命令以空输入执行一次
+ * 
+ * @param shell shell对象
+ * 
+ * @return int 管道中最后一个命令的返回值，命令被取消时返回-1
+ */
+static int shellPipeClose(Shell *shell)
+{
+    unsigned char depth = shell->pipe.depth;
+
+    for (unsigned char level = 0; level < depth; level++)
+    {
+        if (shell->pipe.length[level] > 0 || !shell->pipe.stage[level].executed)
         {
-            shellWriteByte(shell, '\b');
+            shellPipeDrain(shell, level, 1);
         }
     }
+    shell->pipe.depth = 0;
+    return shell->pipe.stage[depth - 1].executed ? shell->pipe.stage[depth - 1].ret : -1;
 }
+#endif /** SHELL_PIPE_BUFFER > 0 */
 
 
+#if SHELL_REDIRECT_BUFFER > 0
 /**
- * @brief shell 删除字节
+ * @brief shell 写输出重定向文件
+ *        文件只写入部分数据时继续写入剩余的数据，写入失败后不再写入，关闭文件时报告错误
  * 
  * @param shell shell对象
- * @param direction 删除方向 {@code 1}删除光标前字符 {@code -1}删除光标处字符
+ * @param data 数据
+ * @param len 数据长度
  */
-void shellDeleteByte(Shell *shell, signed char direction)
+static void shellRedirectWriteFile(Shell *shell, const char *data, unsigned short len)
 {
-    char offset = (direction == -1) ? 1 : 0;
+    int ret;
 
-    if ((shell->parser.cursor == 0 && direction == 1)
-        || (shell->parser.cursor == shell->parser.length && direction == -1))
+    while (len > 0 && !shell->redirect.error)
     {
-        return;
+        ret = shell->redirect.file->write(shell->redirect.output, data, len);
+        if (ret <= 0 || ret > len)
+        {
+            shell->redirect.error = 1;
+            break;
+        }
+        data += ret;
+        len -= ret;
     }
-    if (shell->parser.cursor == shell->parser.length && direction == 1)
+}
+
+
+/**
+ * @brief shell 重定向缓冲写入文件
+ * 
+ * @param shell shell对象
+ */
+static void shellRedirectFlush(Shell *shell)
+{
+    if (shell->redirect.length > 0)
     {
-        shell->parser.cursor--;
-        shell->parser.length--;
-        shell->parser.buffer[shell->parser.length] = 0;
-        shellDeleteCommandLine(shell, 1);
+        shellRedirectWriteFile(shell, shell->redirect.buffer, shell->redirect.length);
+        shell->redirect.length = 0;
     }
-    else
+}
+
+
+/**
+ * @brief shell 重定向写
+ *        数据先写入块缓冲，缓冲满时整块写入文件，不小于缓冲大小的数据直接写入文件
+ * 
+ * @param data 数据
+ * @param len 数据长度
+ * 
+ * @return signed short 写入的数据长度，写文件失败后返回0
+ */
+static signed short shellRedirectWrite(char *data, unsigned short len)
+{
+    Shell *shell = shellGetCurrent();
+
+    if (shell == NULL || shell->redirect.error)
     {
-        for (short i = offset; i < shell->parser.length - shell->parser.cursor; i++)
+        return 0;
+    }
+    if (shell->redirect.length + len > SHELL_REDIRECT_BUFFER)
+    {
+        shellRedirectFlush(shell);
+    }
+    if (len >= SHELL_REDIRECT_BUFFER)
+    {
+        shellRedirectWriteFile(shell, data, len);
+        return shell->redirect.error ? 0 : len;
+    }
+    memcpy(shell->redirect.buffer + shell->redirect.length, data, len);
+    shell->redirect.length += len;
+    return len;
+}
+
+
+/**
+ * @brief shell 重定向读
+ *        读取输入重定向文件，文件读取完后返回0
+ * 
+ * @param data 数据
+ * @param len 读取长度
+ * 
+ * @return signed short 读取的数据长度
+ */
+static signed short shellRedirectRead(char *data, unsigned short len)
+{
+    Shell *shell = shellGetCurrent();
+    int ret;
+
+    if (shell == NULL)
+    {
+        return 0;
+    }
+    ret = shell->redirect.file->read(shell->redirect.input, data, len);
+    return ret > 0 ? ret : 0;
+}
+
+
+/**
+ * @brief shell 关闭重定向文件
+ *        输出重定向文件关闭前会写入缓冲中剩余的数据，写入或者关闭失败时输出错误
+ * 
+ * @param shell shell对象
+ * 
+ * @return int 0 关闭成功 -1 输出没有完整写入文件
+ */
+static int shellRedirectClose(Shell *shell)
+{
+    int ret = 0;
+
+    if (shell->redirect.output)
+    {
+        shellRedirectFlush(shell);
+        if (shell->redirect.file->close(shell->redirect.output) != 0)
         {
-            shell->parser.buffer[shell->parser.cursor + i - 1] = 
-                shell->parser.buffer[shell->parser.cursor + i];
+            shell->redirect.error = 1;
         }
-        shell->parser.length--;
-        if (!offset)
+        shell->redirect.output = NULL;
+        if (shell->redirect.error)
         {
-            shell->parser.cursor--;
-            shellWriteByte(shell, '\b');
+            shellWriteString(shell, shellText[SHELL_TEXT_REDIRECT_WRITE_ERROR]);
+            ret = -1;
+        }
+    }
+    if (shell->redirect.input)
+    {
+        shell->redirect.file->close(shell->redirect.input);
+        shell->redirect.input = NULL;
+    }
+    shell->redirect.error = 0;
+    return ret;
+}
+
+
+/**
+ * @brief shell 打开重定向文件
+ *        解析语句末尾的`< file`，`> file`以及`>> file`，同一方向多次重定向时，以最后一个为准
+ * 
+ * @param shell shell对象
+ * @param string 重定向字符串，从第一个重定向符开始
+ * @param length 重定向字符串长度
+ * 
+ * @return int 0 打开成功 -1 打开失败
+ */
+static int shellRedirectOpen(Shell *shell, char *string, unsigned short length)
+{
+    unsigned short i = 0;
+
+    shell->redirect.file = shellCompanionGet(shell, SHELL_COMPANION_ID_FILE);
+    shell->redirect.length = 0;
+    shell->redirect.error = 0;
+    while (i < length)
+    {
+        const char *mode = "w";
+        void **target = &shell->redirect.output;
+        char *path;
+        char next;
+
+        if (string[i] == '<')
+        {
+            mode = "r";
+            target = &shell->redirect.input;
+        }
+        else if (string[i] != '>')
+        {
+            i++;
+            continue;
+        }
+        else if (i + 1 < length && string[i + 1] == '>')
+        {
+            mode = "a";
+            i++;
+        }
+        i++;
+        while (i < length && string[i] == ' ')
+        {
+            i++;
+        }
+        path = &string[i];
+        while (i < length && string[i] != ' ' && string[i] != '<' && string[i] != '>')
+        {
+            i++;
         }
-        shell->parser.buffer[shell->parser.length] = 0;
-        for (short i = shell->parser.cursor; i < shell->parser.length; i++)
+        next = string[i];
+        string[i] = 0;
+        if (*target)
         {
-            shellWriteByte(shell, shell->parser.buffer[i]);
+            if (target == &shell->redirect.output)
+            {
+                shellRedirectFlush(shell);
+            }
+            shell->redirect.file->close(*target);
+            *target = NULL;
         }
-        shellWriteByte(shell, ' ');
-        for (short i = shell->parser.length - shell->parser.cursor + 1; i > 0; i--)
+        if (shell->redirect.file == NULL || shell->redirect.file->open == NULL
+            || *path == 0 || (*target = shell->redirect.file->open(path, mode)) == NULL)
         {
-            shellWriteByte(shell, '\b');
+            shellWriteString(shell, shellText[SHELL_TEXT_REDIRECT_ERROR]);
+            shellWriteString(shell, path);
+            shellWriteString(shell, "\r\n");
+            string[i] = next;
+            if (shell->redirect.file)
+            {
+                shellRedirectClose(shell);
+            }
+            return -1;
         }
+        string[i] = next;
     }
+    return 0;
 }
+#endif /** SHELL_REDIRECT_BUFFER > 0 */
 
 
+#if SHELL_PIPE_BUFFER > 0
 /**
- * @brief shell 字符串分割
+ * @brief shell 准备管道
+ *        解析管道中第一个命令之后的命令，保存命令参数并打开命令的重定向文件，
+ *        这些命令在前一个命令写满管道缓冲或者结束时执行
  * 
- * @param string 字符串
- * @param array 分割后保存的字符串数组
- * @param splitKey 分隔符
- * @param maxNum 最大分割数量
+ * @param shell shell对象
+ * @param string 管道中第一个命令之后的命令行
+ * @param length 命令行长度
+ * @param used 管道中的命令占用的字符数量，包括连接符
+ * @param op 管道之后的连接符
+ * @param prepare 为0时只跳过管道中的命令
  * 
- * @return int 分割得到的字串数量
+ * @return int 0 准备完成 -1 命令为空，命令未找到，管道级数过多或者重定向失败
  */
-int shellSplit(char *string, unsigned short strLen, char *array[], char splitKey, short maxNum)
+static int shellPipeOpen(Shell *shell, char *string, unsigned short length,
+                         unsigned short *used, ShellStatementOp *op, unsigned char prepare)
 {
-    unsigned char record = 1;
-    unsigned char pairedLeft[16] = {0};
-    unsigned char pariedCount = 0;
-    int count = 0;
-
-    for (short i = 0; i < maxNum; i++)
-    {
-        array[i] = NULL;
-    }
+    unsigned short offset = 0;
+    int ret = prepare ? 0 : -1;
 
-    for (unsigned short i = 0; i < strLen; i++)
+    shell->pipe.depth = 0;
+    shell->pipe.current = 0;
+    do
     {
-        if (pariedCount == 0)
+        char *statement = string + offset;
+        unsigned short statementLength;
+        unsigned short redirect;
+        unsigned char level = shell->pipe.depth;
+
+        offset += shellNextStatement(statement, length - offset,
+                                     &statementLength, &redirect, op);
+        if (ret != 0)
         {
-            if (string[i] != splitKey && record == 1 && count < maxNum)
-            {
-                array[count++] = &(string[i]);
-                record = 0;
-            }
-            else if ((string[i] == splitKey || string[i] == ' ') && record == 0)
+            continue;
+        }
+        if (level >= SHELL_PIPE_DEPTH)
+        {
+            shellWriteString(shell, shellText[SHELL_TEXT_PIPE_TOO_DEEP]);
+            ret = -1;
+            continue;
+        }
+        shell->pipe.stage[level].read = shellPipeRead;
+        shell->pipe.stage[level].write = shell->write;
+        shell->pipe.stage[level].redirected = 0;
+    #if SHELL_REDIRECT_BUFFER > 0
+        if (redirect < statementLength)
+        {
+            if (shellRedirectOpen(shell, statement + redirect, statementLength - redirect) != 0)
             {
-                string[i] = 0;
-                if (string[i + 1] != ' ')
-                {
-                    record = 1;
-                }
+                ret = -1;
                 continue;
             }
-        }
-
-        for (unsigned char j = 0; j < sizeof(pairedChars) / 2; j++)
-        {
-            if (pariedCount > 0
-                && string[i] == pairedChars[j][1]
-                && pairedLeft[pariedCount - 1] == pairedChars[j][0])
+            if (memchr(statement + redirect, '<', statementLength - redirect))
             {
-                --pariedCount;
-                break;
+                shell->pipe.stage[level].read = shellRedirectRead;
             }
-            else if (string[i] == pairedChars[j][0])
+            if (memchr(statement + redirect, '>', statementLength - redirect))
             {
-                pairedLeft[pariedCount++] = pairedChars[j][0];
-                pariedCount &= 0x0F;
-                break;
+                shell->pipe.stage[level].write = shellRedirectWrite;
+                shell->pipe.stage[level].redirected = 1;
             }
+            statement[redirect] = 0;
+            statementLength = redirect;
         }
-        
-        if (string[i] == '\\' && string[i + 1] != 0)
+    #endif /** SHELL_REDIRECT_BUFFER > 0 */
+        shellParserParam(shell, statement, statementLength);
+        if (shell->parser.paramCount == 0)
         {
-            i++;
+            ret = -1;
+            continue;
         }
-    }
-    return count;
+        shell->pipe.stage[level].command = shellSeekCommand(shell,
+                                                            shell->parser.param[0],
+                                                            shell->commandList.base,
+                                                            0);
+        if (shell->pipe.stage[level].command == NULL)
+        {
+            shellWriteString(shell, shellText[SHELL_TEXT_CMD_NOT_FOUND]);
+            ret = -1;
+            continue;
+        }
+        memcpy(shell->pipe.stage[level].token, shell->parser.token,
+               sizeof(shell->pipe.stage[level].token));
+        shell->pipe.stage[level].paramCount = shell->parser.paramCount;
+        shell->pipe.stage[level].executed = 0;
+        shell->pipe.stage[level].ret = 0;
+        shell->pipe.length[level] = 0;
+        shell->pipe.offset[level] = 0;
+        if (level > 0 && !shell->pipe.stage[level - 1].redirected)
+        {
+            shell->pipe.stage[level - 1].write = shellPipeWrite;
+            shell->pipe.stage[level - 1].redirected = 1;
+        }
+        shell->pipe.depth++;
+    } while (*op == SHELL_STATEMENT_PIPE && offset < length);
+    *used = offset;
+    return ret;
 }
+#endif /** SHELL_PIPE_BUFFER > 0 */
 
 
+#if SHELL_SUPPORT_BACKGROUND == 1
 /**
- * @brief shell 解析参数
+ * @brief shell 后台命令执行函数
+ */
+static ShellBackground shellBackground = NULL;
+
+
+/**
+ * @brief shell 设置后台命令执行函数
+ *        执行函数需要在返回前复制命令参数，参数所在的缓冲在函数返回后会被下一条命令复用
  * 
- * @param shell shell对象
+ * @param handler 后台命令执行函数，为NULL时不支持后台执行
+ * @param remove 移除shell时调用，结束或者分离该shell的后台命令，之后不能再使用该shell
  */
-static void shellParserParam(Shell *shell)
+void shellSetBackground(ShellBackground handler, ShellBackgroundRemove remove)
 {
-    shell->parser.paramCount = 
-        shellSplit(shell->parser.buffer, shell->parser.length, 
-                   shell->parser.param, ' ', SHELL_PARAMETER_MAX_NUMBER);
+    shellBackground = handler;
+    shellBackgroundRemove = remove;
 }
 
 
 /**
- * @brief shell去除字符串参数头尾的双引号
+ * @brief shell 后台执行命令
+ *        命令在当前shell中解析，之后交给后台命令执行函数运行
  * 
  * @param shell shell对象
+ * @param string 命令字符串
+ * @param length 命令字符串长度
+ * 
+ * @return int 派发成功返回0，否则返回-1
  */
-static void shellRemoveParamQuotes(Shell *shell)
+static int shellExecBackground(Shell *shell, char *string, unsigned short length)
 {
-    unsigned short paramLength;
-    for (unsigned short i = 0; i < shell->parser.paramCount; i++)
+    int ret = -1;
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    unsigned short arenaTop = shell->arena.top;
+#endif
+
+    shellParserParam(shell, string, length);
+    if (shell->parser.paramCount == 0)
     {
-        if (shell->parser.param[i][0] == '\"')
-        {
-            shell->parser.param[i][0] = 0;
-            shell->parser.param[i] = &shell->parser.param[i][1];
-        }
-        paramLength = strlen(shell->parser.param[i]);
-        if (shell->parser.param[i][paramLength - 1] == '\"')
-        {
-            shell->parser.param[i][paramLength - 1] = 0;
-        }
+        return 0;
+    }
+
+    ShellCommand *command = shellSeekCommand(shell,
+                                             shell->parser.param[0],
+                                             shell->commandList.base,
+                                             0);
+    if (command == NULL)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_CMD_NOT_FOUND]);
+    }
+    else if (shellBackground == NULL
+             || shellBackground(shell, command,
+                                shell->parser.paramCount, shell->parser.param) != 0)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_BACKGROUND_ERROR]);
     }
+    else
+    {
+        ret = 0;
+    }
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    shell->arena.top = arenaTop;
+#endif
+    return ret;
 }
+#endif /** SHELL_SUPPORT_BACKGROUND == 1 */
 
 
+#if SHELL_USING_STATEMENT
 /**
- * @brief shell匹配命令
+ * @brief shell 执行命令行中的语句
+ *        管道中的命令作为一条语句，第一个命令的输出写入管道缓冲，缓冲写满或者命令结束时，
+ *        使用缓冲中的数据执行下一个命令，每一级管道使用一个缓冲，命令的输出不受缓冲大小限制
+ *        `&&`和`||`根据前一条语句(管道为最后一个命令)的返回值决定是否执行，返回0表示成功，
+ *        被跳过的语句不改变返回值，所以`a && b || c`在`a`失败时会执行`c`
+ *        `&`之前的语句交给后台命令执行函数运行，返回值表示是否派发成功
+ *        命令被取消后，不再执行剩余的语句
  * 
  * @param shell shell对象
- * @param cmd 命令
- * @param base 匹配命令表基址
- * @param compareLength 匹配字符串长度
- * @return ShellCommand* 匹配到的命令
+ * @param line 命令行
+ * @param length 命令行长度
  */
-ShellCommand* shellSeekCommand(Shell *shell,
-                               const char *cmd,
-                               ShellCommand *base,
-                               unsigned short compareLength)
+static void shellExecStatements(Shell *shell, char *line, unsigned short length)
 {
-    const char *name;
-    unsigned short count = shell->commandList.count -
-        ((size_t)base - (size_t)shell->commandList.base) / sizeof(ShellCommand);
-    for (unsigned short i = 0; i < count; i++)
+    unsigned short offset = 0;
+    ShellStatementOp prevOp = SHELL_STATEMENT_END;
+    int ret = 0;
+#if SHELL_SUPPORT_YIELD == 1
+    unsigned char suspend = shell->yield.suspend;
+#endif
+
+    while (offset < length)
     {
-        if (base[i].attr.attrs.type == SHELL_TYPE_KEY
-            || shellCheckPermission(shell, &base[i]) != 0)
+        signed short (*read)(char *, unsigned short) = NULL;
+        signed short (*write)(char *, unsigned short) = NULL;
+        char *statement = line + offset;
+        unsigned short statementLength;
+        unsigned short redirect;
+        ShellStatementOp op;
+        unsigned char skip;
+        int error = 0;
+    #if SHELL_PIPE_BUFFER > 0
+        unsigned char piped = 0;
+    #endif
+    #if SHELL_SUPPORT_VAR_EXPAND == 1
+        unsigned short arenaTop = shell->arena.top;
+    #endif
+
+        offset += shellNextStatement(statement, length - offset,
+                                     &statementLength, &redirect, &op);
+    #if SHELL_SUPPORT_CANCEL == 1
+        if (shellCheckCancel(shell))
+        {
+            break;
+        }
+    #endif
+        skip = (prevOp == SHELL_STATEMENT_AND && ret != 0)
+            || (prevOp == SHELL_STATEMENT_OR && ret == 0);
+    #if SHELL_PIPE_BUFFER > 0
+        if (op == SHELL_STATEMENT_PIPE)
+        {
+            unsigned short used;
+            error = shellPipeOpen(shell, line + offset, length - offset, &used, &op, !skip);
+            offset += used;
+            write = shellPipeWrite;
+            piped = 1;
+        }
+    #endif /** SHELL_PIPE_BUFFER > 0 */
+    #if SHELL_SUPPORT_EXPRESSION == 1
+        if (op == SHELL_STATEMENT_INVALID)
+        {
+            shellWriteString(shell, shellText[SHELL_TEXT_EXPR_OPERATOR]);
+            error = -1;
+            skip = 0;
+        }
+    #endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+        prevOp = op;
+        if (skip)
         {
             continue;
         }
-        name = shellGetCommandName(&base[i]);
-        if (!compareLength)
+    #if SHELL_SUPPORT_BACKGROUND == 1
+        if (op == SHELL_STATEMENT_BACKGROUND && error == 0)
         {
-            if (strcmp(cmd, name) == 0)
+            if (redirect < statementLength || write != NULL)
             {
-                return &base[i];
+                shellWriteString(shell, shellText[SHELL_TEXT_BACKGROUND_ERROR]);
+                error = -1;
+            }
+            else
+            {
+                ret = shellExecBackground(shell, statement, statementLength);
+                continue;
             }
         }
-        else
+    #endif /** SHELL_SUPPORT_BACKGROUND == 1 */
+    #if SHELL_REDIRECT_BUFFER > 0
+        if (redirect < statementLength && error == 0)
         {
-            if (strncmp(cmd, name, compareLength) == 0)
+            error = shellRedirectOpen(shell, statement + redirect, statementLength - redirect);
+            if (memchr(statement + redirect, '<', statementLength - redirect))
             {
-                return &base[i];
+                read = shellRedirectRead;
+            }
+            if (memchr(statement + redirect, '>', statementLength - redirect))
+            {
+                write = shellRedirectWrite;
             }
+            statement[redirect] = 0;
+            statementLength = redirect;
         }
-    }
-    return NULL;
-}
-
-
-/**
- * @brief shell 获取变量值
- * 
- * @param shell shell对象
- * @param command 命令
- * @return int 变量值
- */
-int shellGetVarValue(Shell *shell, ShellCommand *command)
-{
-    int value = 0;
-    switch (command->attr.attrs.type)
-    {
-    case SHELL_TYPE_VAR_INT:
-        value = *((int *)(command->data.var.value));
-        break;
-    case SHELL_TYPE_VAR_SHORT:
-        value = *((short *)(command->data.var.value));
-        break;
-    case SHELL_TYPE_VAR_CHAR:
-        value = *((char *)(command->data.var.value));
-        break;
-    case SHELL_TYPE_VAR_STRING:
-    case SHELL_TYPE_VAR_POINT:
-        value = (size_t)(command->data.var.value);
-        break;
-    case SHELL_TYPE_VAR_NODE: {
-        int (*func)(void *) = ((ShellNodeVarAttr *)command->data.var.value)->get;
-        value = func ? func(((ShellNodeVarAttr *)command->data.var.value)->var) : 0;
-        break;
-    }
-    default:
-        break;
-    }
-    return value;
-}
-
-
-/**
- * @brief shell设置变量值
- * 
- * @param shell shell对象
- * @param command 命令
- * @param value 值
- * @return int 返回变量值
- */
-int shellSetVarValue(Shell *shell, ShellCommand *command, int value)
-{
-    if (command->attr.attrs.readOnly)
-    {
-        shellWriteString(shell, shellText[SHELL_TEXT_VAR_READ_ONLY_CANNOT_MODIFY]);
-    }
-    else
-    {
-        switch (command->attr.attrs.type)
+    #endif /** SHELL_REDIRECT_BUFFER > 0 */
+    #if SHELL_SUPPORT_YIELD == 1
+        /* 只有最后一条语句，并且没有管道和重定向时，命令可以挂起 */
+        shell->yield.suspend = suspend && offset >= length && read == NULL && write == NULL;
+    #endif
+        ret = -1;
+        if (error == 0)
         {
-        case SHELL_TYPE_VAR_INT:
-            *((int *)(command->data.var.value)) = value;
-            break;
-        case SHELL_TYPE_VAR_SHORT:
-            *((short *)(command->data.var.value)) = value;
-            break;
-        case SHELL_TYPE_VAR_CHAR:
-            *((char *)(command->data.var.value)) = value;
-            break;
-        case SHELL_TYPE_VAR_STRING:
-            shellStringCopy(((char *)(command->data.var.value)), (char *) (size_t) value);
-            break;
-        case SHELL_TYPE_VAR_POINT:
-            shellWriteString(shell, shellText[SHELL_TEXT_POINT_CANNOT_MODIFY]);
-            break;
-        case SHELL_TYPE_VAR_NODE:
-            if (((ShellNodeVarAttr *)command->data.var.value)->set)
+            ret = shellExecCommand(shell, statement, statementLength, read, write);
+        #if SHELL_PIPE_BUFFER > 0
+            if (piped)
             {
-                if (((ShellNodeVarAttr *)command->data.var.value)->var)
-                {
-                    int (*func)(void *, int) = ((ShellNodeVarAttr *)command->data.var.value)->set;
-                    func(((ShellNodeVarAttr *)command->data.var.value)->var, value);
-                }
-                else
-                {
-                    int (*func)(int) = ((ShellNodeVarAttr *)command->data.var.value)->set;
-                    func(value);
-                }
+                ret = shellPipeClose(shell);
             }
-            break;
-        default:
-            break;
+        #endif /** SHELL_PIPE_BUFFER > 0 */
+        }
+    #if SHELL_PIPE_BUFFER > 0
+        shell->pipe.depth = 0;
+    #endif /** SHELL_PIPE_BUFFER > 0 */
+    #if SHELL_REDIRECT_BUFFER > 0
+        if ((shell->redirect.input || shell->redirect.output)
+            && shellRedirectClose(shell) != 0)
+        {
+            ret = -1;
         }
+    #endif /** SHELL_REDIRECT_BUFFER > 0 */
+    #if SHELL_SUPPORT_VAR_EXPAND == 1
+        shell->arena.top = arenaTop;
+    #endif
     }
-    return shellShowVar(shell, command);
 }
+#endif /** SHELL_USING_STATEMENT */
 
 
 /**
- * @brief shell变量输出
+ * @brief shell 执行一行命令
+ *        行首的空格已经去除，并且不是空行
  * 
  * @param shell shell对象
- * @param command 命令
- * @return int 返回变量值
+ * @param line 命令行
+ * @param length 命令行长度
  */
-static int shellShowVar(Shell *shell, ShellCommand *command)
+static void shellExecLine(Shell *shell, char *line, unsigned short length)
 {
-    char buffer[12] = "00000000000";
-    int value = shellGetVarValue(shell, command);
-    
-    shellWriteString(shell, command->data.var.name);
-    shellWriteString(shell, " = ");
-
-    switch (command->attr.attrs.type)
-    {
-    case SHELL_TYPE_VAR_STRING:
-        shellWriteString(shell, "\"");
-        shellWriteString(shell, (char *) (size_t) value);
-        shellWriteString(shell, "\"");
-        break;
-    // case SHELL_TYPE_VAR_INT:
-    // case SHELL_TYPE_VAR_SHORT:
-    // case SHELL_TYPE_VAR_CHAR:
-    // case SHELL_TYPE_VAR_POINT:
-    default:
-        shellWriteString(shell, &buffer[11 - shellToDec(value, buffer)]);
-        shellWriteString(shell, ", 0x");
-        for (short i = 0; i < 11; i++)
-        {
-            buffer[i] = '0';
-        }
-        shellToHex(value, buffer);
-        shellWriteString(shell, buffer);
-        break;
-    }
-
-    shellWriteString(shell, "\r\n");
-    return value;
+#if SHELL_SUPPORT_CANCEL == 1
+    shellCancelReset(shell);
+#endif
+#if SHELL_USING_STATEMENT
+    shellExecStatements(shell, line, length);
+#else
+    shellExecCommand(shell, line, length, NULL, NULL);
+#endif
 }
 
 
 /**
- * @brief shell设置变量
+ * @brief shell运行命令
  * 
- * @param name 变量名
- * @param value 变量值
- * @return int 返回变量值
+ * @param shell shell对象
  */
-int shellSetVar(char *name, int value)
+void shellExec(Shell *shell)
 {
-    Shell *shell = shellGetCurrent();
-    if (shell == NULL)
+    char *line = shell->parser.buffer;
+    unsigned short length = shell->parser.length;
+
+    if (shell->parser.length == 0)
     {
-        return 0;
+        return;
     }
-    ShellCommand *command = shellSeekCommand(shell,
-                                             name,
-                                             shell->commandList.base,
-                                             0);
-    if (!command)
+
+    shell->parser.buffer[shell->parser.length] = 0;
+
+    if (shell->status.isChecked)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_VAR_NOT_FOUND]);
-        return 0;
+    #if SHELL_HISTORY_MAX_NUMBER > 0
+        shellHistoryAdd(shell);
+    #endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+        shell->parser.length = shell->parser.cursor = 0;
+        while (length > 0 && *line == ' ')
+        {
+            line++;
+            length--;
+        }
+        if (length == 0)
+        {
+            return;
+        }
+        shellWriteString(shell, "\r\n");
+    #if SHELL_SUPPORT_YIELD == 1
+        shell->yield.suspend = 1;
+    #endif
+        shellExecLine(shell, line, length);
+    #if SHELL_SUPPORT_YIELD == 1
+        shell->yield.suspend = 0;
+    #endif
     }
-    if (command->attr.attrs.type < SHELL_TYPE_VAR_INT
-        || command->attr.attrs.type > SHELL_TYPE_VAR_NODE)
+    else
     {
-        shellWriteString(shell, name);
-        shellWriteString(shell, shellText[SHELL_TEXT_NOT_VAR]);
-        return 0;
+        shellCheckPassword(shell);
     }
-    return shellSetVarValue(shell, command, value);
 }
-SHELL_EXPORT_CMD(
-SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
-setVar, shellSetVar, set var);
 
 
+#if SHELL_EXEC_QUEUE_SIZE > 0
 /**
- * @brief shell运行命令
+ * @brief shell 命令行加入执行队列
+ *        命令行连续存放，队列尾部的空间不足时，在尾部写入空行作为回绕标记，从队列头部开始存放，
+ *        只由输入上下文调用，队列尾在数据写入完成后更新，之后调用`queue.notify`唤醒执行上下文
  * 
  * @param shell shell对象
- * @param command 命令
+ * @param line 命令行
+ * @param length 命令行长度
  * 
- * @return unsigned int 命令返回值
+ * @return int 0 成功 -1 队列已满
  */
-unsigned int shellRunCommand(Shell *shell, ShellCommand *command)
+static int shellExecEnqueue(Shell *shell, const char *line, unsigned short length)
 {
-    int returnValue = 0;
-    shell->status.isActive = 1;
-    if (command->attr.attrs.type == SHELL_TYPE_CMD_MAIN)
+    unsigned short head = SHELL_ATOMIC_LOAD(&shell->queue.head);
+    unsigned short tail = shell->queue.tail;
+    unsigned short start = tail;
+
+    if (tail >= head)
     {
-        shellRemoveParamQuotes(shell);
-        int (*func)(int, char **) = command->data.cmd.function;
-        returnValue = func(shell->parser.paramCount, shell->parser.param);
-        if (!command->attr.attrs.disableReturn)
+        if (tail + length + 1 > SHELL_EXEC_QUEUE_SIZE
+            || (tail + length + 1 == SHELL_EXEC_QUEUE_SIZE && head == 0))
         {
-            shellWriteReturnValue(shell, returnValue);
+            if (length + 1 >= head)
+            {
+                return -1;
+            }
+            start = 0;
         }
     }
-    else if (command->attr.attrs.type == SHELL_TYPE_CMD_FUNC)
+    else if (tail + length + 1 >= head)
     {
-        returnValue = shellExtRun(shell,
-                                  command,
-                                  shell->parser.paramCount,
-                                  shell->parser.param);
-        if (!command->attr.attrs.disableReturn)
-        {
-            shellWriteReturnValue(shell, returnValue);
-        }
+        return -1;
     }
-    else if (command->attr.attrs.type >= SHELL_TYPE_VAR_INT
-        && command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
+    memcpy(&shell->queue.buffer[start], line, length);
+    shell->queue.buffer[start + length] = 0;
+    if (start != tail)
     {
-        shellShowVar(shell, command);
+        shell->queue.buffer[tail] = 0;
     }
-    else if (command->attr.attrs.type == SHELL_TYPE_USER)
+    tail = start + length + 1;
+    SHELL_ATOMIC_STORE(&shell->queue.tail, tail == SHELL_EXEC_QUEUE_SIZE ? 0 : tail);
+    if (shell->queue.notify)
     {
-        shellSetUser(shell, command);
+        shell->queue.notify(shell);
     }
-    shell->status.isActive = 0;
-
-    return returnValue;
+    return 0;
 }
 
 
 /**
- * @brief shell校验密码
+ * @brief shell 回车时将命令行加入执行队列
+ *        命令行加入队列后清空输入缓冲，命令提示符由执行上下文在命令执行完成后输出，
+ *        队列已满时丢弃命令行，命令行仍然会加入历史记录，可以通过上方向键重新输入
  * 
  * @param shell shell对象
+ * 
+ * @return int 1 命令行已处理 0 不需要排队(未使能队列，未登录或者空行)
  */
-static void shellCheckPassword(Shell *shell)
+static int shellEnterQueue(Shell *shell)
 {
-    if (strcmp(shell->parser.buffer, shell->info.user->data.user.password) == 0)
+    char *line = shell->parser.buffer;
+    unsigned short length = shell->parser.length;
+
+    if (!shell->queue.enable || !shell->status.isChecked)
     {
-        shell->status.isChecked = 1;
-    #if SHELL_SHOW_INFO == 1
-        shellWriteString(shell, shellText[SHELL_TEXT_INFO]);
-    #endif
+        return 0;
     }
-    else
+    line[length] = 0;
+    while (length > 0 && *line == ' ')
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_PASSWORD_ERROR]);
+        line++;
+        length--;
     }
-    shell->parser.length = 0;
-    shell->parser.cursor = 0;
+    if (length == 0)
+    {
+        return 0;
+    }
+#if SHELL_HISTORY_MAX_NUMBER > 0
+    shellHistoryAdd(shell);
+#endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+    shellWriteString(shell, "\r\n");
+    if (shellExecEnqueue(shell, line, length) != 0)
+    {
+        shellWriteString(shell, shellText[SHELL_TEXT_QUEUE_FULL]);
+    }
+    shell->parser.length = shell->parser.cursor = 0;
+    return 1;
 }
+#endif /** SHELL_EXEC_QUEUE_SIZE > 0 */
 
 
+#if SHELL_SUPPORT_MACHINE_MODE == 1
 /**
- * @brief shell设置用户
+ * @brief shell 机器模式执行一行命令
+ *        机器模式下命令行只包含一条命令，不进行语句分割
  * 
  * @param shell shell对象
- * @param user 用户
+ * @param line 命令行
+ * @param length 命令行长度
+ * @param value 命令返回值
+ * 
+ * @return ShellResultStatus 执行结果
  */
-void shellSetUser(Shell *shell, const ShellCommand *user)
+static ShellResultStatus shellMachineExecLine(Shell *shell, char *line,
+                                              unsigned short length, int *value)
 {
-    shell->info.user = user;
-    shell->status.isChecked = 
-        ((user->data.user.password && strlen(user->data.user.password) != 0)
-            && (shell->parser.paramCount < 2
-                || strcmp(user->data.user.password, shell->parser.param[1]) != 0))
-         ? 0 : 1;
-        
-#if SHELL_CLS_WHEN_LOGIN == 1
-    shellWriteString(shell, shellText[SHELL_TEXT_CLEAR_CONSOLE]);
+    ShellResultStatus status = SHELL_RESULT_OK;
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    unsigned short arenaTop = shell->arena.top;
 #endif
-#if SHELL_SHOW_INFO == 1
-    if (shell->status.isChecked)
+
+#if SHELL_SUPPORT_CANCEL == 1
+    shellCancelReset(shell);
+#endif
+    shellParserParam(shell, line, length);
+    if (shell->parser.paramCount > 0)
     {
-        shellWriteString(shell, shellText[SHELL_TEXT_INFO]);
+        ShellCommand *command = shellSeekCommand(shell,
+                                                 shell->parser.param[0],
+                                                 shell->commandList.base,
+                                                 0);
+        if (command != NULL)
+        {
+            *value = shellRunCommand(shell, command);
+        }
+        else
+        {
+            status = SHELL_RESULT_NOT_FOUND;
+        }
     }
+#if SHELL_SUPPORT_VAR_EXPAND == 1
+    shell->arena.top = arenaTop;
 #endif
+    return status;
 }
 
 
 /**
- * @brief shell写返回值
+ * @brief shell 机器模式输出命令结果
+ *        如果命令退出了机器模式，则输出命令提示符
  * 
  * @param shell shell对象
- * @param value 返回值
+ * @param status 执行结果
+ * @param value 命令返回值
  */
-static void shellWriteReturnValue(Shell *shell, int value)
+static void shellMachineFinish(Shell *shell, ShellResultStatus status, int value)
 {
-    char buffer[12] = "00000000000";
-    shellWriteString(shell, "Return: ");
-    shellWriteString(shell, &buffer[11 - shellToDec(value, buffer)]);
-    shellWriteString(shell, ", 0x");
-    for (short i = 0; i < 11; i++)
+    if (shell->status.isMachine)
     {
-        buffer[i] = '0';
+        shellWriteResult(shell, status, value);
+    }
+    else
+    {
+        shellWritePrompt(shell, 1);
     }
-    shellToHex(value, buffer);
-    shellWriteString(shell, buffer);
-    shellWriteString(shell, "\r\n");
-#if SHELL_KEEP_RETURN_VALUE == 1
-    shell->info.retVal = value;
-#endif
 }
 
 
-#if SHELL_HISTORY_MAX_NUMBER > 0
 /**
- * @brief shell历史记录添加
+ * @brief shell 机器模式运行命令
+ *        命令执行完成后输出结果帧，如果命令退出了机器模式，则输出命令提示符
  * 
  * @param shell shell对象
  */
-static void shellHistoryAdd(Shell *shell)
+static void shellMachineExec(Shell *shell)
 {
-    shell->history.offset = 0;
-    if (shell->history.number > 0
-        && strcmp(shell->history.item[(shell->history.record == 0 ? 
-                SHELL_HISTORY_MAX_NUMBER : shell->history.record) - 1],
-                shell->parser.buffer) == 0)
-    {
-        return;
-    }
-    if (shellStringCopy(shell->history.item[shell->history.record],
-                        shell->parser.buffer) != 0)
-    {
-        shell->history.record++;
-    }
-    if (++shell->history.number > SHELL_HISTORY_MAX_NUMBER)
+    ShellResultStatus status = SHELL_RESULT_OK;
+    int value = 0;
+    unsigned short length = shell->parser.length;
+
+    shell->parser.buffer[shell->parser.length] = 0;
+
+    if (shell->status.isChecked)
     {
-        shell->history.number = SHELL_HISTORY_MAX_NUMBER;
+        shell->parser.length = shell->parser.cursor = 0;
+        status = shellMachineExecLine(shell, shell->parser.buffer, length, &value);
     }
-    if (shell->history.record >= SHELL_HISTORY_MAX_NUMBER)
+    else
     {
-        shell->history.record = 0;
+        shellCheckPassword(shell);
+        status = shell->status.isChecked ? SHELL_RESULT_OK : SHELL_RESULT_DENIED;
     }
+    shellMachineFinish(shell, status, value);
 }
 
 
 /**
- * @brief shell历史记录查找
+ * @brief shell 机器模式输入
+ *        输入不回显，也不进行编辑，收到回车或者换行时执行命令，空行会被忽略
  * 
  * @param shell shell对象
- * @param dir 方向 {@code <0}往上查找 {@code >0}往下查找
+ * @param data 输入字符
  */
-static void shellHistory(Shell *shell, signed char dir)
+static void shellMachineInput(Shell *shell, char data)
 {
-    if (dir > 0)
+    if (data == '\r' || data == '\n')
     {
-        if (shell->history.offset-- <= 
-            -((shell->history.number > shell->history.record) ?
-                shell->history.number : shell->history.record))
+        if (shell->status.machineOverflow)
         {
-            shell->history.offset = -((shell->history.number > shell->history.record)
-                                    ? shell->history.number : shell->history.record);
+            shell->status.machineOverflow = 0;
+            shell->parser.length = shell->parser.cursor = 0;
+            shellWriteResult(shell, SHELL_RESULT_TOO_LONG, 0);
         }
-    }
-    else if (dir < 0)
-    {
-        if (++shell->history.offset > 0)
+        else if (shell->parser.length > 0)
         {
-            shell->history.offset = 0;
-            return;
+        #if SHELL_EXEC_QUEUE_SIZE > 0
+            if (shell->queue.enable && shell->status.isChecked)
+            {
+                if (shellExecEnqueue(shell, shell->parser.buffer, shell->parser.length) != 0)
+                {
+                    shellWriteResult(shell, SHELL_RESULT_BUSY, 0);
+                }
+                shell->parser.length = shell->parser.cursor = 0;
+                return;
+            }
+        #endif /** SHELL_EXEC_QUEUE_SIZE > 0 */
+            shellMachineExec(shell);
         }
     }
+    else if (shell->parser.length < shell->parser.bufferSize - 1)
+    {
+        shell->parser.buffer[shell->parser.length++] = data;
+        shell->parser.cursor = shell->parser.length;
+    }
     else
     {
-        return;
+        shell->status.machineOverflow = 1;
     }
-    shellClearCommandLine(shell);
-    if (shell->history.offset == 0)
+}
+
+
+/**
+ * @brief shell 设置机器模式
+ *        机器模式下，shell不回显输入，不输出命令提示符，命令的输出会去除转义序列后作为输出帧写入，
+ *        每条命令执行完成后写入一个结果帧，尾行模式的输出作为日志帧写入
+ * 
+ * @param shell shell对象
+ * @param enable 1 进入机器模式 0 退出机器模式
+ */
+void shellSetMachineMode(Shell *shell, unsigned char enable)
+{
+    SHELL_ASSERT(shell, return);
+    shell->status.isMachine = enable ? 1 : 0;
+    shell->status.machineOverflow = 0;
+    shell->status.escapeState = 0;
+    if (!shell->status.isActive)
     {
-        shell->parser.cursor = shell->parser.length = 0;
+        shell->parser.length = shell->parser.cursor = 0;
+        shell->parser.keyValue = 0x00000000;
     }
-    else
+}
+
+
+/**
+ * @brief shell 切换机器模式(shell调用)
+ * 
+ * @param enable 1 进入机器模式 0 退出机器模式
+ * 
+ * @return int 0 设置成功 -1 没有正在执行命令的shell
+ */
+int shellMachine(int enable)
+{
+    Shell *shell = shellGetCurrent();
+    if (shell == NULL)
     {
-        if ((shell->parser.length = shellStringCopy(shell->parser.buffer,
-                shell->history.item[(shell->history.record + SHELL_HISTORY_MAX_NUMBER
-                    + shell->history.offset) % SHELL_HISTORY_MAX_NUMBER])) == 0)
-        {
-            return;
-        }
-        shell->parser.cursor = shell->parser.length;
-        shellWriteString(shell, shell->parser.buffer);
+        return -1;
     }
-    
+    shellSetMachineMode(shell, enable);
+    return 0;
 }
-#endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+SHELL_EXPORT_CMD(
+SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+machine, shellMachine, switch machine mode\r\nmachine [0|1]);
+#endif /** SHELL_SUPPORT_MACHINE_MODE == 1 */
 
 
+#if SHELL_EXEC_QUEUE_SIZE > 0
 /**
- * @brief shell 常规输入
+ * @brief shell 执行队列中命令的读函数
+ *        端口输入由输入上下文处理，执行队列中的命令没有输入
  * 
- * @param shell shell 对象
- * @param data 输入字符
+ * @param data 数据
+ * @param len 数据长度
+ * 
+ * @return signed short 0
+ */
+static signed short shellExecQueueRead(char *data, unsigned short len)
+{
+    (void) data;
+    (void) len;
+    return 0;
+}
+
+
+/**
+ * @brief shell 设置命令行执行队列
+ *        使能后，`shellHandler`只进行行编辑和回显，回车时将命令行加入执行队列，
+ *        执行上下文需要周期调用`shellExecQueued`执行队列中的命令行，或者设置`queue.notify`，
+ *        在命令行入队时唤醒执行上下文，
+ *        端口读写函数保存给输入上下文使用，需要在设置读写函数并且调用`shellInit`之后调用
+ * 
+ * @param shell shell对象
+ * @param enable 1 使能 0 禁用
+ */
+void shellSetExecQueue(Shell *shell, unsigned char enable)
+{
+    SHELL_ASSERT(shell, return);
+    if (enable && !shell->queue.enable)
+    {
+        shell->queue.read = shell->read;
+        shell->queue.write = shell->write;
+        shell->read = shellExecQueueRead;
+    }
+    else if (!enable && shell->queue.enable)
+    {
+        shell->read = shell->queue.read;
+    }
+    shell->queue.enable = enable ? 1 : 0;
+}
+
+
+/**
+ * @brief shell 移出执行队列头部的命令行
+ * 
+ * @param shell shell对象
+ * @param head 命令行在队列中的位置
+ * @param length 命令行长度
  */
-void shellNormalInput(Shell *shell, char data)
+static void shellExecDequeue(Shell *shell, unsigned short head, unsigned short length)
 {
-    shell->status.tabFlag = 0;
-    shellInsertByte(shell, data);
+    head += length + 1;
+    SHELL_ATOMIC_STORE(&shell->queue.head, head == SHELL_EXEC_QUEUE_SIZE ? 0 : head);
 }
 
 
 /**
- * @brief shell运行命令
+ * @brief shell 执行队列中的一行命令
+ *        在执行上下文中调用，命令执行期间不持有shell锁，输入上下文可以继续编辑和回显，
+ *        尾行输出也不需要等待，队列中的命令行全部执行完成后输出命令提示符并重绘正在输入的命令行
  * 
  * @param shell shell对象
+ * 
+ * @return int 1 执行了一行命令 0 队列为空
  */
-void shellExec(Shell *shell)
+int shellExecQueued(Shell *shell)
 {
-    
-    if (shell->parser.length == 0)
+    unsigned short head;
+    unsigned short length;
+    char *line;
+
+    SHELL_ASSERT(shell, return 0);
+    head = shell->queue.head;
+    if (head == SHELL_ATOMIC_LOAD(&shell->queue.tail))
     {
-        return;
+        return 0;
     }
-
-    shell->parser.buffer[shell->parser.length] = 0;
-
-    if (shell->status.isChecked)
+    if (shell->queue.buffer[head] == 0)
     {
-    #if SHELL_HISTORY_MAX_NUMBER > 0
-        shellHistoryAdd(shell);
-    #endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
-        shellParserParam(shell);
-        shell->parser.length = shell->parser.cursor = 0;
-        if (shell->parser.paramCount == 0)
-        {
-            return;
-        }
-        shellWriteString(shell, "\r\n");
+        head = 0;
+    }
+    line = &shell->queue.buffer[head];
+    length = strlen(line);
 
-        ShellCommand *command = shellSeekCommand(shell,
-                                                 shell->parser.param[0],
-                                                 shell->commandList.base,
-                                                 0);
-        if (command != NULL)
-        {
-            shellRunCommand(shell, command);
-        }
-        else
-        {
-            shellWriteString(shell, shellText[SHELL_TEXT_CMD_NOT_FOUND]);
-        }
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    if (shell->status.isMachine)
+    {
+        int value = 0;
+        ShellResultStatus status = shellMachineExecLine(shell, line, length, &value);
+        shellExecDequeue(shell, head, length);
+        SHELL_LOCK(shell);
+        shellMachineFinish(shell, status, value);
+        SHELL_UNLOCK(shell);
+        return 1;
     }
-    else
+#endif /** SHELL_SUPPORT_MACHINE_MODE == 1 */
+    shellExecLine(shell, line, length);
+    shellExecDequeue(shell, head, length);
+    SHELL_LOCK(shell);
+    if (shell->queue.head == SHELL_ATOMIC_LOAD(&shell->queue.tail))
     {
-        shellCheckPassword(shell);
+        shellWritePrompt(shell, 1);
+        if (shell->parser.length > 0)
+        {
+            shell->parser.buffer[shell->parser.length] = 0;
+            shellWriteString(shell, shell->parser.buffer);
+            for (short i = 0; i < shell->parser.length - shell->parser.cursor; i++)
+            {
+                shellWriteByte(shell, '\b');
+            }
+        }
     }
+    SHELL_UNLOCK(shell);
+    return 1;
 }
+#endif /** SHELL_EXEC_QUEUE_SIZE > 0 */
 
 
 #if SHELL_HISTORY_MAX_NUMBER > 0
@@ -1693,7 +4170,20 @@ SHELL_EXPORT_KEY(SHELL_CMD_PERMISSION(0)|SHELL_CMD_ENABLE_UNCHECKED,
  */
 void shellEnter(Shell *shell)
 {
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    if (shellEnterQueue(shell))
+    {
+        return;
+    }
+#endif
     shellExec(shell);
+#if SHELL_SUPPORT_YIELD == 1
+    /* 命令挂起时，命令提示符在命令结束后输出 */
+    if (shell->yield.command)
+    {
+        return;
+    }
+#endif
     shellWritePrompt(shell, 1);
 }
 #if SHELL_ENTER_LF == 1
@@ -1759,15 +4249,40 @@ SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RE
 help, shellHelp, show command info\r\nhelp [cmd]);
 
 /**
- * @brief shell 输入处理
+ * @brief shell 处理一个输入字节
+ *        调用者持有shell锁
  * 
  * @param shell shell对象
  * @param data 输入数据
  */
-void shellHandler(Shell *shell, char data)
+static void shellHandleByte(Shell *shell, char data)
 {
-    SHELL_ASSERT(data, return);
-    SHELL_LOCK(shell);
+#if SHELL_SUPPORT_CANCEL == 1
+    /* 命令执行期间(执行队列或者中断中输入)收到取消按键时只设置取消标志 */
+    if (data == SHELL_CANCEL_KEY && shellIsBusy(shell))
+    {
+        SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
+        return;
+    }
+#endif
+
+#if SHELL_SUPPORT_YIELD == 1
+    /* 命令挂起期间不处理输入，只响应取消按键 */
+    if (shell->yield.command)
+    {
+    #if SHELL_SUPPORT_CANCEL == 1
+        if (data == SHELL_CANCEL_KEY)
+        {
+            SHELL_ATOMIC_STORE(&shell->cancel.flag, 1);
+        }
+    #endif
+        return;
+    }
+#endif
+
+#if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+    shellEndLineFlush(shell);
+#endif
 
 #if SHELL_LOCK_TIMEOUT > 0
     if (shell->info.user->data.user.password
@@ -1777,10 +4292,26 @@ void shellHandler(Shell *shell, char data)
         if (SHELL_GET_TICK() - shell->info.activeTime > SHELL_LOCK_TIMEOUT)
         {
             shell->status.isChecked = 0;
+        #if SHELL_PROMPT_BUFFER > 0
+            shell->prompt.length = 0;
+        #endif
         }
     }
 #endif
 
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    /* 机器模式下不进行按键匹配，直接接收命令 */
+    if (shell->status.isMachine)
+    {
+        shellMachineInput(shell, data);
+        if (SHELL_GET_TICK())
+        {
+            shell->info.activeTime = SHELL_GET_TICK();
+        }
+        return;
+    }
+#endif
+
     /* 根据记录的按键键值计算当前字节在按键键值中的偏移 */
     char keyByteOffset = 24;
     int keyFilter = 0x00000000;
@@ -1840,35 +4371,250 @@ void shellHandler(Shell *shell, char data)
     {
         shell->info.activeTime = SHELL_GET_TICK();
     }
+}
+
+
+/**
+ * @brief shell 输入处理
+ * 
+ * @param shell shell对象
+ * @param data 输入数据
+ */
+void shellHandler(Shell *shell, char data)
+{
+    SHELL_ASSERT(data, return);
+    SHELL_LOCK(shell);
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 1;
+#endif
+    shellHandleByte(shell, data);
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 0;
+#endif
+    SHELL_UNLOCK(shell);
+}
+
+
+/**
+ * @brief shell 批量输入处理
+ *        整块数据在一次加锁中处理，适用于网络等一次接收多个字节的输入，数据中的0会被忽略
+ * 
+ * @param shell shell对象
+ * @param data 输入数据
+ * @param len 数据长度
+ */
+void shellInput(Shell *shell, const char *data, unsigned short len)
+{
+    SHELL_ASSERT(shell && data, return);
+    SHELL_LOCK(shell);
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 1;
+#endif
+    for (unsigned short i = 0; i < len; i++)
+    {
+        if (data[i] != 0)
+        {
+            shellHandleByte(shell, data[i]);
+        }
+    }
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 0;
+#endif
     SHELL_UNLOCK(shell);
 }
 
 
 #if SHELL_SUPPORT_END_LINE == 1
+/**
+ * @brief shell 尾行模式重绘命令行
+ *
+ * @param shell shell对象
+ */
+static void shellEndLineRedraw(Shell *shell)
+{
+    shellWritePrompt(shell, 0);
+    if (shell->parser.length > 0)
+    {
+        shellWriteString(shell, shell->parser.buffer);
+        for (short i = 0; i < shell->parser.length - shell->parser.cursor; i++)
+        {
+            shellWriteByte(shell, '\b');
+        }
+    }
+}
+
+
+#if SHELL_END_LINE_REDRAW_DELAY > 0
+/**
+ * @brief shell 尾行模式重绘待重绘的命令行
+ *
+ * @param shell shell对象
+ */
+static void shellEndLineFlush(Shell *shell)
+{
+    if (shell->status.endLinePending)
+    {
+        shell->status.endLinePending = 0;
+        if (!shell->status.isActive)
+        {
+            shellEndLineRedraw(shell);
+        }
+    }
+}
+#endif /** SHELL_END_LINE_REDRAW_DELAY > 0 */
+
+
+/**
+ * @brief shell 尾行模式写入
+ *
+ * @param shell shell对象
+ * @param buffer 数据
+ * @param len 数据长度
+ */
 void shellWriteEndLine(Shell *shell, char *buffer, int len)
 {
     SHELL_LOCK(shell);
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+    if (shell->status.isMachine)
+    {
+        shellWriteFrame(shell, SHELL_FRAME_LOG, buffer, len);
+        SHELL_UNLOCK(shell);
+        return;
+    }
+#endif
     if (!shell->status.isActive)
     {
+    #if SHELL_END_LINE_REDRAW_DELAY > 0
+        if (!shell->status.endLinePending)
+        {
+            shellWriteString(shell, shellText[SHELL_TEXT_CLEAR_LINE]);
+            shell->status.endLinePending = 1;
+        }
+        shell->info.endLineTime = SHELL_GET_TICK();
+    #else
         shellWriteString(shell, shellText[SHELL_TEXT_CLEAR_LINE]);
+    #endif
     }
-    shell->write(buffer, len);
+    SHELL_IO(shell, write)(buffer, len);
 
+#if SHELL_END_LINE_REDRAW_DELAY == 0
     if (!shell->status.isActive)
     {
-        shellWritePrompt(shell, 0);
-        if (shell->parser.length > 0)
+        shellEndLineRedraw(shell);
+    }
+#endif
+    SHELL_UNLOCK(shell);
+}
+
+
+/**
+ * @brief shell 重绘尾行模式下延时重绘的命令行
+ *        适用于没有`SHELL_GET_TICK()`或者不周期调用`shellTask()`的场景，
+ *        在一批尾行输出结束后主动调用
+ *
+ * @param shell shell对象
+ */
+void shellFlush(Shell *shell)
+{
+#if SHELL_END_LINE_REDRAW_DELAY > 0
+    SHELL_LOCK(shell);
+    shellEndLineFlush(shell);
+    SHELL_UNLOCK(shell);
+#else
+    (void) shell;
+#endif
+}
+#endif /** SHELL_SUPPORT_END_LINE == 1 */
+
+
+#if SHELL_SUPPORT_YIELD == 1
+/**
+ * @brief shell 恢复执行挂起的命令
+ *        `shellTask`每次调用时自动调用，直接调用`shellHandler`处理输入时，需要在主循环中周期调用，
+ *        命令结束后输出返回值和命令提示符
+ * 
+ * @param shell shell对象
+ * 
+ * @return int 1 命令仍在挂起 0 没有挂起的命令
+ */
+int shellPoll(Shell *shell)
+{
+    ShellCommand *command;
+    ShellYieldState (*func)(ShellYield *, int, char **);
+    ShellYieldState state;
+    Shell *current;
+
+    SHELL_ASSERT(shell, return 0);
+    if (shell->yield.command == NULL)
+    {
+        return 0;
+    }
+    SHELL_LOCK(shell);
+    command = (ShellCommand *)shell->yield.command;
+    func = (ShellYieldState (*)(ShellYield *, int, char **))command->data.cmd.function;
+    current = SHELL_GET_CURRENT();
+    shell->status.isActive = 1;
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 1;
+#endif
+    SHELL_SET_CURRENT(shell);
+    state = func(&shell->yield.context, shell->parser.paramCount, shell->parser.param);
+    SHELL_SET_CURRENT(current);
+#if SHELL_USING_LOCK == 1
+    shell->status.isLocked = 0;
+#endif
+    shell->status.isActive = 0;
+    if (state == SHELL_YIELD_DONE)
+    {
+        shell->yield.command = NULL;
+        if (!command->attr.attrs.disableReturn)
         {
-            shellWriteString(shell, shell->parser.buffer);
-            for (short i = 0; i < shell->parser.length - shell->parser.cursor; i++)
-            {
-                shellWriteByte(shell, '\b');
-            }
+            shellWriteReturnValue(shell, shell->yield.context.retVal);
         }
+        shellWritePrompt(shell, 1);
     }
     SHELL_UNLOCK(shell);
+    return state == SHELL_YIELD_RUNNING;
 }
-#endif /** SHELL_SUPPORT_END_LINE == 1 */
+#endif /** SHELL_SUPPORT_YIELD == 1 */
+
+
+#if SHELL_TASK_WHILE == 1
+/**
+ * @brief shell 任务没有输入时的等待时间
+ *        挂起的命令在`SHELL_YIELD_DELAY`中时，等待到延时结束，其他挂起方式每个tick检查一次条件，
+ *        尾行输出等待重绘时，最多等待到重绘时间
+ * 
+ * @param shell shell对象
+ * 
+ * @return unsigned int 等待时间
+ */
+static unsigned int shellTaskWaitTime(Shell *shell)
+{
+    unsigned int wait = SHELL_WAIT_FOREVER;
+#if SHELL_SUPPORT_YIELD == 1
+    if (shell->yield.command)
+    {
+        wait = shellYieldWaitTime(&shell->yield.context);
+    }
+#endif
+#if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+    /* 其他线程的尾行输出不会唤醒等待，等待时间不超过重绘延时，静默后及时重绘命令行 */
+    unsigned int redraw = SHELL_END_LINE_REDRAW_DELAY;
+    if (shell->status.endLinePending)
+    {
+        unsigned int elapsed = SHELL_GET_TICK() - shell->info.endLineTime;
+        redraw = elapsed >= SHELL_END_LINE_REDRAW_DELAY
+                 ? 0 : SHELL_END_LINE_REDRAW_DELAY - elapsed;
+    }
+    if (redraw < wait)
+    {
+        wait = redraw;
+    }
+#endif
+    return wait;
+}
+#endif /** SHELL_TASK_WHILE == 1 */
 
 
 /**
@@ -1885,10 +4631,34 @@ void shellTask(void *param)
     while(1)
     {
 #endif
-        if (shell->read && shell->read(&data, 1) == 1)
+    #if SHELL_SUPPORT_YIELD == 1
+        shellPoll(shell);
+    #endif
+    #if SHELL_SUPPORT_CANCEL == 1
+        /* 先处理命令执行期间查询取消时保存的输入 */
+        if (shell->cancel.pendingLength > 0 && shellCancelReadInput(shell, &data, 1) == 1)
         {
             shellHandler(shell, data);
         }
+        else
+    #endif
+        if (SHELL_IO(shell, read) && SHELL_IO(shell, read)(&data, 1) == 1)
+        {
+            shellHandler(shell, data);
+        }
+    #if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+        else if (shell->status.endLinePending
+                 && SHELL_GET_TICK() - shell->info.endLineTime >= SHELL_END_LINE_REDRAW_DELAY)
+        {
+            shellFlush(shell);
+        }
+    #endif
+    #if SHELL_TASK_WHILE == 1
+        else
+        {
+            shellWaitInput(shell, shellTaskWaitTime(shell));
+        }
+    #endif
 #if SHELL_TASK_WHILE == 1
     }
 #endif
@@ -1975,6 +4745,61 @@ SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RE
 clear, shellClear, clear console);
 
 
+#if SHELL_PIPE_BUFFER > 0
+/**
+ * @brief shell 过滤输入
+ *        逐行读取输入，输出包含指定字符串的行，一般用于管道，如`cmds | grep var`，
+ *        超过127个字符的行会被分段匹配，管道的输出较多时，按块多次执行，每块只包含完整的行
+ * 
+ * @param argc 参数个数
+ * @param argv 参数
+ * 
+ * @return int 0 存在匹配的行 1 没有匹配的行 -1 参数错误
+ */
+int shellGrep(int argc, char *argv[])
+{
+    Shell *shell = shellGetCurrent();
+    char line[128];
+    unsigned short length = 0;
+    unsigned char matched = 0;
+    signed short ret;
+    char data;
+
+    if (shell == NULL || argc != 2)
+    {
+        return -1;
+    }
+    do
+    {
+        ret = shell->read(&data, 1);
+        if (ret == 1 && data != '\r' && data != '\n')
+        {
+            line[length++] = data;
+            if (length < sizeof(line) - 1)
+            {
+                continue;
+            }
+        }
+        if (length > 0)
+        {
+            line[length] = 0;
+            if (strstr(line, argv[1]) != NULL)
+            {
+                shellWriteString(shell, line);
+                shellWriteString(shell, "\r\n");
+                matched = 1;
+            }
+            length = 0;
+        }
+    } while (ret == 1);
+    return matched ? 0 : 1;
+}
+SHELL_EXPORT_CMD(
+SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+grep, shellGrep, print lines matching a pattern\r\ngrep [pattern]);
+#endif /** SHELL_PIPE_BUFFER > 0 */
+
+
 /**
  * @brief shell执行命令
  * 
@@ -13,6 +13,19 @@
 #define     __SHELL_H__
 
 #include "shell_cfg.h"
+#include <stddef.h>
+
+#if SHELL_USING_FUNC_INVOKER == 1 && SHELL_USING_FUNC_SIGNATURE != 1
+    #error SHELL_USING_FUNC_INVOKER requires SHELL_USING_FUNC_SIGNATURE
+#endif
+
+#if SHELL_REDIRECT_BUFFER > 0 && SHELL_USING_COMPANION != 1
+    #error SHELL_REDIRECT_BUFFER requires SHELL_USING_COMPANION
+#endif
+
+#if SHELL_SUPPORT_VAR_EXPAND == 1 && SHELL_PARAM_ARENA_SIZE == 0
+    #error SHELL_SUPPORT_VAR_EXPAND requires SHELL_PARAM_ARENA_SIZE
+#endif
 
 #define     SHELL_VERSION               "3.2.4"                 /**< 版本号 */
 
@@ -104,6 +117,123 @@
  */
 #define     SHELL_PARAM_FLOAT(x)            (*(float *)(&x))
 
+#if SHELL_USING_FUNC_INVOKER == 1
+/**
+ * @brief shell 调用函数参数转换
+ *        按照参数签名将解析得到的参数转换为对应类型
+ */
+#define     SHELL_INVOKER_VALUE_c(_param)   ((char)(_param).value)
+#define     SHELL_INVOKER_VALUE_q(_param)   ((char)(_param).value)
+#define     SHELL_INVOKER_VALUE_h(_param)   ((short)(_param).value)
+#define     SHELL_INVOKER_VALUE_i(_param)   ((int)(_param).value)
+#define     SHELL_INVOKER_VALUE_f(_param)   SHELL_PARAM_FLOAT((_param).value)
+#define     SHELL_INVOKER_VALUE_s(_param)   ((char *)(_param).value)
+#define     SHELL_INVOKER_VALUE_p(_param)   ((void *)(_param).value)
+#define     SHELL_INVOKER_VALUE_l(_param)   ((_param).integer)
+#define     SHELL_INVOKER_VALUE_d(_param)   ((_param).real)
+
+/**
+ * @brief shell 调用函数参数签名
+ */
+#define     SHELL_INVOKER_SIGN_c            'c'
+#define     SHELL_INVOKER_SIGN_q            'q'
+#define     SHELL_INVOKER_SIGN_h            'h'
+#define     SHELL_INVOKER_SIGN_i            'i'
+#define     SHELL_INVOKER_SIGN_f            'f'
+#define     SHELL_INVOKER_SIGN_s            's'
+#define     SHELL_INVOKER_SIGN_p            'p'
+#define     SHELL_INVOKER_SIGN_l            'l'
+#define     SHELL_INVOKER_SIGN_d            'd'
+
+#define     SHELL_INVOKER_CONCAT_(a, b)     a##b
+#define     SHELL_INVOKER_CONCAT(a, b)      SHELL_INVOKER_CONCAT_(a, b)
+
+/**
+ * @brief shell 调用函数参数数量
+ */
+#define     SHELL_INVOKER_NUM(...) \
+            SHELL_INVOKER_NUM_(__VA_ARGS__, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define     SHELL_INVOKER_NUM_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, \
+                               _n, ...) _n
+
+/**
+ * @brief shell 调用函数参数列表
+ * 
+ * @param _p 参数数组
+ * @param ... 参数签名
+ */
+#define     SHELL_INVOKER_ARGS(_p, ...) \
+            SHELL_INVOKER_CONCAT(SHELL_INVOKER_ARGS_, SHELL_INVOKER_NUM(__VA_ARGS__))(_p, __VA_ARGS__)
+#define     SHELL_INVOKER_ARGS_1(_p, _a) \
+            SHELL_INVOKER_VALUE_##_a(_p[0])
+#define     SHELL_INVOKER_ARGS_2(_p, _a, _b) \
+            SHELL_INVOKER_ARGS_1(_p, _a), SHELL_INVOKER_VALUE_##_b(_p[1])
+#define     SHELL_INVOKER_ARGS_3(_p, _a, _b, _c) \
+            SHELL_INVOKER_ARGS_2(_p, _a, _b), SHELL_INVOKER_VALUE_##_c(_p[2])
+#define     SHELL_INVOKER_ARGS_4(_p, _a, _b, _c, _d) \
+            SHELL_INVOKER_ARGS_3(_p, _a, _b, _c), SHELL_INVOKER_VALUE_##_d(_p[3])
+#define     SHELL_INVOKER_ARGS_5(_p, _a, _b, _c, _d, _e) \
+            SHELL_INVOKER_ARGS_4(_p, _a, _b, _c, _d), SHELL_INVOKER_VALUE_##_e(_p[4])
+#define     SHELL_INVOKER_ARGS_6(_p, _a, _b, _c, _d, _e, _f) \
+            SHELL_INVOKER_ARGS_5(_p, _a, _b, _c, _d, _e), SHELL_INVOKER_VALUE_##_f(_p[5])
+#define     SHELL_INVOKER_ARGS_7(_p, _a, _b, _c, _d, _e, _f, _g) \
+            SHELL_INVOKER_ARGS_6(_p, _a, _b, _c, _d, _e, _f), SHELL_INVOKER_VALUE_##_g(_p[6])
+#define     SHELL_INVOKER_ARGS_8(_p, _a, _b, _c, _d, _e, _f, _g, _h) \
+            SHELL_INVOKER_ARGS_7(_p, _a, _b, _c, _d, _e, _f, _g), SHELL_INVOKER_VALUE_##_h(_p[7])
+#define     SHELL_INVOKER_ARGS_9(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i) \
+            SHELL_INVOKER_ARGS_8(_p, _a, _b, _c, _d, _e, _f, _g, _h), SHELL_INVOKER_VALUE_##_i(_p[8])
+#define     SHELL_INVOKER_ARGS_10(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j) \
+            SHELL_INVOKER_ARGS_9(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i), SHELL_INVOKER_VALUE_##_j(_p[9])
+#define     SHELL_INVOKER_ARGS_11(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k) \
+            SHELL_INVOKER_ARGS_10(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j), SHELL_INVOKER_VALUE_##_k(_p[10])
+#define     SHELL_INVOKER_ARGS_12(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l) \
+            SHELL_INVOKER_ARGS_11(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k), SHELL_INVOKER_VALUE_##_l(_p[11])
+#define     SHELL_INVOKER_ARGS_13(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m) \
+            SHELL_INVOKER_ARGS_12(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l), SHELL_INVOKER_VALUE_##_m(_p[12])
+#define     SHELL_INVOKER_ARGS_14(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n) \
+            SHELL_INVOKER_ARGS_13(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m), SHELL_INVOKER_VALUE_##_n(_p[13])
+#define     SHELL_INVOKER_ARGS_15(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n, _o) \
+            SHELL_INVOKER_ARGS_14(_p, _a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n), SHELL_INVOKER_VALUE_##_o(_p[14])
+
+/**
+ * @brief shell 调用函数签名字符列表
+ * 
+ * @param ... 参数签名
+ */
+#define     SHELL_INVOKER_SIGN(...) \
+            SHELL_INVOKER_CONCAT(SHELL_INVOKER_SIGN_, SHELL_INVOKER_NUM(__VA_ARGS__))(__VA_ARGS__)
+#define     SHELL_INVOKER_SIGN_1(_a) \
+            SHELL_INVOKER_SIGN_##_a
+#define     SHELL_INVOKER_SIGN_2(_a, _b) \
+            SHELL_INVOKER_SIGN_1(_a), SHELL_INVOKER_SIGN_##_b
+#define     SHELL_INVOKER_SIGN_3(_a, _b, _c) \
+            SHELL_INVOKER_SIGN_2(_a, _b), SHELL_INVOKER_SIGN_##_c
+#define     SHELL_INVOKER_SIGN_4(_a, _b, _c, _d) \
+            SHELL_INVOKER_SIGN_3(_a, _b, _c), SHELL_INVOKER_SIGN_##_d
+#define     SHELL_INVOKER_SIGN_5(_a, _b, _c, _d, _e) \
+            SHELL_INVOKER_SIGN_4(_a, _b, _c, _d), SHELL_INVOKER_SIGN_##_e
+#define     SHELL_INVOKER_SIGN_6(_a, _b, _c, _d, _e, _f) \
+            SHELL_INVOKER_SIGN_5(_a, _b, _c, _d, _e), SHELL_INVOKER_SIGN_##_f
+#define     SHELL_INVOKER_SIGN_7(_a, _b, _c, _d, _e, _f, _g) \
+            SHELL_INVOKER_SIGN_6(_a, _b, _c, _d, _e, _f), SHELL_INVOKER_SIGN_##_g
+#define     SHELL_INVOKER_SIGN_8(_a, _b, _c, _d, _e, _f, _g, _h) \
+            SHELL_INVOKER_SIGN_7(_a, _b, _c, _d, _e, _f, _g), SHELL_INVOKER_SIGN_##_h
+#define     SHELL_INVOKER_SIGN_9(_a, _b, _c, _d, _e, _f, _g, _h, _i) \
+            SHELL_INVOKER_SIGN_8(_a, _b, _c, _d, _e, _f, _g, _h), SHELL_INVOKER_SIGN_##_i
+#define     SHELL_INVOKER_SIGN_10(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j) \
+            SHELL_INVOKER_SIGN_9(_a, _b, _c, _d, _e, _f, _g, _h, _i), SHELL_INVOKER_SIGN_##_j
+#define     SHELL_INVOKER_SIGN_11(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k) \
+            SHELL_INVOKER_SIGN_10(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j), SHELL_INVOKER_SIGN_##_k
+#define     SHELL_INVOKER_SIGN_12(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l) \
+            SHELL_INVOKER_SIGN_11(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k), SHELL_INVOKER_SIGN_##_l
+#define     SHELL_INVOKER_SIGN_13(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m) \
+            SHELL_INVOKER_SIGN_12(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l), SHELL_INVOKER_SIGN_##_m
+#define     SHELL_INVOKER_SIGN_14(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n) \
+            SHELL_INVOKER_SIGN_13(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m), SHELL_INVOKER_SIGN_##_n
+#define     SHELL_INVOKER_SIGN_15(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n, _o) \
+            SHELL_INVOKER_SIGN_14(_a, _b, _c, _d, _e, _f, _g, _h, _i, _j, _k, _l, _m, _n), SHELL_INVOKER_SIGN_##_o
+#endif /** SHELL_USING_FUNC_INVOKER == 1 */
+
 /**
  * @brief shell 代理函数名
  */
@@ -168,6 +298,39 @@
             }
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
 
+#if SHELL_USING_FUNC_INVOKER == 1
+    /**
+     * @brief shell 带类型命令定义
+     *        根据参数签名生成命令的函数签名以及调用函数，执行命令时，调用函数按照参数签名
+     *        将参数转换为对应的类型，直接调用命令函数，不需要根据参数数量选择函数类型
+     *        参数签名支持 `c`, `q`, `h`, `i`, `l`, `f`, `d`, `s`, `p`，命令函数需要有返回值
+     * 
+     * @param _attr 命令属性
+     * @param _name 命令名
+     * @param _func 命令函数
+     * @param _desc 命令描述
+     * @param ... 参数签名，如 `i, s, c`
+     */
+    #define SHELL_EXPORT_CMD_TYPED(_attr, _name, _func, _desc, ...) \
+            static int shellInvoker##_name(ShellParam *params) \
+            { \
+                return (int) _func(SHELL_INVOKER_ARGS(params, __VA_ARGS__)); \
+            } \
+            const char shellCmd##_name[] = #_name; \
+            const char shellDesc##_name[] = #_desc; \
+            const char shellSign##_name[] = {SHELL_INVOKER_SIGN(__VA_ARGS__), '\0'}; \
+            SHELL_USED const ShellCommand \
+            shellCommand##_name SHELL_SECTION("shellCommand") =  \
+            { \
+                .attr.value = _attr|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), \
+                .data.cmd.name = shellCmd##_name, \
+                .data.cmd.function = (int (*)())_func, \
+                .data.cmd.desc = shellDesc##_name, \
+                .data.cmd.signature = shellSign##_name, \
+                .data.cmd.invoker = shellInvoker##_name \
+            }
+#endif /** SHELL_USING_FUNC_INVOKER == 1 */
+
     /**
      * @brief shell 代理命令定义
      * 
@@ -372,6 +535,11 @@
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
 #endif /** SHELL_USING_CMD_EXPORT == 1 */
 
+/**
+ * @brief shell 一直等待输入
+ */
+#define     SHELL_WAIT_FOREVER          0xFFFFFFFF
+
 /**
  * @brief shell command类型
  */
@@ -379,6 +547,7 @@ typedef enum
 {
     SHELL_TYPE_CMD_MAIN = 0,                                    /**< main形式命令 */
     SHELL_TYPE_CMD_FUNC,                                        /**< C函数形式命令 */
+    SHELL_TYPE_CMD_YIELD,                                       /**< 可挂起命令 */
     SHELL_TYPE_VAR_INT,                                         /**< int型变量 */
     SHELL_TYPE_VAR_SHORT,                                       /**< short型变量 */
     SHELL_TYPE_VAR_CHAR,                                        /**< char型变量 */
@@ -393,6 +562,220 @@ typedef enum
 } ShellCommandType;
 
 
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+/**
+ * @brief shell 机器模式帧头
+ *        帧格式为 帧头(1字节) 帧类型(1字节) 数据长度(2字节，小端) 数据
+ */
+#define     SHELL_FRAME_HEAD            0xA5
+
+/**
+ * @brief shell 机器模式帧类型
+ */
+typedef enum
+{
+    SHELL_FRAME_OUTPUT = 0x01,                                  /**< 命令输出 */
+    SHELL_FRAME_RESULT,                                         /**< 命令结果 */
+    SHELL_FRAME_LOG,                                            /**< 尾行输出 */
+} ShellFrameType;
+
+/**
+ * @brief shell 机器模式命令结果状态
+ *        结果帧数据为 状态(1字节) 返回值(4字节，小端)
+ */
+typedef enum
+{
+    SHELL_RESULT_OK = 0,                                        /**< 命令执行完成 */
+    SHELL_RESULT_NOT_FOUND,                                     /**< 命令不存在 */
+    SHELL_RESULT_TOO_LONG,                                      /**< 命令过长 */
+    SHELL_RESULT_DENIED,                                        /**< 密码错误 */
+    SHELL_RESULT_BUSY,                                          /**< 执行队列已满 */
+} ShellResultStatus;
+#endif /** SHELL_SUPPORT_MACHINE_MODE == 1 */
+
+
+#if SHELL_SUPPORT_YIELD == 1
+/**
+ * @brief shell 可挂起命令执行状态
+ */
+typedef enum
+{
+    SHELL_YIELD_DONE = 0,                                       /**< 命令执行完成 */
+    SHELL_YIELD_RUNNING,                                        /**< 命令挂起，等待恢复执行 */
+} ShellYieldState;
+
+/**
+ * @brief shell 可挂起命令上下文
+ *        命令开始执行时清零，每次恢复执行时传入命令函数，
+ *        命令函数原型为`ShellYieldState (*)(ShellYield *yield, int argc, char *argv[])`
+ */
+typedef struct
+{
+    unsigned short line;                                        /**< 恢复执行的位置，由`SHELL_YIELD_xxx`宏维护 */
+    unsigned int tick;                                          /**< 延时计时起点 */
+    unsigned int delay;                                         /**< 延时时间，不是`SHELL_YIELD_DELAY`挂起时为0 */
+    int retVal;                                                 /**< 命令返回值 */
+    unsigned long long context[(SHELL_YIELD_CONTEXT_SIZE + 7) / 8]; /**< 命令自定义上下文 */
+} ShellYield;
+
+/**
+ * @brief shell 可挂起命令中case穿透的标记，避免`-Wimplicit-fallthrough`警告
+ */
+#if defined(__has_attribute)
+#if __has_attribute(__fallthrough__)
+#define SHELL_YIELD_FALLTHROUGH         __attribute__((__fallthrough__))
+#endif
+#endif
+#ifndef SHELL_YIELD_FALLTHROUGH
+#define SHELL_YIELD_FALLTHROUGH         do {} while (0)
+#endif
+
+/**
+ * @brief shell 可挂起命令开始，命令函数中挂起位置之前的局部变量在恢复执行后失效，
+ *        需要保留的数据存放在上下文中
+ * 
+ * @param _yield 命令上下文
+ */
+#define SHELL_YIELD_BEGIN(_yield) \
+        switch ((_yield)->line) { case 0:
+
+/**
+ * @brief shell 可挂起命令结束，返回值为`retVal`
+ * 
+ * @param _yield 命令上下文
+ */
+#define SHELL_YIELD_END(_yield) \
+        } (_yield)->line = 0; return SHELL_YIELD_DONE
+
+/**
+ * @brief shell 挂起命令，下一次恢复执行时从此处继续
+ * 
+ * @param _yield 命令上下文
+ */
+#define SHELL_YIELD(_yield) \
+        do { (_yield)->line = __LINE__; return SHELL_YIELD_RUNNING; case __LINE__:; } while (0)
+
+/**
+ * @brief shell 挂起命令直到条件成立
+ * 
+ * @param _yield 命令上下文
+ * @param _cond 条件
+ */
+#define SHELL_YIELD_UNTIL(_yield, _cond) \
+        do { (_yield)->line = __LINE__; SHELL_YIELD_FALLTHROUGH; case __LINE__: \
+            if (!(_cond)) { return SHELL_YIELD_RUNNING; } } while (0)
+
+/**
+ * @brief shell 挂起命令一段时间，需要`SHELL_GET_TICK()`有效
+ * 
+ * @param _yield 命令上下文
+ * @param _time 延时时间，单位为`SHELL_GET_TICK()`单位
+ */
+#define SHELL_YIELD_DELAY(_yield, _time) \
+        do { (_yield)->tick = SHELL_GET_TICK(); (_yield)->delay = (_time); \
+            SHELL_YIELD_UNTIL(_yield, SHELL_GET_TICK() - (_yield)->tick >= (_yield)->delay); \
+            (_yield)->delay = 0; } while (0)
+
+/**
+ * @brief shell 结束命令并设置返回值
+ * 
+ * @param _yield 命令上下文
+ * @param _value 返回值
+ */
+#define SHELL_YIELD_RETURN(_yield, _value) \
+        do { (_yield)->retVal = (_value); (_yield)->line = 0; return SHELL_YIELD_DONE; } while (0)
+
+/**
+ * @brief shell 获取命令自定义上下文
+ * 
+ * @param _yield 命令上下文
+ * @param _type 上下文类型，大小不能超过`SHELL_YIELD_CONTEXT_SIZE`
+ */
+#define SHELL_YIELD_CONTEXT(_yield, _type) \
+        ((_type *)((_yield)->context))
+#endif /** SHELL_SUPPORT_YIELD == 1 */
+
+
+/**
+ * @brief shell 参数标记
+ */
+typedef struct
+{
+    char *start;                                                /**< 参数起始位置 */
+    unsigned short length;                                      /**< 参数长度 */
+    unsigned char quoted : 1;                                   /**< 参数包含引号 */
+    unsigned char escaped : 1;                                  /**< 参数包含转义字符 */
+    unsigned char variable : 1;                                 /**< 参数包含`${name}`变量引用 */
+    unsigned char literal : 1;                                  /**< 参数以转义的`$`或者没有替换的`${`开头 */
+} ShellToken;
+
+
+/**
+ * @brief shell 命令参数
+ *        整型，`float`，指针以及字符串参数存放在`value`中，
+ *        `l`(64位整型)和`d`(`double`)类型的参数按照原始类型存放
+ */
+typedef union
+{
+    size_t value;                                               /**< 参数值 */
+    long long integer;                                          /**< 64位整型参数 */
+    double real;                                                /**< 双精度浮点参数 */
+} ShellParam;
+
+
+#if SHELL_SUPPORT_EXPRESSION == 1
+#define     SHELL_EXPR_CODE_MAX         24                      /**< 表达式程序最大指令数 */
+#define     SHELL_EXPR_STACK_MAX        12                      /**< 表达式求值栈深度 */
+#define     SHELL_EXPR_SOURCE_MAX       64                      /**< 可以缓存的表达式最大长度 */
+
+/**
+ * @brief shell 表达式指令
+ */
+typedef struct
+{
+    unsigned char op;                                           /**< 操作码 */
+    unsigned char length;                                       /**< 变量名长度 */
+    unsigned short offset;                                      /**< 变量名在表达式中的位置 */
+    union
+    {
+        long long integer;                                      /**< 整型常量 */
+        double real;                                            /**< 浮点常量 */
+    } value;
+} ShellExprCode;
+
+/**
+ * @brief shell 表达式程序
+ *        表达式编译得到的后缀形式指令序列，变量按照名字引用，求值时读取变量的当前值
+ */
+typedef struct
+{
+    unsigned int hash;                                          /**< 表达式哈希 */
+    unsigned char length;                                       /**< 表达式长度，为0时程序无效 */
+    unsigned char count;                                        /**< 指令数量 */
+    char source[SHELL_EXPR_SOURCE_MAX];                         /**< 表达式 */
+    ShellExprCode code[SHELL_EXPR_CODE_MAX];                    /**< 指令 */
+} ShellExprProgram;
+#endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+
+
+#define     SHELL_COMPANION_ID_FS           -1
+#define     SHELL_COMPANION_ID_FILE         -4
+
+#if SHELL_USING_COMPANION == 1
+/**
+ * @brief shell 文件操作接口
+ *        作为文件操作伴生对象(`SHELL_COMPANION_ID_FILE`)添加，用于命令的输入输出重定向
+ */
+typedef struct shell_file
+{
+    void *(*open)(const char *path, const char *mode);          /**< 打开文件，`mode`为"r"，"w"或"a"，失败返回NULL */
+    int (*close)(void *file);                                   /**< 关闭文件 */
+    int (*read)(void *file, char *buffer, unsigned short len);  /**< 读文件，返回读取的长度 */
+    int (*write)(void *file, const char *buffer, unsigned short len); /**< 写文件，返回写入的长度 */
+} ShellFile;
+#endif /** SHELL_USING_COMPANION == 1 */
+
+
 /**
  * @brief Shell定义
  */
@@ -403,12 +786,17 @@ typedef struct shell_def
         const struct shell_command *user;                       /**< 当前用户 */
         int activeTime;                                         /**< shell激活时间 */
         char *path;                                             /**< 当前shell路径 */
+        unsigned short width;                                   /**< 终端宽度(列)，0表示未知 */
+        unsigned short height;                                  /**< 终端高度(行)，0表示未知 */
     #if SHELL_USING_COMPANION == 1
         struct shell_companion_object *companions;              /**< 伴生对象 */
     #endif
     #if SHELL_KEEP_RETURN_VALUE == 1
         int retVal;                                             /**< 返回值 */
     #endif
+    #if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+        unsigned int endLineTime;                               /**< 尾行最后写入时间 */
+    #endif
     } info;
     struct
     {
@@ -416,6 +804,7 @@ typedef struct shell_def
         unsigned short cursor;                                  /**< 当前光标位置 */
         char *buffer;                                           /**< 输入缓冲 */
         char *param[SHELL_PARAMETER_MAX_NUMBER];                /**< 参数 */
+        ShellToken token[SHELL_PARAMETER_MAX_NUMBER];           /**< 参数标记 */
         unsigned short bufferSize;                              /**< 输入缓冲大小 */
         unsigned short paramCount;                              /**< 参数数量 */
         int keyValue;                                           /**< 输入按键键值 */
@@ -429,6 +818,100 @@ typedef struct shell_def
         signed short offset;                                    /**< 当前历史记录偏移 */
     } history;
 #endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+#if SHELL_PROMPT_BUFFER > 0
+    struct
+    {
+        char buffer[SHELL_PROMPT_BUFFER];                       /**< 命令提示符缓存 */
+        unsigned short length;                                  /**< 命令提示符长度，为0时需要重新生成 */
+    } prompt;
+#endif /** SHELL_PROMPT_BUFFER > 0 */
+#if SHELL_PIPE_BUFFER > 0
+    struct
+    {
+        char buffer[SHELL_PIPE_DEPTH][SHELL_PIPE_BUFFER];       /**< 管道缓冲，每一级管道一个 */
+        unsigned short length[SHELL_PIPE_DEPTH];                /**< 管道缓冲数据长度 */
+        unsigned short offset[SHELL_PIPE_DEPTH];                /**< 管道缓冲读取位置 */
+        struct
+        {
+            const struct shell_command *command;                /**< 读取管道缓冲的命令 */
+            ShellToken token[SHELL_PARAMETER_MAX_NUMBER];       /**< 命令参数 */
+            unsigned short paramCount;                          /**< 命令参数数量 */
+            signed short (*read)(char *, unsigned short);       /**< 命令的读函数 */
+            signed short (*write)(char *, unsigned short);      /**< 命令的写函数 */
+            int ret;                                            /**< 命令返回值 */
+            unsigned char executed : 1;                         /**< 命令已执行 */
+            unsigned char redirected : 1;                       /**< 命令输出写入管道或者文件 */
+        } stage[SHELL_PIPE_DEPTH];                              /**< 管道中第一个命令之后的命令 */
+        unsigned char depth;                                    /**< 当前语句的管道级数 */
+        unsigned char current;                                  /**< 正在执行的命令，0为管道中第一个命令 */
+    } pipe;
+#endif /** SHELL_PIPE_BUFFER > 0 */
+#if SHELL_REDIRECT_BUFFER > 0
+    struct
+    {
+        char buffer[SHELL_REDIRECT_BUFFER];                     /**< 输出重定向块缓冲 */
+        unsigned short length;                                  /**< 块缓冲数据长度 */
+        ShellFile *file;                                        /**< 文件操作接口 */
+        void *input;                                            /**< 输入重定向文件 */
+        void *output;                                           /**< 输出重定向文件 */
+        unsigned char error;                                    /**< 写文件失败，之后的输出被丢弃 */
+    } redirect;
+#endif /** SHELL_REDIRECT_BUFFER > 0 */
+#if SHELL_EXEC_QUEUE_SIZE > 0
+    struct
+    {
+        char buffer[SHELL_EXEC_QUEUE_SIZE];                     /**< 命令行队列，以0结尾的命令行依次存放 */
+        unsigned short head;                                    /**< 队列头，只由执行上下文修改 */
+        unsigned short tail;                                    /**< 队列尾，只由输入上下文修改 */
+        unsigned char enable;                                   /**< 输入的命令行加入队列 */
+        signed short (*read)(char *, unsigned short);           /**< 输入上下文使用的端口读函数 */
+        signed short (*write)(char *, unsigned short);          /**< 输入上下文使用的端口写函数 */
+        void (*notify)(struct shell_def *);                     /**< 命令行入队后调用，用于唤醒执行上下文，可以为NULL */
+    } queue;
+#endif /** SHELL_EXEC_QUEUE_SIZE > 0 */
+#if SHELL_SUPPORT_CANCEL == 1
+    struct
+    {
+        signed short (*read)(char *, unsigned short);           /**< 命令执行期间被替换的读函数 */
+        unsigned int start;                                     /**< 超时计时起点 */
+        unsigned int timeout;                                   /**< 超时时间，为0时不超时 */
+        volatile unsigned char flag;                            /**< 取消标志 */
+        char pending[SHELL_CANCEL_PENDING_SIZE];                /**< 查询取消时读取的待处理输入 */
+        unsigned short pendingLength;                           /**< 待处理输入长度 */
+    } cancel;
+#endif /** SHELL_SUPPORT_CANCEL == 1 */
+#if SHELL_SUPPORT_YIELD == 1
+    struct
+    {
+        const struct shell_command *command;                    /**< 挂起的命令 */
+        ShellYield context;                                     /**< 命令上下文 */
+        unsigned char suspend;                                  /**< 当前执行的命令允许挂起 */
+    } yield;
+#endif /** SHELL_SUPPORT_YIELD == 1 */
+#if SHELL_PARAM_ARENA_SIZE > 0
+    struct
+    {
+        unsigned long long buffer[(SHELL_PARAM_ARENA_SIZE + 7) / 8]; /**< 参数内存池 */
+        unsigned short top;                                     /**< 内存池已分配大小 */
+    } arena;
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
+#if SHELL_VAR_CACHE_SIZE > 0
+    struct
+    {
+        const struct shell_command *item[SHELL_VAR_CACHE_SIZE]; /**< 缓存的变量 */
+        const void *base;                                       /**< 缓存对应的命令表基址 */
+        const struct shell_command *user;                       /**< 缓存对应的用户 */
+        unsigned short count;                                   /**< 缓存对应的命令数量 */
+        unsigned short next;                                    /**< 下一个替换的缓存位置 */
+    } varCache;
+#endif /** SHELL_VAR_CACHE_SIZE > 0 */
+#if SHELL_SUPPORT_EXPRESSION == 1 && SHELL_EXPR_CACHE_SIZE > 0
+    struct
+    {
+        ShellExprProgram program[SHELL_EXPR_CACHE_SIZE];        /**< 缓存的表达式程序 */
+        unsigned short next;                                    /**< 下一个替换的缓存位置 */
+    } exprCache;
+#endif /** SHELL_SUPPORT_EXPRESSION == 1 && SHELL_EXPR_CACHE_SIZE > 0 */
     struct
     {
         void *base;                                             /**< 命令表基址 */
@@ -437,11 +920,30 @@ typedef struct shell_def
     struct
     {
         unsigned char isChecked : 1;                            /**< 密码校验通过 */
-        unsigned char isActive : 1;                             /**< 当前活动Shell */
         unsigned char tabFlag : 1;                              /**< tab标志 */
+    #if SHELL_SUPPORT_END_LINE == 1 && SHELL_END_LINE_REDRAW_DELAY > 0
+        unsigned char endLinePending : 1;                       /**< 尾行输出后命令行待重绘 */
+    #endif
+    #if SHELL_SUPPORT_MACHINE_MODE == 1
+        unsigned char isMachine : 1;                            /**< 机器模式 */
+        unsigned char machineOverflow : 1;                      /**< 机器模式命令过长 */
+    #endif
+        /* 以下状态可能由执行队列的执行上下文在不持有shell锁时修改，不使用位域，
+           避免与输入上下文修改的状态位互相覆盖 */
+        unsigned char isActive;                                 /**< 当前活动Shell */
+    #if SHELL_SUPPORT_MACHINE_MODE == 1
+        unsigned char escapeState;                              /**< 机器模式转义序列过滤状态 */
+    #endif
+    #if SHELL_PIPE_BUFFER > 0 || SHELL_REDIRECT_BUFFER > 0
+        unsigned char isRedirected;                             /**< 命令输出被重定向 */
+    #endif
+    #if SHELL_USING_LOCK == 1
+        unsigned char isLocked;                                 /**< 输入处理持有shell锁 */
+    #endif
     } status;
     signed short (*read)(char *, unsigned short);               /**< shell读函数 */
     signed short (*write)(char *, unsigned short);              /**< shell写函数 */
+    int (*waitInput)(unsigned int timeout);                     /**< shell等待输入函数，有输入时返回1，超时返回0 */
 #if SHELL_USING_LOCK == 1
     int (*lock)(struct shell_def *);                              /**< shell 加锁 */
     int (*unlock)(struct shell_def *);                            /**< shell 解锁 */
@@ -478,6 +980,9 @@ typedef struct shell_command
         #if SHELL_USING_FUNC_SIGNATURE == 1
             const char *signature;                              /**< 函数签名 */
         #endif
+        #if SHELL_USING_FUNC_INVOKER == 1
+            int (*invoker)(ShellParam *);                       /**< 命令调用函数 */
+        #endif
         } cmd;                                                  /**< 命令定义 */
         struct
         {
@@ -519,19 +1024,69 @@ typedef struct
 } ShellNodeVarAttr;
 
 
+#if SHELL_PROMPT_BUFFER > 0
+#define shellSetPath(_shell, _path)     ((_shell)->info.path = _path, (_shell)->prompt.length = 0)
+#else
 #define shellSetPath(_shell, _path)     (_shell)->info.path = _path
+#endif /** SHELL_PROMPT_BUFFER > 0 */
 #define shellGetPath(_shell)            ((_shell)->info.path)
+#define shellSetTerminalSize(_shell, _width, _height) \
+        ((_shell)->info.width = _width, (_shell)->info.height = _height)
 
 #define shellDeInit(shell)              shellRemove(shell)
 
-void shellInit(Shell *shell, char *buffer, unsigned short size);
+int shellInit(Shell *shell, char *buffer, unsigned short size);
 void shellRemove(Shell *shell);
+void shellForEach(void (*handler)(Shell *shell, void *param), void *param);
 unsigned short shellWriteString(Shell *shell, const char *string);
 void shellPrint(Shell *shell, const char *fmt, ...);
 void shellScan(Shell *shell, char *fmt, ...);
 Shell* shellGetCurrent(void);
+int shellWaitInput(Shell *shell, unsigned int timeout);
+#if SHELL_USING_LOCK == 1
+unsigned char shellLockRelease(Shell *shell);
+void shellLockRestore(Shell *shell, unsigned char locked);
+#endif
 void shellHandler(Shell *shell, char data);
+void shellInput(Shell *shell, const char *data, unsigned short len);
 void shellWriteEndLine(Shell *shell, char *buffer, int len);
+void shellFlush(Shell *shell);
+#if SHELL_SUPPORT_MACHINE_MODE == 1
+void shellSetMachineMode(Shell *shell, unsigned char enable);
+#endif
+#if SHELL_EXEC_QUEUE_SIZE > 0
+void shellSetExecQueue(Shell *shell, unsigned char enable);
+int shellExecQueued(Shell *shell);
+#endif
+#if SHELL_SUPPORT_CANCEL == 1
+void shellCancel(Shell *shell);
+void shellSetTimeout(Shell *shell, unsigned int timeout);
+int shellIsCancelled(void);
+#endif
+#if SHELL_SUPPORT_YIELD == 1
+int shellPoll(Shell *shell);
+#endif
+#if SHELL_SUPPORT_BACKGROUND == 1
+/**
+ * @brief shell 后台命令执行函数原型
+ * 
+ * @param shell 解析命令的shell对象
+ * @param command 命令
+ * @param argc 参数数量
+ * @param argv 参数，函数返回后失效
+ * 
+ * @return int 派发成功返回0
+ */
+typedef int (*ShellBackground)(Shell *shell, ShellCommand *command, int argc, char *argv[]);
+
+/**
+ * @brief shell 移除shell时结束后台命令的函数原型
+ * 
+ * @param shell 被移除的shell对象
+ */
+typedef void (*ShellBackgroundRemove)(Shell *shell);
+void shellSetBackground(ShellBackground handler, ShellBackgroundRemove remove);
+#endif
 void shellTask(void *param);
 int shellRun(Shell *shell, const char *cmd);
 
@@ -49,6 +49,45 @@
 #define     SHELL_SUPPORT_END_LINE      0
 #endif /** SHELL_SUPPORT_END_LINE */
 
+#ifndef SHELL_END_LINE_REDRAW_DELAY
+/**
+ * @brief 尾行模式命令行重绘延时
+ *        大于0时，连续调用`shellWriteEndLine`写入的内容会直接依次输出，命令行只在输出静默
+ *        超过此时间后，或者收到下一次按键输入时，或者调用`shellFlush()`时重绘一次
+ *        设置为0时每次写入后都立即重绘命令行，时间单位为`SHELL_GET_TICK()`单位
+ * @note 静默超时重绘依赖`SHELL_GET_TICK()`以及`shellTask()`的周期调用，
+ *       使用`waitInput`时，`shellTask()`每次等待输入最多等待此时间
+ */
+#define     SHELL_END_LINE_REDRAW_DELAY 0
+#endif /** SHELL_END_LINE_REDRAW_DELAY */
+
+#ifndef SHELL_SUPPORT_MACHINE_MODE
+/**
+ * @brief 支持shell机器模式
+ *        机器模式下，shell不回显输入，不输出命令提示符，输出内容会去除ANSI转义序列，
+ *        命令的输出和返回值都会按照带长度的帧格式输出，方便自动化程序解析
+ */
+#define     SHELL_SUPPORT_MACHINE_MODE  0
+#endif /** SHELL_SUPPORT_MACHINE_MODE */
+
+#ifndef SHELL_SUPPORT_MULTI_STATEMENT
+/**
+ * @brief 支持单行多语句
+ *        使能后，一行命令中可以使用`;`, `&&`, `||`连接多条语句，`&&`和`||`根据前一条语句的
+ *        返回值决定是否执行后面的语句，整行执行完成后只输出一次命令提示符
+ */
+#define     SHELL_SUPPORT_MULTI_STATEMENT   0
+#endif /** SHELL_SUPPORT_MULTI_STATEMENT */
+
+#ifndef SHELL_SUPPORT_BACKGROUND
+/**
+ * @brief 支持后台命令
+ *        使能后，以`&`结尾的语句会交给`shellSetBackground`设置的执行函数在后台运行，
+ *        执行函数由扩展提供(比如shell_enhance中的shell_job)
+ */
+#define     SHELL_SUPPORT_BACKGROUND    0
+#endif /** SHELL_SUPPORT_BACKGROUND */
+
 #ifndef SHELL_HELP_LIST_USER
 /**
  * @brief 是否在输出命令列表中列出用户
@@ -157,6 +196,68 @@
 #define     SHELL_MAX_NUMBER            5
 #endif /** SHELL_MAX_NUMBER */
 
+#ifndef SHELL_THREAD_LOCAL
+/**
+ * @brief 当前shell的线程局部存储修饰符
+ *        shell执行命令期间会记录当前执行命令的shell，`shellGetCurrent()`直接返回记录的shell，
+ *        多个shell在不同的线程中同时执行命令时，定义此宏为`_Thread_local`或者`__thread`，每个线程分别记录
+ *        RTOS不支持线程局部存储时，可以定义`SHELL_GET_CURRENT()`以及`SHELL_SET_CURRENT(shell)`，
+ *        使用任务局部存储记录当前shell，此时不使用此宏
+ *        为空时所有线程共用一个记录
+ */
+#define     SHELL_THREAD_LOCAL
+#endif /** SHELL_THREAD_LOCAL */
+
+#ifndef SHELL_REGISTRY_GROW
+/**
+ * @brief shell注册表是否动态扩展
+ *        shell注册表按照`SHELL_MAX_NUMBER`个shell一块进行管理，第一块静态分配，
+ *        使能此宏后，注册表满时使用`SHELL_MALLOC`分配新的一块，扩展的内存不会释放
+ *        不使能时最多注册`SHELL_MAX_NUMBER`个shell
+ */
+#define     SHELL_REGISTRY_GROW         0
+#endif /** SHELL_REGISTRY_GROW */
+
+#ifndef SHELL_ATOMIC_LOAD
+/**
+ * @brief shell原子读取指针
+ *        用于shell注册表的无锁注册，移除以及遍历，非GCC兼容的编译器可以使用关中断等方式实现
+ */
+#if defined(__GNUC__)
+#define     SHELL_ATOMIC_LOAD(ptr)      __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#else
+#define     SHELL_ATOMIC_LOAD(ptr)      (*(ptr))
+#endif
+#endif /** SHELL_ATOMIC_LOAD */
+
+#ifndef SHELL_ATOMIC_CAS
+/**
+ * @brief shell原子比较交换指针
+ *        `*ptr`等于`*expected`时写入`desired`并返回1，否则将`*ptr`读入`*expected`并返回0
+ *        非GCC兼容的编译器没有通用的实现，需要在移植时使用关中断或者编译器内置函数定义此宏
+ */
+#if defined(__GNUC__)
+#define     SHELL_ATOMIC_CAS(ptr, expected, desired) \
+            __atomic_compare_exchange_n(ptr, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#error "SHELL_ATOMIC_CAS must be defined for this compiler"
+#endif
+#endif /** SHELL_ATOMIC_CAS */
+
+#ifndef SHELL_ATOMIC_STORE
+/**
+ * @brief shell原子写入
+ *        用于执行队列的读写位置，写入之前的数据需要先于写入的值对其他线程可见
+ */
+#if defined(__GNUC__)
+#define     SHELL_ATOMIC_STORE(ptr, value) \
+            __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#else
+#define     SHELL_ATOMIC_STORE(ptr, value) \
+            (*(ptr) = (value))
+#endif
+#endif /** SHELL_ATOMIC_STORE */
+
 #ifndef SHELL_PRINT_BUFFER
 /**
  * @brief shell格式化输出的缓冲大小
@@ -165,6 +266,110 @@
 #define     SHELL_PRINT_BUFFER          128
 #endif /** SHELL_PRINT_BUFFER */
 
+#ifndef SHELL_PROMPT_BUFFER
+/**
+ * @brief shell命令提示符缓冲大小
+ *        大于0时，shell会将用户名和路径组合成的命令提示符缓存起来，只在用户，路径或者锁定状态改变时重新生成，
+ *        输出提示符时只需要写入一次，提示符长度超过缓冲大小时，按照不缓存的方式输出
+ *        为0时不缓存命令提示符
+ */
+#define     SHELL_PROMPT_BUFFER         0
+#endif /** SHELL_PROMPT_BUFFER */
+
+#ifndef SHELL_PIPE_BUFFER
+/**
+ * @brief shell管道缓冲大小
+ *        大于0时，支持使用`cmd1 | cmd2`将前一个命令的输出作为后一个命令的输入，
+ *        前一个命令通过`shell->write`的输出写入管道缓冲，后一个命令通过`shell->read`读取，
+ *        管道缓冲写满时暂停前一个命令，先使用缓冲中的数据执行后一个命令，然后继续写入
+ *        为0时不支持管道
+ */
+#define     SHELL_PIPE_BUFFER           0
+#endif /** SHELL_PIPE_BUFFER */
+
+#ifndef SHELL_PIPE_DEPTH
+/**
+ * @brief shell管道最大级数
+ *        一条语句中最多可以使用的`|`数量，每一级管道占用一个`SHELL_PIPE_BUFFER`大小的缓冲
+ */
+#define     SHELL_PIPE_DEPTH            2
+#endif /** SHELL_PIPE_DEPTH */
+
+#ifndef SHELL_REDIRECT_BUFFER
+/**
+ * @brief shell重定向缓冲大小
+ *        大于0时，支持使用`cmd > file`，`cmd >> file`以及`cmd < file`重定向命令的输入输出，
+ *        文件通过文件操作伴生对象(`SHELL_COMPANION_ID_FILE`)的`ShellFile`接口操作，
+ *        命令的输出先写入块缓冲，缓冲满或者命令结束时整块写入文件，需要使能`SHELL_USING_COMPANION`
+ *        为0时不支持重定向
+ */
+#define     SHELL_REDIRECT_BUFFER       0
+#endif /** SHELL_REDIRECT_BUFFER */
+
+#ifndef SHELL_EXEC_QUEUE_SIZE
+/**
+ * @brief shell命令行执行队列大小
+ *        大于0时，输入处理和命令执行分离，`shellHandler`只负责行编辑和回显，
+ *        输入完成的命令行加入执行队列，由执行上下文调用`shellExecQueued`执行，
+ *        命令执行期间可以继续输入，尾行输出也不需要等待命令执行完成
+ *        为0时在`shellHandler`中直接执行命令
+ */
+#define     SHELL_EXEC_QUEUE_SIZE       0
+#endif /** SHELL_EXEC_QUEUE_SIZE */
+
+#ifndef SHELL_SUPPORT_CANCEL
+/**
+ * @brief 支持取消正在执行的命令
+ *        使能后，命令执行期间输入`SHELL_CANCEL_KEY`或者命令超时会设置取消标志，
+ *        命令通过`shellIsCancelled()`查询，`shellScan`等阻塞读取的接口在取消后返回
+ */
+#define     SHELL_SUPPORT_CANCEL        0
+#endif /** SHELL_SUPPORT_CANCEL */
+
+#ifndef SHELL_CANCEL_KEY
+/**
+ * @brief 取消命令的按键键值，单字节，默认为Ctrl + C
+ *        命令执行期间，读取到的该键值会被过滤，不会传递给命令
+ */
+#define     SHELL_CANCEL_KEY            0x03
+#endif /** SHELL_CANCEL_KEY */
+
+#ifndef SHELL_CANCEL_PENDING_SIZE
+/**
+ * @brief 查询取消时保存的待处理输入长度
+ *        `shellIsCancelled`会读取命令没有读取的输入检查取消按键，其他输入保存后交给命令或者`shellTask`，
+ *        超出长度时丢弃最早的输入
+ */
+#define     SHELL_CANCEL_PENDING_SIZE   16
+#endif /** SHELL_CANCEL_PENDING_SIZE */
+
+#ifndef SHELL_CANCEL_TIMEOUT
+/**
+ * @brief 命令默认超时时间
+ *        每一行命令开始执行时设置，命令可以通过`shellSetTimeout`修改，
+ *        设置为0时不超时，时间单位为`SHELL_GET_TICK()`单位
+ * @note 使用超时必须保证`SHELL_GET_TICK()`有效
+ */
+#define     SHELL_CANCEL_TIMEOUT        0
+#endif /** SHELL_CANCEL_TIMEOUT */
+
+#ifndef SHELL_SUPPORT_YIELD
+/**
+ * @brief 支持可挂起命令(`SHELL_TYPE_CMD_YIELD`)
+ *        命令挂起后由`shellTask`或者`shellPoll`周期恢复执行，命令执行期间不阻塞主循环，
+ *        适用于没有操作系统的单线程环境
+ */
+#define     SHELL_SUPPORT_YIELD         0
+#endif /** SHELL_SUPPORT_YIELD */
+
+#ifndef SHELL_YIELD_CONTEXT_SIZE
+/**
+ * @brief 可挂起命令的自定义上下文大小(字节)
+ *        用于保存命令挂起期间需要保留的数据
+ */
+#define     SHELL_YIELD_CONTEXT_SIZE    32
+#endif /** SHELL_YIELD_CONTEXT_SIZE */
+
 #ifndef SHELL_SCAN_BUFFER
 /**
  * @brief shell格式化输入的缓冲大小
@@ -246,6 +451,18 @@
 #define     SHELL_LOCK_TIMEOUT          0 * 60 * 1000
 #endif /** SHELL_LOCK_TIMEOUT */
 
+#ifndef SHELL_EXT_DECIMAL_DIGITS
+/**
+ * @brief 浮点数参数转换的十进制高精度数最大有效数字个数
+ *        尾数超过2^53或者指数较大的浮点数参数使用十进制高精度数转换，
+ *        转换时在调用者的栈上占用约`SHELL_EXT_DECIMAL_DIGITS + 32`字节，
+ *        默认值对常见的输入(比如`%.17g`格式化的double)正确舍入，有效数字很多或者非常接近
+ *        两个double中点的输入可能相差1ulp，设置为800时所有输入都正确舍入(约占用830字节栈)，
+ *        不能小于64
+ */
+#define     SHELL_EXT_DECIMAL_DIGITS    64
+#endif /** SHELL_EXT_DECIMAL_DIGITS */
+
 #ifndef SHELL_USING_FUNC_SIGNATURE
 /**
  * @brief 使用函数签名
@@ -255,6 +472,16 @@
 #define     SHELL_USING_FUNC_SIGNATURE  0
 #endif /** SHELL_USING_FUNC_SIGNATURE */
 
+#ifndef SHELL_USING_FUNC_INVOKER
+/**
+ * @brief 使用命令调用函数
+ *        使能后，可以使用`SHELL_EXPORT_CMD_TYPED()`导出命令，导出时会为命令生成调用函数，
+ *        shell 执行命令时通过调用函数，以正确的参数类型和数量直接调用命令函数
+ *        需要使能 `SHELL_USING_FUNC_SIGNATURE` 宏
+ */
+#define     SHELL_USING_FUNC_INVOKER    0
+#endif /** SHELL_USING_FUNC_INVOKER */
+
 #ifndef SHELL_SUPPORT_ARRAY_PARAM
 /**
  * @brief 支持数组参数
@@ -264,4 +491,52 @@
 #define     SHELL_SUPPORT_ARRAY_PARAM   0
 #endif /** SHELL_SUPPORT_ARRAY_PARAM */
 
+#ifndef SHELL_PARAM_ARENA_SIZE
+/**
+ * @brief 参数内存池大小
+ *        大于0时，每个shell对象包含一个参数内存池，数组参数以及自定义参数解析器可以从内存池中分配内存，
+ *        内存池在每次命令执行完成后整体释放，内存池空间不足时，数组参数会使用`SHELL_MALLOC`分配内存
+ *        为0时不使用参数内存池，最大为65535
+ */
+#define     SHELL_PARAM_ARENA_SIZE      0
+#endif /** SHELL_PARAM_ARENA_SIZE */
+
+#ifndef SHELL_VAR_CACHE_SIZE
+/**
+ * @brief 变量查找缓存大小
+ *        大于0时，`$name`参数查找到的变量会缓存在shell对象中，重复引用同一个变量时不需要遍历命令表，
+ *        命令表或者当前用户改变时缓存自动失效
+ *        为0时不使用缓存
+ */
+#define     SHELL_VAR_CACHE_SIZE        0
+#endif /** SHELL_VAR_CACHE_SIZE */
+
+#ifndef SHELL_SUPPORT_VAR_EXPAND
+/**
+ * @brief 是否支持字符串中的变量替换
+ *        使能后，参数中的`${name}`会在分割参数时替换为变量的值，替换后的参数存放在参数内存池中，
+ *        需要配置`SHELL_PARAM_ARENA_SIZE`
+ */
+#define     SHELL_SUPPORT_VAR_EXPAND    0
+#endif /** SHELL_SUPPORT_VAR_EXPAND */
+
+#ifndef SHELL_SUPPORT_EXPRESSION
+/**
+ * @brief 是否支持表达式参数
+ *        使能后，数值参数可以使用包含`$var`，四则运算，移位，位运算以及括号的表达式，比如`$base+0x40*4`，
+ *        表达式编译为后缀形式的程序后求值，求值过程不分配内存
+ */
+#define     SHELL_SUPPORT_EXPRESSION    0
+#endif /** SHELL_SUPPORT_EXPRESSION */
+
+#ifndef SHELL_EXPR_CACHE_SIZE
+/**
+ * @brief 表达式缓存数量
+ *        大于0时，编译得到的表达式程序按照表达式的哈希缓存在shell对象中，
+ *        重复执行同一个表达式时不需要重新解析，长度超过`SHELL_EXPR_SOURCE_MAX`的表达式不缓存
+ *        为0时不缓存
+ */
+#define     SHELL_EXPR_CACHE_SIZE       0
+#endif /** SHELL_EXPR_CACHE_SIZE */
+
 #endif
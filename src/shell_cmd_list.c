@@ -31,6 +31,9 @@ extern void shellClear(void);
 #if SHELL_EXEC_UNDEF_FUNC == 1
 extern int shellExecute(int argc, char *argv[]);
 #endif
+#if SHELL_PIPE_BUFFER > 0
+extern int shellGrep(int argc, char *argv[]);
+#endif
 
 SHELL_AGENCY_FUNC(shellRun, shellGetCurrent(), (const char *)p1);
 
@@ -90,6 +93,10 @@ const ShellCommand shellCommandList[] =
     SHELL_CMD_ITEM(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
                    exec, shellExecute, execute function undefined),
 #endif
+#if SHELL_PIPE_BUFFER > 0
+    SHELL_CMD_ITEM(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                   grep, shellGrep, print lines matching a pattern),
+#endif
 };
 
 
@@ -13,17 +13,20 @@
 #include "shell.h"
 #include "shell_ext.h"
 #include "string.h"
+#include "float.h"
 
 extern ShellCommand* shellSeekCommand(Shell *shell,
                                       const char *cmd,
                                       ShellCommand *base,
                                       unsigned short compareLength);
 extern int shellGetVarValue(Shell *shell, ShellCommand *command);
+extern ShellCommand* shellSeekVar(Shell *shell, const char *name);
+extern int shellTokenize(char *string, unsigned short strLen, ShellToken *tokens, short maxNum, char splitKey);
+extern unsigned short shellTokenizeNext(char *string, unsigned short strLen, ShellToken *token, char splitKey);
 
+static int shellExtParseToken(Shell *shell, ShellToken *token, char *type, ShellParam *result);
 #if SHELL_SUPPORT_ARRAY_PARAM == 1
-extern int shellSplit(char *string, unsigned short strLen, char *array[], char splitKey, short maxNum);
-
-static int shellExtParseArray(Shell *shell, char *string, char *type, size_t *result);
+static int shellExtParseArray(Shell *shell, ShellToken *token, char *type, size_t *result);
 static int shellExtCleanerArray(Shell *shell, char *type, void *param);
 #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
 
@@ -41,7 +44,7 @@ static int shellGetNextParamType(const char *signature, int index, char *type)
 {
     const char *p = signature + index;
 #if SHELL_SUPPORT_ARRAY_PARAM == 1
-    if (*p == '[')
+    while (*p == '[')
     {
         *type++ = *p++;
         index++;
@@ -81,7 +84,7 @@ static int shellGetParamNumExcept(const char *signature)
     while (*p)
     {
     #if SHELL_SUPPORT_ARRAY_PARAM == 1
-        if (*p == '[')
+        while (*p == '[')
         {
             p++;
         }
@@ -105,313 +108,1574 @@ static int shellGetParamNumExcept(const char *signature)
 #endif
 
 /**
- * @brief 判断数字进制
+ * @brief 数字字符表
+ *        ASCII字符对应的数值，非数字字符为0xFF
+ */
+static const unsigned char shellExtDigitTable[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/**
+ * @brief 10的幂次表
+ *        1e22以内的10的幂次都可以用double精确表示
+ */
+static const double shellExtPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+
+/**
+ * @brief 获取字符对应的数值
  * 
- * @param string 参数字符串
- * @return ShellNumType 进制
+ * @param code 字符
+ * @return unsigned char 数值，非数字字符返回0xFF
  */
-static ShellNumType shellExtNumType(char *string)
+static unsigned char shellExtDigit(char code)
 {
-    char *p = string;
-    ShellNumType type = NUM_TYPE_DEC;
+    return ((unsigned char) code < 128) ? shellExtDigitTable[(unsigned char) code] : 0xFF;
+}
 
-    if ((*p == '0') && ((*(p + 1) == 'x') || (*(p + 1) == 'X')))
+
+/**
+ * @brief 转义字符转换
+ * 
+ * @param code 转义字符(`\\`之后的字符)
+ * @return char 转换后的字符
+ */
+char shellExtEscapeChar(char code)
+{
+    switch (code)
     {
-        type = NUM_TYPE_HEX;
+    case 'b':
+        return '\b';
+    case 'r':
+        return '\r';
+    case 'n':
+        return '\n';
+    case 't':
+        return '\t';
+    case '0':
+        return 0;
+    default:
+        return code;
     }
-    else if ((*p == '0') && ((*(p + 1) == 'b') || (*(p + 1) == 'B')))
+}
+
+
+/**
+ * @brief 解析字符参数
+ *        转义字符已经在参数分割时处理
+ * 
+ * @param string 字符串参数
+ * @return char 解析出的字符
+ */
+static char shellExtParseChar(char *string)
+{
+    return (*string == '\'') ? *(string + 1) : *string;
+}
+
+
+#if (DBL_MANT_DIG == 53) && (DBL_MAX_EXP == 1024)
+#if SHELL_EXT_DECIMAL_DIGITS < 64
+#error "SHELL_EXT_DECIMAL_DIGITS must be at least 64"
+#endif
+
+/**
+ * @brief 十进制浮点数转换每次移位的最大位数
+ */
+#define SHELL_EXT_DECIMAL_SHIFT     56
+
+/**
+ * @brief 十进制高精度数
+ *        数值为 0.digit[0]digit[1]... * 10^point，
+ *        `SHELL_EXT_DECIMAL_DIGITS`为800时足以精确表示任意两个相邻double之间的中点
+ */
+typedef struct
+{
+    unsigned char digit[SHELL_EXT_DECIMAL_DIGITS + 20];     /**< 数字，高位在前，多出的空间用于左移 */
+    int count;                                              /**< 数字个数 */
+    int point;                                              /**< 小数点位置 */
+    unsigned char truncated;                                /**< 丢弃了非0的低位数字 */
+} ShellExtDecimal;
+
+
+/**
+ * @brief 去掉十进制高精度数末尾的0
+ * 
+ * @param decimal 十进制高精度数
+ */
+static void shellExtDecimalTrim(ShellExtDecimal *decimal)
+{
+    while (decimal->count > 0 && decimal->digit[decimal->count - 1] == 0)
     {
-        type = NUM_TYPE_BIN;
+        decimal->count--;
     }
-    else if (*p == '0')
+    if (decimal->count == 0)
     {
-        type = NUM_TYPE_OCT;
+        decimal->point = 0;
     }
-    
-    while (*p++)
+}
+
+
+/**
+ * @brief 读取十进制数字到高精度数
+ *        字符串已经经过`shellExtParseDecimal`校验
+ * 
+ * @param decimal 十进制高精度数
+ * @param string 数字字符串(不包含符号)
+ */
+static void shellExtDecimalRead(ShellExtDecimal *decimal, const char *string)
+{
+    const char *p = string;
+    unsigned char digit;
+    unsigned char fraction = 0;
+
+    decimal->count = 0;
+    decimal->point = 0;
+    decimal->truncated = 0;
+    for (; *p; p++)
+    {
+        if (*p == '_' || *p == '.')
+        {
+            fraction |= (*p == '.');
+            continue;
+        }
+        if ((digit = shellExtDigit(*p)) >= 10)
+        {
+            break;
+        }
+        if (digit == 0 && decimal->count == 0)
+        {
+            decimal->point -= fraction;
+            continue;
+        }
+        decimal->point += !fraction;
+        if (decimal->count < SHELL_EXT_DECIMAL_DIGITS)
+        {
+            decimal->digit[decimal->count++] = digit;
+        }
+        else if (digit != 0)
+        {
+            decimal->truncated = 1;
+        }
+    }
+    if (*p == 'e' || *p == 'E')
+    {
+        signed char sign = 1;
+        int value = 0;
+        p++;
+        if (*p == '-' || *p == '+')
+        {
+            sign = (*p++ == '-') ? -1 : 1;
+        }
+        for (; (digit = shellExtDigit(*p)) < 10; p++)
+        {
+            if (value < 10000)
+            {
+                value = value * 10 + digit;
+            }
+        }
+        decimal->point += sign * value;
+    }
+    shellExtDecimalTrim(decimal);
+}
+
+
+/**
+ * @brief 十进制高精度数右移(除以2^bits)
+ * 
+ * @param decimal 十进制高精度数
+ * @param bits 移位位数，不超过`SHELL_EXT_DECIMAL_SHIFT`
+ */
+static void shellExtDecimalShiftRight(ShellExtDecimal *decimal, unsigned char bits)
+{
+    unsigned long long mask = (1ULL << bits) - 1;
+    unsigned long long n = 0;
+    unsigned char digit;
+    int read = 0;
+    int write = 0;
+
+    for (; (n >> bits) == 0; read++)
     {
-        if (*p == '.' && *(p + 1) != 0)
+        if (read >= decimal->count)
         {
-            type = NUM_TYPE_FLOAT;
+            if (n == 0)
+            {
+                decimal->count = 0;
+                return;
+            }
+            while ((n >> bits) == 0)
+            {
+                n *= 10;
+                read++;
+            }
             break;
         }
+        n = n * 10 + decimal->digit[read];
+    }
+    decimal->point -= read - 1;
+
+    for (; read < decimal->count; read++)
+    {
+        digit = decimal->digit[read];
+        decimal->digit[write++] = (unsigned char) (n >> bits);
+        n = (n & mask) * 10 + digit;
+    }
+    while (n > 0)
+    {
+        if (write < SHELL_EXT_DECIMAL_DIGITS)
+        {
+            decimal->digit[write++] = (unsigned char) (n >> bits);
+        }
+        else if ((n >> bits) != 0)
+        {
+            decimal->truncated = 1;
+        }
+        n = (n & mask) * 10;
     }
+    decimal->count = write;
+    shellExtDecimalTrim(decimal);
+}
+
+
+/**
+ * @brief 十进制高精度数左移(乘以2^bits)
+ * 
+ * @param decimal 十进制高精度数
+ * @param bits 移位位数，不超过`SHELL_EXT_DECIMAL_SHIFT`
+ */
+static void shellExtDecimalShiftLeft(ShellExtDecimal *decimal, unsigned char bits)
+{
+    int delta = ((bits * 1233) >> 12) + 1;
+    int read = decimal->count - 1;
+    int write = decimal->count + delta - 1;
+    unsigned long long n = 0;
 
-    return type;
+    if (decimal->count == 0)
+    {
+        return;
+    }
+    for (; read >= 0; read--)
+    {
+        n += (unsigned long long) decimal->digit[read] << bits;
+        decimal->digit[write--] = (unsigned char) (n % 10);
+        n /= 10;
+    }
+    for (; n > 0; n /= 10)
+    {
+        decimal->digit[write--] = (unsigned char) (n % 10);
+    }
+    write++;
+    decimal->count += delta - write;
+    decimal->point += delta - write;
+    memmove(decimal->digit, decimal->digit + write, decimal->count);
+    for (; decimal->count > SHELL_EXT_DECIMAL_DIGITS; decimal->count--)
+    {
+        decimal->truncated |= (decimal->digit[decimal->count - 1] != 0);
+    }
+    shellExtDecimalTrim(decimal);
 }
 
 
 /**
- * @brief 字符转数字
+ * @brief 十进制高精度数移位
  * 
- * @param code 字符
- * @return char 数字
+ * @param decimal 十进制高精度数
+ * @param bits 移位位数，正数左移，负数右移
+ */
+static void shellExtDecimalShift(ShellExtDecimal *decimal, int bits)
+{
+    for (; bits > SHELL_EXT_DECIMAL_SHIFT; bits -= SHELL_EXT_DECIMAL_SHIFT)
+    {
+        shellExtDecimalShiftLeft(decimal, SHELL_EXT_DECIMAL_SHIFT);
+    }
+    for (; bits < -SHELL_EXT_DECIMAL_SHIFT; bits += SHELL_EXT_DECIMAL_SHIFT)
+    {
+        shellExtDecimalShiftRight(decimal, SHELL_EXT_DECIMAL_SHIFT);
+    }
+    if (bits > 0)
+    {
+        shellExtDecimalShiftLeft(decimal, (unsigned char) bits);
+    }
+    else if (bits < 0)
+    {
+        shellExtDecimalShiftRight(decimal, (unsigned char) -bits);
+    }
+}
+
+
+/**
+ * @brief 十进制高精度数舍入为整数
+ *        四舍六入五成双
+ * 
+ * @param decimal 十进制高精度数，整数部分不超过2^63
+ * @return unsigned long long 整数
  */
-static char shellExtToNum(char code)
+static unsigned long long shellExtDecimalRound(ShellExtDecimal *decimal)
 {
-    if ((code >= '0') && (code <= '9'))
+    unsigned long long value = 0;
+    int point = decimal->point;
+    int i;
+
+    for (i = 0; i < point; i++)
+    {
+        value = value * 10 + ((i < decimal->count) ? decimal->digit[i] : 0);
+    }
+    if (point >= 0 && point < decimal->count)
     {
-        return code -'0';
+        if (decimal->digit[point] == 5 && point + 1 == decimal->count)
+        {
+            value += decimal->truncated || (point > 0 && (decimal->digit[point - 1] & 1));
+        }
+        else
+        {
+            value += (decimal->digit[point] >= 5);
+        }
     }
-    else if ((code >= 'a') && (code <= 'f'))
+    return value;
+}
+
+
+/**
+ * @brief 十进制数字转换为正确舍入的double
+ *        通过十进制高精度数的二进制移位得到尾数，不依赖浮点运算的精度，
+ *        可以正确处理非规格化数以及接近DBL_MAX的数值
+ * 
+ * @param string 数字字符串(不包含符号)
+ * @return double 浮点数值，溢出时为无穷大
+ */
+static double shellExtDecimalToReal(const char *string)
+{
+    static const unsigned char shift[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    ShellExtDecimal decimal;
+    unsigned long long mantissa = 0;
+    unsigned long long bits;
+    int exponent = 0;
+    int n;
+    double value;
+
+    shellExtDecimalRead(&decimal, string);
+    if (decimal.count == 0 || decimal.point < -330)
     {
-        return code - 'a' + 10;
+        exponent = -1023;
     }
-    else if ((code >= 'A') && (code <= 'F'))
+    else if (decimal.point > 310)
     {
-        return code - 'A' + 10;
+        exponent = 1024;
     }
     else
     {
-        return 0;
+        /* 缩放到[0.5, 1) */
+        while (decimal.point > 0)
+        {
+            n = (decimal.point < (int) sizeof(shift)) ? shift[decimal.point] : 27;
+            shellExtDecimalShift(&decimal, -n);
+            exponent += n;
+        }
+        while (decimal.point < 0 || (decimal.point == 0 && decimal.digit[0] < 5))
+        {
+            n = (-decimal.point < (int) sizeof(shift)) ? shift[-decimal.point] : 27;
+            shellExtDecimalShift(&decimal, n);
+            exponent -= n;
+        }
+        exponent--;
+        if (exponent < -1022)
+        {
+            shellExtDecimalShift(&decimal, exponent + 1022);
+            exponent = -1022;
+        }
+        if (exponent < 1024)
+        {
+            shellExtDecimalShift(&decimal, 53);
+            mantissa = shellExtDecimalRound(&decimal);
+            if (mantissa == (1ULL << 53))
+            {
+                mantissa >>= 1;
+                exponent++;
+            }
+            if ((mantissa & (1ULL << 52)) == 0)
+            {
+                exponent = -1023;
+            }
+        }
     }
+    if (exponent >= 1024)
+    {
+        exponent = 1024;
+        mantissa = 0;
+    }
+    bits = (mantissa & ((1ULL << 52) - 1))
+         | ((unsigned long long) (exponent + 1023) << 52);
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
+#endif /** (DBL_MANT_DIG == 53) && (DBL_MAX_EXP == 1024) */
 
 
 /**
- * @brief 解析字符参数
+ * @brief 计算浮点数值
+ *        尾数不超过2^53并且指数不超过22时，只需要一次正确舍入的乘除法，
+ *        其余情况使用十进制高精度数转换，保证结果正确舍入
  * 
- * @param string 字符串参数
- * @return char 解析出的字符
+ * @param string 数字字符串(不包含符号)
+ * @param mantissa 十进制尾数
+ * @param exponent 十进制指数
+ * @param exact 尾数包含了全部有效数字
+ * @return double 浮点数值
  */
-static char shellExtParseChar(char *string)
+static double shellExtToReal(const char *string,
+                             unsigned long long mantissa, int exponent, unsigned char exact)
+{
+    double value = (double) mantissa;
+
+    if (mantissa == 0)
+    {
+        return 0.0;
+    }
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+    if (exact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+#else
+    /* 以更高精度计算double时(比如x87)，乘除法的结果会经过两次舍入，只使用不需要舍入的整数 */
+    if (exact && mantissa <= (1ULL << 53) && exponent == 0)
+#endif
+    {
+        return exponent < 0 ? value / shellExtPow10[-exponent] : value * shellExtPow10[exponent];
+    }
+#if (DBL_MANT_DIG == 53) && (DBL_MAX_EXP == 1024)
+    return shellExtDecimalToReal(string);
+#else
+    while (exponent > 22)
+    {
+        value *= shellExtPow10[22];
+        exponent -= 22;
+    }
+    while (exponent < -22)
+    {
+        value /= shellExtPow10[22];
+        exponent += 22;
+    }
+    return exponent < 0 ? value / shellExtPow10[-exponent] : value * shellExtPow10[exponent];
+#endif
+}
+
+
+/**
+ * @brief 解析十进制数字，包括浮点数
+ * 
+ * @param string 数字字符串(不包含符号)
+ * @param number 解析结果
+ * 
+ * @return int 0 解析成功 -1 格式错误 -2 数值溢出
+ */
+static int shellExtParseDecimal(const char *string, ShellNumber *number)
 {
-    char *p = (*string == '\'') ? (string + 1) : string;
-    char value = 0;
+    const char *p = string;
+    unsigned long long mantissa = 0;
+    unsigned char digit;
+    unsigned char overflow = 0;
+    unsigned short digits = 0;
+    int exponent = 0;
 
-    if (*p == '\\')
+    for (; *p; p++)
     {
-        switch (*(p + 1))
+        if ((digit = shellExtDigit(*p)) >= 10)
         {
-        case 'b':
-            value = '\b';
-            break;
-        case 'r':
-            value = '\r';
-            break;
-        case 'n':
-            value = '\n';
-            break;
-        case 't':
-            value = '\t';
-            break;
-        case '0':
-            value = 0;
-            break;
-        default:
-            value = *(p + 1);
+            if (*p == '_' && digits > 0)
+            {
+                continue;
+            }
             break;
         }
+        if (digits < 19 || mantissa < ~0ULL / 10
+            || (mantissa == ~0ULL / 10 && digit <= ~0ULL % 10))
+        {
+            mantissa = mantissa * 10 + digit;
+        }
+        else
+        {
+            overflow = 1;
+            exponent++;
+        }
+        digits++;
+    }
+
+    if (*p == '.')
+    {
+        number->type = NUM_TYPE_FLOAT;
+        for (p++; *p; p++)
+        {
+            if ((digit = shellExtDigit(*p)) >= 10)
+            {
+                break;
+            }
+            if (digits < 19 || mantissa < ~0ULL / 10
+                || (mantissa == ~0ULL / 10 && digit <= ~0ULL % 10))
+            {
+                mantissa = mantissa * 10 + digit;
+                exponent--;
+            }
+            else
+            {
+                overflow = 1;
+            }
+            digits++;
+        }
+    }
+    if (digits == 0)
+    {
+        return -1;
+    }
+
+    if (*p == 'e' || *p == 'E')
+    {
+        signed char sign = 1;
+        int value = 0;
+        number->type = NUM_TYPE_FLOAT;
+        p++;
+        if (*p == '-' || *p == '+')
+        {
+            sign = (*p++ == '-') ? -1 : 1;
+        }
+        if (shellExtDigit(*p) >= 10)
+        {
+            return -1;
+        }
+        for (; (digit = shellExtDigit(*p)) < 10; p++)
+        {
+            if (value < 10000)
+            {
+                value = value * 10 + digit;
+            }
+        }
+        exponent += sign * value;
+    }
+
+    if (*p != 0)
+    {
+        return -1;
+    }
+
+    if (number->type == NUM_TYPE_FLOAT)
+    {
+        number->real = shellExtToReal(string, mantissa, exponent, !overflow);
+        if (number->real > DBL_MAX)
+        {
+            return -2;
+        }
+        if (number->negative)
+        {
+            number->real = -number->real;
+        }
+        return 0;
+    }
+    number->integer = mantissa;
+    return overflow ? -2 : 0;
+}
+
+
+/**
+ * @brief 解析数字
+ *        支持十进制，十六进制(0x)，二进制(0b)，八进制(0)，十进制浮点数以及指数形式，
+ *        数字之间可以使用`_`分隔
+ * 
+ * @param string 数字字符串
+ * @param number 解析结果
+ * 
+ * @return int 0 解析成功 -1 格式错误 -2 数值溢出
+ */
+int shellExtParseNum(const char *string, ShellNumber *number)
+{
+    const char *p = string;
+    unsigned char radix = 10;
+    unsigned char shift = 0;
+    unsigned char digit;
+    unsigned short digits = 0;
+    unsigned long long value = 0;
+
+    number->type = NUM_TYPE_DEC;
+    number->negative = 0;
+    number->integer = 0;
+    number->real = 0.0;
+
+    if (*p == '-' || *p == '+')
+    {
+        number->negative = (*p++ == '-');
+    }
+
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        number->type = NUM_TYPE_HEX;
+        radix = 16;
+        shift = 4;
+        p += 2;
+    }
+    else if (p[0] == '0' && (p[1] == 'b' || p[1] == 'B'))
+    {
+        number->type = NUM_TYPE_BIN;
+        radix = 2;
+        shift = 1;
+        p += 2;
+    }
+    else if (p[0] == '0' && shellExtDigit(p[1]) < 10)
+    {
+        const char *q = p;
+        while (shellExtDigit(*q) < 10 || *q == '_')
+        {
+            q++;
+        }
+        if (*q == 0)
+        {
+            number->type = NUM_TYPE_OCT;
+            radix = 8;
+            shift = 3;
+            p++;
+        }
+    }
+
+    if (radix == 10)
+    {
+        return shellExtParseDecimal(p, number);
+    }
+
+    for (; *p; p++)
+    {
+        if ((digit = shellExtDigit(*p)) >= radix)
+        {
+            if (*p == '_' && digits > 0)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if ((value >> (64 - shift)) != 0)
+        {
+            return -2;
+        }
+        value = (value << shift) | digit;
+        digits++;
+    }
+    if (digits == 0)
+    {
+        return -1;
+    }
+    number->integer = value;
+    return 0;
+}
+
+
+/**
+ * @brief 数字转换为整型
+ * 
+ * @param number 数字
+ * @param bytes 整型宽度
+ * @param value 转换结果(补码)
+ * 
+ * @return int 0 转换成功 -2 数值超出整型范围
+ */
+static int shellExtNumberToInteger(ShellNumber *number, unsigned char bytes, unsigned long long *value)
+{
+    unsigned long long magnitude = number->integer;
+    unsigned char negative = number->negative;
+    unsigned long long max;
+
+    if (number->type == NUM_TYPE_FLOAT)
+    {
+        double real = number->real;
+        negative = real < 0;
+        if (negative)
+        {
+            real = -real;
+        }
+        if (real >= 18446744073709551616.0)
+        {
+            return -2;
+        }
+        magnitude = (unsigned long long) real;
+    }
+
+    max = (bytes >= sizeof(unsigned long long)) ? ~0ULL : (1ULL << (bytes * 8)) - 1;
+    if (negative ? (magnitude > (max >> 1) + 1) : (magnitude > max))
+    {
+        return -2;
+    }
+    *value = negative ? 0 - magnitude : magnitude;
+    return 0;
+}
+
+
+/**
+ * @brief 数字转换为浮点型
+ * 
+ * @param number 数字
+ * 
+ * @return double 浮点数值
+ */
+static double shellExtNumberToReal(ShellNumber *number)
+{
+    if (number->type == NUM_TYPE_FLOAT)
+    {
+        return number->real;
+    }
+    return number->negative ? -(double) number->integer : (double) number->integer;
+}
+
+
+/**
+ * @brief 判断浮点数转换为float时是否溢出
+ *        比FLT_MAX大不到半个最小精度的数值会舍入为FLT_MAX，不算溢出
+ * 
+ * @param real 浮点数值
+ * 
+ * @return int 1 溢出 0 不溢出
+ */
+static int shellExtFloatOverflow(double real)
+{
+#if (FLT_MANT_DIG == 24) && (FLT_MAX_EXP == 128)
+    const double limit = 3.4028235677973366e38;     /* 2^128 - 2^103 */
+    return real >= limit || real <= -limit;
+#else
+    return real > FLT_MAX || real < -FLT_MAX;
+#endif
+}
+
+
+/**
+ * @brief 获取整型参数类型的宽度
+ * 
+ * @param type 参数类型
+ * 
+ * @return unsigned char 宽度，自动类型以及指针为`size_t`的宽度
+ */
+static unsigned char shellExtIntegerBytes(char type)
+{
+    switch (type)
+    {
+    case 'c':
+    case 'q':
+        return sizeof(char);
+    case 'h':
+        return sizeof(short);
+    case 'i':
+        return sizeof(int);
+    case 'l':
+        return sizeof(long long);
+    default:
+        return sizeof(size_t);
+    }
+}
+
+
+/**
+ * @brief 数字转换为参数值
+ * 
+ * @param number 数字
+ * @param type 参数类型，`f`为float，`d`为double，`q`, `h`, `i`, `l`, `p`为对应宽度的整型，0为自动类型
+ * @param result 参数值
+ * 
+ * @return int 0 转换成功 -2 数值超出参数类型范围
+ */
+static int shellExtNumberToParam(ShellNumber *number, char type, ShellParam *result)
+{
+    unsigned long long value;
+
+    if (type == 'd')
+    {
+        result->real = shellExtNumberToReal(number);
+        return 0;
+    }
+    if (type == 'f' || (type == 0 && number->type == NUM_TYPE_FLOAT))
+    {
+        double real = shellExtNumberToReal(number);
+        float valueFloat;
+        if (shellExtFloatOverflow(real))
+        {
+            return -2;
+        }
+        valueFloat = (float) real;
+        result->value = 0;
+        memcpy(&result->value, &valueFloat, sizeof(float));
+        return 0;
+    }
+
+    if (shellExtNumberToInteger(number, shellExtIntegerBytes(type), &value) != 0)
+    {
+        return -2;
+    }
+    if (type == 'l')
+    {
+        result->integer = (long long) value;
+    }
+    else
+    {
+        result->value = (size_t) value;
+    }
+    return 0;
+}
+
+
+#if SHELL_SUPPORT_ARRAY_PARAM == 1
+/**
+ * @brief 数字按照类型写入数组元素
+ * 
+ * @param number 数字
+ * @param type 元素类型，`q`, `h`, `i`, `l`, `f`, `d`
+ * @param slot 数组元素
+ * 
+ * @return int 0 写入成功 -2 数值超出元素类型范围
+ */
+static int shellExtNumberStore(ShellNumber *number, char type, void *slot)
+{
+    unsigned long long value;
+    double real;
+
+    if (type == 'f' || type == 'd')
+    {
+        real = shellExtNumberToReal(number);
+        if (type == 'd')
+        {
+            *(double *) slot = real;
+            return 0;
+        }
+        if (shellExtFloatOverflow(real))
+        {
+            return -2;
+        }
+        *(float *) slot = (float) real;
+        return 0;
+    }
+
+    if (shellExtNumberToInteger(number, shellExtIntegerBytes(type), &value) != 0)
+    {
+        return -2;
+    }
+    switch (type)
+    {
+    case 'q':
+        *(char *) slot = (char) value;
+        break;
+    case 'h':
+        *(short *) slot = (short) value;
+        break;
+    case 'i':
+        *(int *) slot = (int) value;
+        break;
+    default:
+        *(long long *) slot = (long long) value;
+        break;
+    }
+    return 0;
+}
+#endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
+
+
+/**
+ * @brief 输出数字解析错误
+ * 
+ * @param shell shell对象
+ * @param string 字符串参数
+ * @param error 错误码 -1 格式错误 -2 数值溢出
+ */
+static void shellExtNumberError(Shell *shell, char *string, int error)
+{
+    shellWriteString(shell, error == -2 ? "Number overflow: " : "Invalid number: ");
+    shellWriteString(shell, string);
+    shellWriteString(shell, "\r\n");
+}
+
+
+/**
+ * @brief 解析数字参数
+ * 
+ * @param shell shell对象
+ * @param string 字符串参数
+ * @param type 参数类型，0为自动类型
+ * @param result 解析出的数字
+ * 
+ * @return int 0 解析成功 -1 解析失败 1 自动类型下参数不是合法的数字
+ */
+static int shellExtParseNumber(Shell *shell, char *string, char type, ShellParam *result)
+{
+    ShellNumber number;
+    int ret = shellExtParseNum(string, &number);
+    if (ret == -1 && type == 0)
+    {
+        return 1;
+    }
+    if (ret == 0)
+    {
+        ret = shellExtNumberToParam(&number, type, result);
+    }
+    if (ret != 0)
+    {
+        shellExtNumberError(shell, string, ret);
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief 解析变量参数
+ *        数字类型的参数按照参数类型转换变量值，`l`, `d`类型按照原始类型存放
+ * 
+ * @param shell shell对象
+ * @param var 变量
+ * @param type 参数类型，0为自动类型
+ * @param result 解析结果
+ *
+ * @return int 0 解析成功 -1 解析失败
+ */
+static int shellExtParseVar(Shell *shell, char *var, char type, ShellParam *result)
+{
+    ShellCommand *command = shellSeekVar(shell, var + 1);
+    ShellNumber number;
+    int value;
+
+    if (command == NULL)
+    {
+        return -1;
+    }
+    value = shellGetVarValue(shell, command);
+    if (type == 0 || strchr("qhilfd", type) == NULL)
+    {
+        result->value = (size_t) value;
+        return 0;
+    }
+    number.type = NUM_TYPE_DEC;
+    number.negative = (value < 0);
+    number.integer = (value < 0) ? 0 - (unsigned long long) value : (unsigned long long) value;
+    number.real = 0.0;
+    if (shellExtNumberToParam(&number, type, result) != 0)
+    {
+        shellExtNumberError(shell, var, -2);
+        return -1;
+    }
+    return 0;
+}
+
+
+#if SHELL_SUPPORT_EXPRESSION == 1
+/**
+ * @brief 表达式操作码
+ */
+typedef enum
+{
+    SHELL_EXPR_INT = 0,                                     /**< 整型常量 */
+    SHELL_EXPR_REAL,                                        /**< 浮点常量 */
+    SHELL_EXPR_VAR,                                         /**< 变量 */
+    SHELL_EXPR_NEG,                                         /**< 取负 `-` */
+    SHELL_EXPR_NOT,                                         /**< 按位取反 `~` */
+    SHELL_EXPR_MUL,                                         /**< 乘 `*` */
+    SHELL_EXPR_DIV,                                         /**< 除 `/` */
+    SHELL_EXPR_MOD,                                         /**< 取余 `%` */
+    SHELL_EXPR_ADD,                                         /**< 加 `+` */
+    SHELL_EXPR_SUB,                                         /**< 减 `-` */
+    SHELL_EXPR_SHL,                                         /**< 左移 `<<` */
+    SHELL_EXPR_SHR,                                         /**< 右移 `>>` */
+    SHELL_EXPR_AND,                                         /**< 按位与 `&` */
+    SHELL_EXPR_XOR,                                         /**< 按位异或 `^` */
+    SHELL_EXPR_OR,                                          /**< 按位或 `|` */
+    SHELL_EXPR_LEFT,                                        /**< 左括号，只在编译时使用 */
+} ShellExprOp;
+
+/**
+ * @brief 表达式运算符优先级，按照操作码索引，与C语言一致
+ */
+static const unsigned char shellExprPriority[] = {
+    [SHELL_EXPR_NEG] = 6, [SHELL_EXPR_NOT] = 6,
+    [SHELL_EXPR_MUL] = 5, [SHELL_EXPR_DIV] = 5, [SHELL_EXPR_MOD] = 5,
+    [SHELL_EXPR_ADD] = 4, [SHELL_EXPR_SUB] = 4,
+    [SHELL_EXPR_SHL] = 3, [SHELL_EXPR_SHR] = 3,
+    [SHELL_EXPR_AND] = 2,
+    [SHELL_EXPR_XOR] = 1,
+    [SHELL_EXPR_OR] = 0,
+};
+
+/**
+ * @brief 表达式求值栈元素
+ */
+typedef struct
+{
+    unsigned char real;                                     /**< 浮点数值 */
+    union
+    {
+        long long integer;
+        double real;
+    } value;
+} ShellExprValue;
+
+
+/**
+ * @brief 判断参数是否为表达式
+ * 
+ * @param string 参数
+ * @param strict 严格模式，只有以`$`或者`(`开头的参数才可能是表达式，用于没有类型的参数
+ * 
+ * @return int 1 是表达式 0 不是表达式
+ */
+static int shellExtIsExpression(const char *string, unsigned char strict)
+{
+    const char *p = string;
+    const char *number;
+
+    if (*p == '(' || (!strict && *p == '~'))
+    {
+        return 1;
+    }
+    if (strict && *p != '$')
+    {
+        return 0;
+    }
+    if (*p == '-' || *p == '+')
+    {
+        p++;
+        if (*p == '$' || *p == '(' || *p == '~')
+        {
+            return 1;
+        }
+    }
+    number = p;
+    for (p++; *p; p++)
+    {
+        if (strchr("+-*/%<>&|^~()", *p) == NULL)
+        {
+            continue;
+        }
+        if ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E')
+            && shellExtDigit(number[0]) < 10
+            && !(number[0] == '0' && (number[1] == 'x' || number[1] == 'X')))
+        {
+            continue;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief 表达式添加指令
+ * 
+ * @param program 表达式程序
+ * @param op 操作码
+ * @param depth 当前求值栈深度
+ * 
+ * @return ShellExprCode* 添加的指令，指令数量或者栈深度超出限制时返回NULL
+ */
+static ShellExprCode *shellExprEmit(ShellExprProgram *program, unsigned char op, unsigned char *depth)
+{
+    if (program->count >= SHELL_EXPR_CODE_MAX)
+    {
+        return NULL;
+    }
+    if (op <= SHELL_EXPR_VAR)
+    {
+        if (++(*depth) > SHELL_EXPR_STACK_MAX)
+        {
+            return NULL;
+        }
+    }
+    else if (op > SHELL_EXPR_NOT)
+    {
+        (*depth)--;
+    }
+    program->code[program->count].op = op;
+    return &program->code[program->count++];
+}
+
+
+/**
+ * @brief 表达式编译
+ *        使用调度场算法将中缀表达式转换为后缀形式的指令序列
+ * 
+ * @param source 表达式
+ * @param length 表达式长度
+ * @param program 编译结果
+ * 
+ * @return int 0 编译成功 -1 表达式错误
+ */
+static int shellExprCompile(const char *source, unsigned short length, ShellExprProgram *program)
+{
+    unsigned char ops[SHELL_EXPR_CODE_MAX];
+    unsigned char top = 0;
+    unsigned char depth = 0;
+    unsigned char operand = 1;
+    ShellExprCode *code;
+
+    program->count = 0;
+    for (unsigned short i = 0; i < length; i++)
+    {
+        char data = source[i];
+        unsigned char op;
+
+        if (data == ' ')
+        {
+            continue;
+        }
+        if (operand)
+        {
+            if (data == '(' || data == '-' || data == '~')
+            {
+                if (top >= sizeof(ops))
+                {
+                    return -1;
+                }
+                ops[top++] = data == '(' ? SHELL_EXPR_LEFT
+                           : (data == '-' ? SHELL_EXPR_NEG : SHELL_EXPR_NOT);
+            }
+            else if (data == '$')
+            {
+                unsigned short start = ++i;
+                while (i < length && (source[i] == '_'
+                       || (source[i] >= '0' && source[i] <= '9')
+                       || (source[i] >= 'a' && source[i] <= 'z')
+                       || (source[i] >= 'A' && source[i] <= 'Z')))
+                {
+                    i++;
+                }
+                if (i == start || i - start > 0xFF
+                    || (code = shellExprEmit(program, SHELL_EXPR_VAR, &depth)) == NULL)
+                {
+                    return -1;
+                }
+                code->offset = start;
+                code->length = i - start;
+                operand = 0;
+                i--;
+            }
+            else if (data != '+')
+            {
+                char number[32];
+                unsigned char count = 0;
+                ShellNumber value;
+
+                while (i < length && count < sizeof(number) - 1
+                       && (source[i] == '_' || source[i] == '.' || shellExtDigit(source[i]) < 16
+                           || source[i] == 'x' || source[i] == 'X'
+                           || ((source[i] == '-' || source[i] == '+')
+                               && count > 0 && (number[count - 1] == 'e' || number[count - 1] == 'E')
+                               && !(number[0] == '0' && (number[1] == 'x' || number[1] == 'X')))))
+                {
+                    number[count++] = source[i++];
+                }
+                number[count] = 0;
+                if (count == 0 || shellExtParseNum(number, &value) != 0
+                    || (code = shellExprEmit(program,
+                                             value.type == NUM_TYPE_FLOAT
+                                                ? SHELL_EXPR_REAL : SHELL_EXPR_INT,
+                                             &depth)) == NULL)
+                {
+                    return -1;
+                }
+                if (value.type == NUM_TYPE_FLOAT)
+                {
+                    code->value.real = value.real;
+                }
+                else
+                {
+                    code->value.integer = (long long) value.integer;
+                }
+                operand = 0;
+                i--;
+            }
+            continue;
+        }
+
+        if (data == ')')
+        {
+            while (top > 0 && ops[top - 1] != SHELL_EXPR_LEFT)
+            {
+                if (shellExprEmit(program, ops[--top], &depth) == NULL)
+                {
+                    return -1;
+                }
+            }
+            if (top == 0)
+            {
+                return -1;
+            }
+            top--;
+            continue;
+        }
+
+        switch (data)
+        {
+        case '*': op = SHELL_EXPR_MUL; break;
+        case '/': op = SHELL_EXPR_DIV; break;
+        case '%': op = SHELL_EXPR_MOD; break;
+        case '+': op = SHELL_EXPR_ADD; break;
+        case '-': op = SHELL_EXPR_SUB; break;
+        case '&': op = SHELL_EXPR_AND; break;
+        case '^': op = SHELL_EXPR_XOR; break;
+        case '|': op = SHELL_EXPR_OR; break;
+        case '<':
+        case '>':
+            if (i + 1 >= length || source[i + 1] != data)
+            {
+                return -1;
+            }
+            op = data == '<' ? SHELL_EXPR_SHL : SHELL_EXPR_SHR;
+            i++;
+            break;
+        default:
+            return -1;
+        }
+        while (top > 0 && ops[top - 1] != SHELL_EXPR_LEFT
+               && shellExprPriority[ops[top - 1]] >= shellExprPriority[op])
+        {
+            if (shellExprEmit(program, ops[--top], &depth) == NULL)
+            {
+                return -1;
+            }
+        }
+        if (top >= sizeof(ops))
+        {
+            return -1;
+        }
+        ops[top++] = op;
+        operand = 1;
+    }
+    if (operand)
+    {
+        return -1;
+    }
+    while (top > 0)
+    {
+        if (ops[--top] == SHELL_EXPR_LEFT || shellExprEmit(program, ops[top], &depth) == NULL)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief 表达式求值
+ *        使用固定深度的求值栈，整型按照64位运算，任一操作数为浮点数时按照浮点运算
+ * 
+ * @param shell shell对象
+ * @param program 表达式程序
+ * @param source 表达式，用于获取变量名
+ * @param result 求值结果
+ * 
+ * @return int 0 求值成功 -1 求值失败
+ */
+static int shellExprEval(Shell *shell, const ShellExprProgram *program,
+                         const char *source, ShellNumber *result)
+{
+    ShellExprValue stack[SHELL_EXPR_STACK_MAX];
+    unsigned char top = 0;
+
+    for (unsigned char i = 0; i < program->count; i++)
+    {
+        const ShellExprCode *code = &program->code[i];
+        ShellExprValue *a;
+        ShellExprValue *b;
+
+        switch (code->op)
+        {
+        case SHELL_EXPR_INT:
+        case SHELL_EXPR_REAL:
+            stack[top].real = code->op == SHELL_EXPR_REAL;
+            if (code->op == SHELL_EXPR_REAL)
+            {
+                stack[top++].value.real = code->value.real;
+            }
+            else
+            {
+                stack[top++].value.integer = code->value.integer;
+            }
+            continue;
+        case SHELL_EXPR_VAR: {
+            char name[SHELL_EXPR_SOURCE_MAX];
+            ShellCommand *command;
+            if (code->length >= sizeof(name))
+            {
+                return -1;
+            }
+            memcpy(name, source + code->offset, code->length);
+            name[code->length] = 0;
+            if ((command = shellSeekVar(shell, name)) == NULL)
+            {
+                return -1;
+            }
+            stack[top].real = 0;
+            stack[top++].value.integer =
+                (command->attr.attrs.type == SHELL_TYPE_VAR_POINT
+                 || command->attr.attrs.type == SHELL_TYPE_VAR_STRING)
+                ? (long long) (size_t) command->data.var.value
+                : (long long) shellGetVarValue(shell, command);
+            continue;
+        }
+        case SHELL_EXPR_NEG:
+            b = &stack[top - 1];
+            if (b->real)
+            {
+                b->value.real = -b->value.real;
+            }
+            else
+            {
+                b->value.integer = (long long) (0 - (unsigned long long) b->value.integer);
+            }
+            continue;
+        case SHELL_EXPR_NOT:
+            b = &stack[top - 1];
+            if (b->real)
+            {
+                return -1;
+            }
+            b->value.integer = ~b->value.integer;
+            continue;
+        default:
+            break;
+        }
+
+        a = &stack[top - 2];
+        b = &stack[top - 1];
+        top--;
+        if (a->real || b->real)
+        {
+            double x = a->real ? a->value.real : (double) a->value.integer;
+            double y = b->real ? b->value.real : (double) b->value.integer;
+            switch (code->op)
+            {
+            case SHELL_EXPR_MUL: x *= y; break;
+            case SHELL_EXPR_DIV: x /= y; break;
+            case SHELL_EXPR_ADD: x += y; break;
+            case SHELL_EXPR_SUB: x -= y; break;
+            default:
+                return -1;
+            }
+            a->real = 1;
+            a->value.real = x;
+        }
+        else
+        {
+            unsigned long long x = (unsigned long long) a->value.integer;
+            unsigned long long y = (unsigned long long) b->value.integer;
+            switch (code->op)
+            {
+            case SHELL_EXPR_MUL: x *= y; break;
+            case SHELL_EXPR_DIV:
+            case SHELL_EXPR_MOD:
+                if (y == 0 || (a->value.integer == -9223372036854775807LL - 1 && b->value.integer == -1))
+                {
+                    return -1;
+                }
+                x = (unsigned long long) (code->op == SHELL_EXPR_DIV
+                                          ? a->value.integer / b->value.integer
+                                          : a->value.integer % b->value.integer);
+                break;
+            case SHELL_EXPR_ADD: x += y; break;
+            case SHELL_EXPR_SUB: x -= y; break;
+            case SHELL_EXPR_SHL: x = y < 64 ? x << y : 0; break;
+            case SHELL_EXPR_SHR: x = y < 64 ? x >> y : 0; break;
+            case SHELL_EXPR_AND: x &= y; break;
+            case SHELL_EXPR_XOR: x ^= y; break;
+            case SHELL_EXPR_OR: x |= y; break;
+            default:
+                return -1;
+            }
+            a->value.integer = (long long) x;
+        }
     }
-    else
+
+    if (top != 1)
     {
-        value = *p;
+        return -1;
     }
-    return value;
-}
-
-
-/**
- * @brief 解析字符串参数
- * 
- * @param string 字符串参数
- * @return char* 解析出的字符串
- */
-static char* shellExtParseString(char *string)
-{
-    char *p = string;
-    unsigned short index = 0;
-
-    if (*string == '\"')
+    if (stack[0].real)
     {
-        p = ++string;
+        result->type = NUM_TYPE_FLOAT;
+        result->real = stack[0].value.real;
+        result->negative = result->real < 0;
     }
-
-    while (*p)
+    else
     {
-        if (*p == '\\')
-        {
-            *(string + index) = shellExtParseChar(p);
-            p++;
-        }
-        else if (*p == '\"')
-        {
-            *(string + index) = 0;
-        }
-        else
-        {
-            *(string + index) = *p;
-        }
-        p++;
-        index ++;
+        result->type = NUM_TYPE_DEC;
+        result->negative = stack[0].value.integer < 0;
+        result->integer = result->negative
+            ? 0 - (unsigned long long) stack[0].value.integer
+            : (unsigned long long) stack[0].value.integer;
     }
-    *(string + index) = 0;
-    return string;
+    return 0;
 }
 
 
 /**
- * @brief 解析数字参数
+ * @brief 获取表达式程序
+ *        优先从表达式缓存中查找，未找到时编译表达式并加入缓存
  * 
- * @param string 字符串参数
- * @return size_t 解析出的数字
+ * @param shell shell对象
+ * @param source 表达式
+ * @param program 不缓存时用于存放编译结果的程序
+ * 
+ * @return const ShellExprProgram* 表达式程序，编译失败返回NULL
  */
-static size_t shellExtParseNumber(char *string)
+static const ShellExprProgram *shellExprLoad(Shell *shell, const char *source,
+                                             ShellExprProgram *program)
 {
-    ShellNumType type = NUM_TYPE_DEC;
-    char radix = 10;
-    char *p = string;
-    char offset = 0;
-    signed char sign = 1;
-    size_t valueInt = 0;
-    float valueFloat = 0.0;
-    size_t devide = 0;
-
-    if (*string == '-')
-    {
-        sign = -1;
-    }
+    unsigned short length = strlen(source);
+#if SHELL_EXPR_CACHE_SIZE > 0
+    unsigned int hash = 2166136261u;
 
-    type = shellExtNumType(string + ((sign == -1) ? 1 : 0));
-
-    switch ((char)type)
+    for (unsigned short i = 0; i < length; i++)
     {
-    case NUM_TYPE_HEX:
-        radix = 16;
-        offset = 2;
-        break;
-    
-    case NUM_TYPE_OCT:
-        radix = 8;
-        offset = 1;
-        break;
-
-    case NUM_TYPE_BIN:
-        radix = 2;
-        offset = 2;
-        break;
-    
-    default:
-        break;
+        hash = (hash ^ (unsigned char) source[i]) * 16777619u;
     }
-
-    p = string + offset + ((sign == -1) ? 1 : 0);
-
-    while (*p)
+    if (length < SHELL_EXPR_SOURCE_MAX)
     {
-        if (*p == '.')
+        for (unsigned short i = 0; i < SHELL_EXPR_CACHE_SIZE; i++)
         {
-            devide = 1;
-            p++;
-            continue;
+            program = &shell->exprCache.program[i];
+            if (program->length == length && program->hash == hash
+                && memcmp(program->source, source, length) == 0)
+            {
+                return program;
+            }
         }
-        valueInt = valueInt * radix + shellExtToNum(*p);
-        devide *= 10;
-        p++;
-    }
-    if (type == NUM_TYPE_FLOAT && devide != 0)
-    {
-        valueFloat = (float)valueInt / devide * sign;
-        return *(size_t *)(&valueFloat);
-    }
-    else
-    {
-        return valueInt * sign;
+        program = &shell->exprCache.program[shell->exprCache.next];
+        shell->exprCache.next = (shell->exprCache.next + 1) % SHELL_EXPR_CACHE_SIZE;
+        if (shellExprCompile(source, length, program) != 0)
+        {
+            program->length = 0;
+            return NULL;
+        }
+        program->hash = hash;
+        program->length = length;
+        memcpy(program->source, source, length);
+        return program;
     }
+#endif /** SHELL_EXPR_CACHE_SIZE > 0 */
+    return shellExprCompile(source, length, program) == 0 ? program : NULL;
 }
 
 
 /**
- * @brief 解析变量参数
+ * @brief 解析表达式参数
  * 
  * @param shell shell对象
- * @param var 变量
+ * @param string 表达式
+ * @param type 参数类型，0为自动类型
  * @param result 解析结果
- *
- * @return int 0 解析成功 --1 解析失败
+ * 
+ * @return int 0 解析成功 -1 解析失败
  */
-static int shellExtParseVar(Shell *shell, char *var, size_t *result)
+static int shellExtParseExpr(Shell *shell, char *string, char type, ShellParam *result)
 {
-    ShellCommand *command = shellSeekCommand(shell,
-                                             var + 1,
-                                             shell->commandList.base,
-                                             0);
-    if (command)
+    ShellExprProgram local;
+    const ShellExprProgram *program = shellExprLoad(shell, string, &local);
+    ShellNumber number;
+    int ret;
+
+    if (program == NULL || shellExprEval(shell, program, string, &number) != 0)
     {
-        *result = shellGetVarValue(shell, command);
-        return 0;
+        shellWriteString(shell, "Invalid expression: ");
+        shellWriteString(shell, string);
+        shellWriteString(shell, "\r\n");
+        return -1;
     }
-    else
+    if ((ret = shellExtNumberToParam(&number, type, result)) != 0)
     {
+        shellExtNumberError(shell, string, ret);
         return -1;
     }
+    return 0;
 }
+#endif /** SHELL_SUPPORT_EXPRESSION == 1 */
 
 
 /**
- * @brief 解析参数
+ * @brief 解析参数标记
  * 
  * @param shell shell对象
- * @param string 参数
+ * @param token 参数标记
  * @param type 参数类型
  * @param result 解析结果
  * 
  * @return int 0 解析成功 --1 解析失败
  */
-int shellExtParsePara(Shell *shell, char *string, char *type, size_t *result)
+static int shellExtParseToken(Shell *shell, ShellToken *token, char *type, ShellParam *result)
 {
-    if (type == NULL || (*string == '$' && *(string + 1)))
+    char *string = token->start;
+    int ret;
+#if SHELL_SUPPORT_EXPRESSION == 1
+    if (!token->quoted && !token->literal
+        && (type == NULL || (type[0] && type[1] == 0 && strchr("qhilfdp", type[0])))
+        && shellExtIsExpression(string, type == NULL))
+    {
+        return shellExtParseExpr(shell, string, type ? type[0] : 0, result);
+    }
+#endif /** SHELL_SUPPORT_EXPRESSION == 1 */
+    if (type == NULL || (!token->quoted && !token->literal && *string == '$' && *(string + 1)))
     {
-        if (*string == '\'' && *(string + 1))
+        if (token->quoted)
         {
-            *result = (size_t)shellExtParseChar(string);
+            result->value = (size_t)string;
             return 0;
         }
-        else if (*string == '-' || (*string >= '0' && *string <= '9'))
+        else if (*string == '\'' && *(string + 1))
         {
-            *result = shellExtParseNumber(string);
+            result->value = (size_t)shellExtParseChar(string);
             return 0;
         }
-        else if (*string == '$' && *(string + 1))
+        else if ((*string == '-' || (*string >= '0' && *string <= '9'))
+                 && (ret = shellExtParseNumber(shell, string, 0, result)) <= 0)
         {
-            return shellExtParseVar(shell, string, result);
+            return ret;
+        }
+        else if (*string == '$' && *(string + 1) && !token->literal)
+        {
+            return shellExtParseVar(shell, string,
+                                    (type != NULL && type[1] == 0) ? type[0] : 0, result);
         }
         else if (*string)
         {
-            *result = (size_t)shellExtParseString(string);
+            result->value = (size_t)string;
             return 0;
         }
     }
 #if SHELL_USING_FUNC_SIGNATURE == 1
     else
     {
-        if (*string == '$' && *(string + 1))
+        if (*string == '$' && *(string + 1) && !token->literal)
         {
-            return shellExtParseVar(shell, string, result);
+            return shellExtParseVar(shell, string, type[1] == 0 ? type[0] : 0, result);
         }
     #if SHELL_SUPPORT_ARRAY_PARAM == 1
         else if (type[0] == '[')
         {
-            return shellExtParseArray(shell, string, type, result);
+            return shellExtParseArray(shell, token, type, &result->value);
         }
     #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
         else if (strcmp("c", type) == 0)
         {
-            *result = (size_t)shellExtParseChar(string);
+            result->value = (size_t)shellExtParseChar(string);
             return 0;
         }
         else if (strcmp("q", type) == 0
                  || strcmp("h", type) == 0
                  || strcmp("i", type) == 0
+                 || strcmp("l", type) == 0
                  || strcmp("f", type) == 0
+                 || strcmp("d", type) == 0
                  || strcmp("p", type) == 0)
         {
-            *result = shellExtParseNumber(string);
-            return 0;
+            return shellExtParseNumber(shell, string, type[0], result);
         }
         else if (strcmp("s", type) == 0)
         {
-            *result = (size_t)shellExtParseString(string);
+            result->value = (size_t)string;
             return 0;
         }
         else
@@ -423,9 +1687,9 @@ int shellExtParsePara(Shell *shell, char *string, char *type, size_t *result)
             if (command != NULL)
             {
                 void *param;
-                if (command->data.paramParser.parser(shellExtParseString(string), &param) == 0)
+                if (command->data.paramParser.parser(string, &param) == 0)
                 {
-                    *result = (size_t)param;
+                    result->value = (size_t)param;
                     return 0;
                 }
                 else
@@ -450,6 +1714,103 @@ int shellExtParsePara(Shell *shell, char *string, char *type, size_t *result)
 }
 
 
+/**
+ * @brief 获取参数对应的参数标记
+ * 
+ * @param shell shell对象
+ * @param string 参数
+ * 
+ * @return ShellToken* 参数标记，参数不是命令行分割得到的参数时返回NULL
+ */
+static ShellToken* shellExtGetToken(Shell *shell, char *string)
+{
+    for (short i = 0; i < SHELL_PARAMETER_MAX_NUMBER; i++)
+    {
+        if (shell->parser.token[i].start == string)
+        {
+            return &shell->parser.token[i];
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief 解析参数
+ *        命令行分割得到的参数直接使用分割时记录的参数标记，
+ *        其他来源的参数先进行引号和转义字符处理，需要处理时在副本上进行，不修改传入的字符串，
+ *        副本优先从参数内存池分配，未使能参数内存池时使用`SHELL_MALLOC`分配并在解析后释放，
+ *        此时解析结果不能引用副本(比如带引号的字符串参数)
+ * 
+ * @param shell shell对象
+ * @param string 参数
+ * @param type 参数类型
+ * @param result 解析结果，`l`, `d`类型的参数按照原始类型存放
+ * 
+ * @return int 0 解析成功 --1 解析失败
+ */
+int shellExtParseParam(Shell *shell, char *string, char *type, ShellParam *result)
+{
+    ShellToken *token = shellExtGetToken(shell, string);
+    ShellToken rawToken = {string, 0, 0, 0, 0, 0};
+    char *copy = NULL;
+    size_t length;
+    int ret;
+
+    if (token != NULL)
+    {
+        return shellExtParseToken(shell, token, type, result);
+    }
+    length = strlen(string);
+    if (strpbrk(string, "\"\\"))
+    {
+    #if SHELL_PARAM_ARENA_SIZE > 0
+        copy = (length < 0xFFFF) ? shellArenaAlloc(shell, (unsigned short) (length + 1)) : NULL;
+    #else
+        copy = SHELL_MALLOC(length + 1);
+    #endif /** SHELL_PARAM_ARENA_SIZE > 0 */
+        if (copy == NULL)
+        {
+            return -1;
+        }
+        memcpy(copy, string, length + 1);
+        string = copy;
+    }
+    shellTokenize(string, length, &rawToken, 1, 0);
+    ret = shellExtParseToken(shell, &rawToken, type, result);
+#if SHELL_PARAM_ARENA_SIZE == 0
+    if (copy)
+    {
+        if (ret == 0 && result->value >= (size_t) copy && result->value <= (size_t) (copy + length))
+        {
+            ret = -1;
+        }
+        SHELL_FREE(copy);
+    }
+#endif /** SHELL_PARAM_ARENA_SIZE == 0 */
+    return ret;
+}
+
+
+/**
+ * @brief 解析参数
+ * 
+ * @param shell shell对象
+ * @param string 参数
+ * @param type 参数类型，不支持`l`, `d`类型
+ * @param result 解析结果
+ * 
+ * @return int 0 解析成功 --1 解析失败
+ */
+int shellExtParsePara(Shell *shell, char *string, char *type, size_t *result)
+{
+    ShellParam param;
+    int ret = shellExtParseParam(shell, string, type, &param);
+    *result = param.value;
+    return ret;
+}
+
+
 #if SHELL_USING_FUNC_SIGNATURE == 1
 /**
  * @brief 清理参数
@@ -478,7 +1839,9 @@ int shellExtCleanerPara(Shell *shell, char *type, size_t param)
             || strcmp("q", type) == 0
             || strcmp("h", type) == 0
             || strcmp("i", type) == 0
+            || strcmp("l", type) == 0
             || strcmp("f", type) == 0
+            || strcmp("d", type) == 0
             || strcmp("p", type) == 0
             || strcmp("s", type) == 0)
         {
@@ -490,9 +1853,10 @@ int shellExtCleanerPara(Shell *shell, char *type, size_t param)
                                                      type,
                                                      shell->commandList.base,
                                                      0);
-            if (command != NULL && command->data.paramParser.cleaner != NULL)
+            if (command != NULL)
             {
-                return command->data.paramParser.cleaner((void *)param);
+                return command->data.paramParser.cleaner
+                    ? command->data.paramParser.cleaner((void *)param) : 0;
             }
         }
     }
@@ -500,100 +1864,273 @@ int shellExtCleanerPara(Shell *shell, char *type, size_t param)
 }
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
 
+#if SHELL_PARAM_ARENA_SIZE > 0
+/**
+ * @brief 从参数内存池分配内存
+ *        分配的内存按8字节对齐，在当前命令执行完成后自动释放，不需要也不可以调用`SHELL_FREE`释放，
+ *        自定义参数解析器可以通过`shellArenaAlloc(shellGetCurrent(), size)`分配内存，此时可以不定义清理函数
+ * 
+ * @param shell shell对象
+ * @param size 分配大小
+ * 
+ * @return void* 分配的内存，内存池空间不足时返回NULL
+ */
+void *shellArenaAlloc(Shell *shell, unsigned short size)
+{
+    unsigned short top;
+    SHELL_ASSERT(shell, return NULL);
+    top = (unsigned short) ((shell->arena.top + 7) & ~7);
+    if (top > sizeof(shell->arena.buffer) || size > sizeof(shell->arena.buffer) - top)
+    {
+        return NULL;
+    }
+    shell->arena.top = top + size;
+    return (char *) shell->arena.buffer + top;
+}
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
+
 #if SHELL_SUPPORT_ARRAY_PARAM == 1
 /**
- * @brief 估算数组长度
+ * @brief 为参数分配内存
+ *        优先从参数内存池分配，内存池空间不足时使用`SHELL_MALLOC`
  * 
- * @param string 数组参数
+ * @param shell shell对象
+ * @param size 分配大小
  * 
- * @return int 估算的数组长度
+ * @return void* 分配的内存
  */
-static int shellEstimateArrayLength(char *string)
+static void *shellExtAlloc(Shell *shell, size_t size)
 {
-    int length = 0;
-    char *p = string;
-    while (*p)
+#if SHELL_PARAM_ARENA_SIZE > 0
+    void *mem = (size <= 0xFFFF) ? shellArenaAlloc(shell, (unsigned short) size) : NULL;
+    if (mem)
+    {
+        return mem;
+    }
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
+    return SHELL_MALLOC(size);
+}
+
+/**
+ * @brief 释放参数内存
+ *        从参数内存池分配的内存不需要释放
+ * 
+ * @param shell shell对象
+ * @param mem 内存
+ */
+static void shellExtFree(Shell *shell, void *mem)
+{
+#if SHELL_PARAM_ARENA_SIZE > 0
+    if ((char *) mem >= (char *) shell->arena.buffer
+        && (char *) mem < (char *) shell->arena.buffer + sizeof(shell->arena.buffer))
     {
-        if (*p == ',')
+        return;
+    }
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
+    SHELL_FREE(mem);
+}
+
+/**
+ * @brief 计算数组元素个数
+ *        只统计最外层的元素，引号以及嵌套数组内的分隔符不计入
+ * 
+ * @param string 数组参数(不包含最外层括号)
+ * @param length 数组参数长度
+ * 
+ * @return unsigned short 数组元素个数
+ */
+static unsigned short shellExtArrayCount(const char *string, unsigned short length)
+{
+    unsigned short count = 0;
+    unsigned short depth = 0;
+    unsigned char quoted = 0;
+    unsigned char inElement = 0;
+
+    for (unsigned short i = 0; i < length; i++)
+    {
+        char data = string[i];
+        if (!quoted && depth == 0 && (data == ',' || data == ' '))
         {
-            length++;
+            inElement = 0;
+            continue;
+        }
+        if (!inElement)
+        {
+            inElement = 1;
+            count++;
+        }
+        if (data == '\\')
+        {
+            i++;
+        }
+        else if (data == '\"')
+        {
+            quoted = !quoted;
+        }
+        else if (!quoted && data == '[')
+        {
+            depth++;
+        }
+        else if (!quoted && data == ']' && depth > 0)
+        {
+            depth--;
         }
-        p++;
     }
-    return length + 1;
+    return count;
 }
 
 /**
- * @brief 分割数组参数
+ * @brief 获取数组元素宽度
  * 
- * @param string 数组参数
- * @param array 分割后的字符串数组
+ * @param type 元素类型
  * 
- * @return int 数组长度
+ * @return unsigned char 元素宽度
  */
-static int shellSplitArray(char *string, char ***array)
+static unsigned char shellExtElementBytes(const char *type)
 {
-    int strLen = strlen(string);
-    if (string[strLen - 1] == ']')
+    if (type[0] == 0 || type[1] != 0)
     {
-        string[--strLen] = 0;
+        return sizeof(void *);
     }
-    if (string[0] == '[')
+    switch (type[0])
     {
-        --strLen;
-        string++;
+    case 'c':
+    case 'q':
+        return sizeof(char);
+    case 'h':
+        return sizeof(short);
+    case 'i':
+        return sizeof(int);
+    case 'l':
+        return sizeof(long long);
+    case 'f':
+        return sizeof(float);
+    case 'd':
+        return sizeof(double);
+    default:
+        return sizeof(void *);
+    }
+}
+
+/**
+ * @brief 解析数组元素
+ *        数字类型的元素直接按照元素类型写入，其他类型按照参数解析后写入
+ * 
+ * @param shell shell 对象
+ * @param token 元素
+ * @param type 元素类型
+ * @param slot 数组元素
+ * 
+ * @return int 0 解析成功 -1 解析失败
+ */
+static int shellExtParseElement(Shell *shell, ShellToken *token, char *type, void *slot)
+{
+    ShellParam param;
+    char *string = token->start;
+
+    if (type[1] == 0 && strchr("qhilfd", type[0]) && (token->quoted || *string != '$'))
+    {
+        ShellNumber number;
+        int ret = shellExtParseNum(string, &number);
+        if (ret == 0)
+        {
+            ret = shellExtNumberStore(&number, type[0], slot);
+        }
+        if (ret != 0)
+        {
+            shellExtNumberError(shell, string, ret);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (shellExtParseToken(shell, token, type, &param) != 0)
+    {
+        return -1;
+    }
+    switch (type[1] == 0 ? type[0] : 0)
+    {
+    case 'c':
+    case 'q':
+        *(char *) slot = (char) param.value;
+        break;
+    case 'h':
+        *(short *) slot = (short) param.value;
+        break;
+    case 'i':
+        *(int *) slot = (int) param.value;
+        break;
+    case 'l':
+        *(long long *) slot = param.integer;
+        break;
+    case 'f':
+        memcpy(slot, &param.value, sizeof(float));
+        break;
+    case 'd':
+        *(double *) slot = param.real;
+        break;
+    default:
+        *(size_t *) slot = param.value;
+        break;
     }
-    int size = shellEstimateArrayLength(string);
-    *array = SHELL_MALLOC(size * sizeof(char *));
-    return shellSplit(string, strLen, *array, ',', size);
+    return 0;
 }
 
 /**
  * @brief 解析数组参数
+ *        数组存储只分配一次，元素逐个分割并直接解析到最终位置
  * 
  * @param shell shell 对象
- * @param string 数组参数
+ * @param token 数组参数
  * @param type 参数类型
  * @param result 解析结果
  * 
  * @return int 0 解析成功 -1 解析失败
  */
-static int shellExtParseArray(Shell *shell, char *string, char *type, size_t *result)
+static int shellExtParseArray(Shell *shell, ShellToken *token, char *type, size_t *result)
 {
-    char **params;
-    int size = shellSplitArray(string, &params);
-    int elementBytes = sizeof(void *);
+    char *string = token->start;
+    unsigned short length = token->length;
+    unsigned short offset = 0;
+    unsigned short size;
+    unsigned char elementBytes = shellExtElementBytes(type + 1);
+    ShellArrayHeader *header;
+    char *data;
 
-    if (strcmp(type + 1, "q") == 0)
-    {
-        elementBytes = sizeof(char);
-    }
-    else if (strcmp(type + 1, "h") == 0)
+    if (length > 0 && string[length - 1] == ']')
     {
-        elementBytes = sizeof(short);
+        string[--length] = 0;
     }
-    else if (strcmp(type + 1, "i") == 0)
+    if (length > 0 && string[0] == '[')
     {
-        elementBytes = sizeof(int);
+        --length;
+        string++;
     }
 
-    ShellArrayHeader *header = SHELL_MALLOC(elementBytes * size + sizeof(ShellArrayHeader));
-    *result = (size_t) ((size_t) header + sizeof(ShellArrayHeader));
-    header->size = size;
+    size = shellExtArrayCount(string, length);
+    header = shellExtAlloc(shell, SHELL_ARRAY_HEADER_SIZE + elementBytes * size);
+    SHELL_ASSERT(header, return -1);
+    data = (char *) header + SHELL_ARRAY_HEADER_SIZE;
+    header->size = 0;
     header->elementBytes = elementBytes;
-    for (short i = 0; i < size; i++)
+    *result = (size_t) data;
+
+    while (offset < length && header->size < size)
     {
-        size_t value;
-        if (shellExtParsePara(shell, params[i], type + 1, &value) != 0)
+        ShellToken element;
+        offset += shellTokenizeNext(string + offset, length - offset, &element, ',');
+        if (element.start == NULL)
+        {
+            break;
+        }
+        if (shellExtParseElement(shell, &element, type + 1,
+                                 data + elementBytes * header->size) != 0)
         {
-            SHELL_FREE(header);
-            SHELL_FREE(params);
+            shellExtCleanerArray(shell, type, data);
             return -1;
         }
-        memcpy((void *) ((size_t) *result + elementBytes * i), &value, elementBytes);
+        header->size++;
     }
-
-    SHELL_FREE(params);
     return 0;
 }
 
@@ -608,16 +2145,20 @@ static int shellExtParseArray(Shell *shell, char *string, char *type, size_t *re
  */
 static int shellExtCleanerArray(Shell *shell, char *type, void *param)
 {
-    ShellArrayHeader *header = (ShellArrayHeader *) ((size_t) param - sizeof(ShellArrayHeader));
-    for (short i = 0; i < header->size; i++)
+    ShellArrayHeader *header = (ShellArrayHeader *) ((size_t) param - SHELL_ARRAY_HEADER_SIZE);
+    int ret = 0;
+    if (type[1] == '[' || type[1] == 'L')
     {
-        if (shellExtCleanerPara(shell, type + 1, *(size_t *) ((size_t) param + header->elementBytes * i)) != 0)
+        for (unsigned short i = 0; i < header->size; i++)
         {
-            return -1;
+            if (shellExtCleanerPara(shell, type + 1, ((size_t *) param)[i]) != 0)
+            {
+                ret = -1;
+            }
         }
     }
-    SHELL_FREE(header);
-    return 0;
+    shellExtFree(shell, header);
+    return ret;
 }
 
 /**
@@ -629,12 +2170,29 @@ static int shellExtCleanerArray(Shell *shell, char *type, void *param)
  */
 int shellGetArrayParamSize(void *param)
 {
-    ShellArrayHeader *header = (ShellArrayHeader *) ((size_t) param - sizeof(ShellArrayHeader));
+    ShellArrayHeader *header = (ShellArrayHeader *) ((size_t) param - SHELL_ARRAY_HEADER_SIZE);
     return header->size;
 }
 #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
 
 
+#if SHELL_USING_FUNC_SIGNATURE == 1
+/**
+ * @brief 判断参数类型是否无法通过`size_t`传递
+ *        `d`类型以及`size_t`宽度不足时的`l`类型参数，只能通过命令调用函数传递
+ * 
+ * @param type 参数类型
+ * 
+ * @return int 1 无法通过`size_t`传递 0 可以通过`size_t`传递
+ */
+static int shellExtIsWideType(const char *type)
+{
+    return strcmp("d", type) == 0
+        || (strcmp("l", type) == 0 && sizeof(size_t) < sizeof(long long));
+}
+#endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
+
+
 /**
  * @brief 执行命令
  * 
@@ -647,9 +2205,12 @@ int shellGetArrayParamSize(void *param)
 int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
 {
     int ret = 0;
-    size_t params[SHELL_PARAMETER_MAX_NUMBER] = {0};
+    ShellParam params[SHELL_PARAMETER_MAX_NUMBER] = {{0}};
     int paramNum = command->attr.attrs.paramNum > (argc - 1) ? 
         command->attr.attrs.paramNum : (argc - 1);
+#if SHELL_PARAM_ARENA_SIZE > 0
+    unsigned short arenaTop = shell->arena.top;
+#endif
 #if SHELL_USING_FUNC_SIGNATURE == 1
     char type[16];
     int index = 0;
@@ -669,20 +2230,48 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     #if SHELL_USING_FUNC_SIGNATURE == 1
         if (command->data.cmd.signature != NULL) {
             index = shellGetNextParamType(command->data.cmd.signature, index, type);
-            if (shellExtParsePara(shell, argv[i + 1], type, &params[i]) != 0)
+        #if SHELL_USING_FUNC_INVOKER == 1
+            if (command->data.cmd.invoker == NULL && shellExtIsWideType(type))
+        #else
+            if (shellExtIsWideType(type))
+        #endif
             {
-                return -1;
+                shellWriteString(shell, "Parameter type needs typed command: ");
+                shellWriteString(shell, type);
+                shellWriteString(shell, "\r\n");
+                ret = -1;
+                break;
+            }
+            if (shellExtParseParam(shell, argv[i + 1], type, &params[i]) != 0)
+            {
+                ret = -1;
+                break;
             }
         }
         else
     #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
         {
-            if (shellExtParsePara(shell, argv[i + 1], NULL, &params[i]) != 0)
+            if (shellExtParseParam(shell, argv[i + 1], NULL, &params[i]) != 0)
             {
-                return -1;
+                ret = -1;
+                break;
             }
         }
     }
+    if (ret != 0)
+    {
+    #if SHELL_PARAM_ARENA_SIZE > 0
+        shell->arena.top = arenaTop;
+    #endif
+        return -1;
+    }
+#if SHELL_USING_FUNC_INVOKER == 1
+    if (command->data.cmd.invoker != NULL)
+    {
+        ret = command->data.cmd.invoker(params);
+    }
+    else
+#endif /** SHELL_USING_FUNC_INVOKER == 1 */
     switch (paramNum)
     {
 #if SHELL_PARAMETER_MAX_NUMBER >= 1
@@ -694,7 +2283,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 1:
     {
         int (*func)(size_t) = command->data.cmd.function;
-        ret = func(params[0]);
+        ret = func(params[0].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 2 */
@@ -702,7 +2291,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 2:
     {
         int (*func)(size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1]);
+        ret = func(params[0].value, params[1].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 3 */
@@ -710,7 +2299,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 3:
     {
         int (*func)(size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2]);
+        ret = func(params[0].value, params[1].value, params[2].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 4 */
@@ -718,7 +2307,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 4:
     {
         int (*func)(size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 5 */
@@ -726,7 +2315,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 5:
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 6 */
@@ -734,7 +2323,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 6:
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 7 */
@@ -742,7 +2331,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     case 7:
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 8 */
@@ -751,7 +2340,7 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t)
             = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 9 */
@@ -760,8 +2349,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 10 */
@@ -770,8 +2359,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 11 */
@@ -780,8 +2369,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9], params[10]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value, params[10].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 12 */
@@ -790,8 +2379,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9], params[10], params[11]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value, params[10].value, params[11].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 13 */
@@ -800,8 +2389,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
     {
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t, size_t, size_t, size_t) = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9], params[10], params[11], params[12]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value, params[10].value, params[11].value, params[12].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 14 */
@@ -811,8 +2400,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t, size_t, size_t, size_t, size_t)
             = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9], params[10], params[11], params[12], params[13]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value, params[10].value, params[11].value, params[12].value, params[13].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 15 */
@@ -822,8 +2411,8 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
         int (*func)(size_t, size_t, size_t, size_t, size_t, size_t, size_t, size_t,
                     size_t, size_t, size_t, size_t, size_t, size_t, size_t)
             = command->data.cmd.function;
-        ret = func(params[0], params[1], params[2], params[3], params[4], params[5], params[6], params[7],
-                   params[8], params[9], params[10], params[11], params[12], params[13], params[14]);
+        ret = func(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, params[5].value, params[6].value, params[7].value,
+                   params[8].value, params[9].value, params[10].value, params[11].value, params[12].value, params[13].value, params[14].value);
         break;
     }
 #endif /** SHELL_PARAMETER_MAX_NUMBER >= 16 */
@@ -838,10 +2427,13 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
         for (int i = 0; i < argc - 1; i++)
         {
             index = shellGetNextParamType(command->data.cmd.signature, index, type);
-            shellExtCleanerPara(shell, type, params[i]);
+            shellExtCleanerPara(shell, type, params[i].value);
         }
     }
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
+#if SHELL_PARAM_ARENA_SIZE > 0
+    shell->arena.top = arenaTop;
+#endif
 
     return ret;
 }
@@ -27,18 +27,41 @@ typedef enum
     NUM_TYPE_FLOAT                                          /**< 浮点型 */
 } ShellNumType;
 
+/**
+ * @brief 数字解析结果
+ */
+typedef struct
+{
+    ShellNumType type;                                      /**< 数字类型 */
+    unsigned char negative;                                 /**< 负数 */
+    unsigned long long integer;                             /**< 整型数值(绝对值) */
+    double real;                                            /**< 浮点型数值 */
+} ShellNumber;
+
 #if SHELL_SUPPORT_ARRAY_PARAM == 1
 typedef struct
 {
     unsigned short size;
     unsigned char elementBytes;
 } ShellArrayHeader;
+
+/**
+ * @brief 数组参数头部大小
+ *        按8字节对齐，保证数组数据可以存放`long long`以及`double`类型的元素
+ */
+#define SHELL_ARRAY_HEADER_SIZE     ((sizeof(ShellArrayHeader) + 7) & ~7)
 #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
 
+char shellExtEscapeChar(char code);
+int shellExtParseNum(const char *string, ShellNumber *number);
+int shellExtParseParam(Shell *shell, char *string, char *type, ShellParam *result);
 int shellExtParsePara(Shell *shell, char *string, char *type, size_t *result);
 #if SHELL_USING_FUNC_SIGNATURE == 1
 int shellExtCleanerPara(Shell *shell, char *type, size_t param);
 #endif /** SHELL_USING_FUNC_SIGNATURE == 1 */
+#if SHELL_PARAM_ARENA_SIZE > 0
+void *shellArenaAlloc(Shell *shell, unsigned short size);
+#endif /** SHELL_PARAM_ARENA_SIZE > 0 */
 #if SHELL_SUPPORT_ARRAY_PARAM == 1
 int shellGetArrayParamSize(void *param);
 #endif /** SHELL_SUPPORT_ARRAY_PARAM == 1 */
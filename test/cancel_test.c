@@ -0,0 +1,133 @@
+/**
+ * @file cancel_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell command cancel test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 命令只调用`shellIsCancelled`而不读取输入时，检查取消按键可以取消命令，
+ *       其他输入被保存，之后由命令读取或者命令结束后由`shellTask`处理，超出长度时丢弃最早的输入
+ */
+#include "test_common.h"
+
+static char testData[32];
+static unsigned short testDataLength;
+static int testCancelled;
+
+
+/**
+ * @brief 循环查询取消标志，不读取输入
+ */
+int spin(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    testCancelled = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        if (shellIsCancelled())
+        {
+            testCancelled = 1;
+            return -1;
+        }
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 spin, spin, spin until cancelled);
+
+
+/**
+ * @brief 查询3次取消标志之后读取输入
+ */
+int peek(int argc, char *argv[])
+{
+    Shell *current = shellGetCurrent();
+    signed short length;
+
+    (void) argc;
+    (void) argv;
+    testDataLength = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        shellIsCancelled();
+    }
+    while ((length = current->read(testData + testDataLength,
+                                   sizeof(testData) - 1 - testDataLength)) > 0)
+    {
+        testDataLength += length;
+    }
+    testData[testDataLength] = 0;
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 peek, peek, read input after checking cancel);
+
+
+/**
+ * @brief 输入数据并运行`shellTask`，直到输入和保存的输入都处理完成
+ *
+ * @param input 输入
+ */
+static void testType(const char *input)
+{
+    testInput = input;
+    while (*testInput)
+    {
+        shellTask(&shell);
+    }
+    for (int i = 0; i < SHELL_CANCEL_PENDING_SIZE; i++)
+    {
+        shellTask(&shell);
+    }
+}
+
+
+/**
+ * @brief 检查正在编辑的命令行
+ *
+ * @param line 命令行
+ *
+ * @return int 1 相同
+ */
+static int testLineEqual(const char *line)
+{
+    return shell.parser.length == strlen(line)
+           && memcmp(shell.parser.buffer, line, shell.parser.length) == 0;
+}
+
+
+/**
+ * @brief 清除正在编辑的命令行
+ */
+static void testClearLine(void)
+{
+    while (shell.parser.length > 0)
+    {
+        shellHandler(&shell, '\b');
+    }
+}
+
+
+int main(void)
+{
+    testShellInit();
+
+    testType("spin\rab\x03" "cd");
+    testCheck("cancel", testCancelled);
+    testCheck("typeahead", testLineEqual("abcd"));
+    testClearLine();
+
+    testType("spin\r123456\x03");
+    testCheck("overflow cancel", testCancelled);
+    testCheck("overflow drop", testLineEqual("3456"));
+    testClearLine();
+
+    testType("peek\rxyz");
+    testCheck("command read", strcmp(testData, "xyz") == 0);
+    testCheck("command read line", testLineEqual(""));
+
+    return testReport();
+}
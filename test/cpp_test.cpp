@@ -0,0 +1,133 @@
+/**
+ * @file cpp_test.cpp
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell cpp command test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#include <shell_cpp.h>
+#include <stdio.h>
+#include <string.h>
+
+static unsigned long failCount = 0;
+
+static Shell shell;
+static char shellBuffer[2048];
+
+static float testFloat;
+static long long testLong;
+static char testData[4];
+
+extern "C" {
+int testVar = 5;
+SHELL_EXPORT_VAR(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_VAR_INT),
+                 testVar, &testVar, test var);
+}
+
+
+/**
+ * @brief 检查结果
+ *
+ * @param name 名称
+ * @param ok 是否通过
+ */
+static void testCheck(const char *name, bool ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", name);
+        failCount++;
+    }
+}
+
+
+/**
+ * @brief 运行命令，返回命令返回值
+ *
+ * @param command 命令
+ * @return int 命令返回值
+ */
+static int testRun(const char *command)
+{
+    char buffer[128];
+    strncpy(buffer, command, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = 0;
+    shell.info.retVal = 0x5A5A5A5A;
+    shellRun(&shell, buffer);
+    return shell.info.retVal;
+}
+
+
+char *cppPointer(int index)
+{
+    return &testData[index];
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0), cppPointer, cppPointer, cpp pointer);
+
+unsigned long long cppWide(long long value)
+{
+    testLong = value;
+    return (unsigned long long) value;
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0), cppWide, cppWide, cpp wide);
+
+double cppReal(float value)
+{
+    testFloat = value;
+    return value;
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0), cppReal, cppReal, cpp real);
+
+void cppVoid(void)
+{
+}
+SHELL_EXPORT_CPP_FUNC(SHELL_CMD_PERMISSION(0), cppVoid, cppVoid, cpp void);
+
+
+static signed short testWrite(char *data, unsigned short len)
+{
+    (void) data;
+    return len;
+}
+
+
+static signed short testRead(char *data, unsigned short len)
+{
+    (void) data;
+    (void) len;
+    return 0;
+}
+
+
+int main(void)
+{
+    shell.read = testRead;
+    shell.write = testWrite;
+    shellInit(&shell, shellBuffer, sizeof(shellBuffer));
+
+    testCheck("pointer return",
+              testRun("cppPointer 2") == (int) (std::intptr_t) &testData[2]);
+    testCheck("wide return", testRun("cppWide 0x100000007") == 7);
+    testCheck("wide param", testLong == 0x100000007LL);
+    testCheck("real return", testRun("cppReal 2.75") == 2);
+    testCheck("real return clamp", testRun("cppReal 1e20") == 0x7FFFFFFF);
+    testCheck("void return", testRun("cppVoid") == 0);
+    testRun("cppReal 3.4028235e38");
+    testCheck("float max", testFloat == 3.40282347e+38f);
+    testCheck("float overflow", testRun("cppReal 3.4028236e38") == -1);
+
+    testRun("cppReal $testVar");
+    testCheck("var float", testFloat == 5.0f);
+    testRun("cppReal $testVar/2");
+    testCheck("var float expression", testFloat == 2.0f);
+    testRun("cppReal $testVar*0.5");
+    testCheck("var real expression", testFloat == 2.5f);
+    testRun("cppWide $testVar*3");
+    testCheck("var long expression", testLong == 15);
+
+    printf("%lu failures\n", failCount);
+    return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file job_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell background job test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note shell使用真实的递归锁，检查`fg`等待时任务可以通过尾行模式输出，
+ *       取消键结束前台等待的任务，以及移除shell后任务被结束并且不再输出，
+ *       使能`SHELL_SUPPORT_YIELD`时`fg`为可挂起命令
+ */
+#define TEST_USING_THREAD           1
+#define TEST_OUTPUT_SIZE            4096
+
+#include "test_common.h"
+#include "shell_job.h"
+
+static int testKilled;
+
+
+/**
+ * @brief 每毫秒输出一行，被请求结束时返回-1
+ *
+ * @param count 行数
+ *
+ * @return int 7
+ */
+int work(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (shellJobKilled())
+        {
+            __atomic_store_n(&testKilled, 1, __ATOMIC_RELEASE);
+            return -1;
+        }
+        shellPrint(shellGetCurrent(), "tick\r\n");
+        usleep(1000);
+    }
+    return 7;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 work, work, print lines);
+
+
+static int testNewThread(void *handler, void *param)
+{
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, (void *(*)(void *)) handler, param) != 0)
+    {
+        return -1;
+    }
+    return pthread_detach(thread);
+}
+
+
+static void testDelay(unsigned int ms)
+{
+    usleep(ms * 1000);
+}
+
+
+/**
+ * @brief 输入数据，按`shellTask`的方式逐个字节处理，直到输入读完并且挂起的命令结束
+ *
+ * @param input 输入
+ */
+static void testType(const char *input)
+{
+    char data;
+    testInput = input;
+    while (shell.read(&data, 1) == 1)
+    {
+        shellHandler(&shell, data);
+    }
+#if SHELL_SUPPORT_YIELD == 1
+    while (shellPoll(&shell))
+    {
+        usleep(1000);
+    }
+#endif
+}
+
+
+int main(void)
+{
+    int length;
+
+    /* 死锁时由SIGALRM结束测试 */
+    alarm(20);
+    testShellLockInit();
+    testShellInit();
+    shellJobInit(testNewThread, testDelay);
+
+    testType("work 20 &\rfg\r");
+    testCheck("fg output", testOutputCount("tick") == 20);
+    testCheck("fg done", testOutputCount("[1] Done: work") == 1);
+
+    testKilled = 0;
+    testType("work 100000 &\rfg\r\x03");
+    testCheck("fg cancel", testKilled && testOutputCount("[2] Killed: work") == 1);
+
+    testKilled = 0;
+    testType("work 100000 &\r");
+    usleep(10000);
+    shellDeInit(&shell);
+    length = testOutputLength;
+    testCheck("remove kill", testWait(&testKilled));
+    usleep(10000);
+    testCheck("remove quiet", testOutputLength == length && testOutputCount("[3] Killed") == 0);
+
+    return testReport();
+}
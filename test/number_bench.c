@@ -0,0 +1,173 @@
+/**
+ * @file number_bench.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell numeric parser benchmark
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 用法: number_bench [rounds]
+ *       对比`shellExtParseNum`，旧版逐位解析(不检查溢出，不支持指数)以及C库strtod/strtoull
+ */
+#include "shell.h"
+#include "shell_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief 典型的命令参数
+ */
+static const char *benchArgs[] = {
+    "0", "1", "42", "-7", "255", "1000", "65535", "-32768", "123456789", "4294967295",
+    "0x10", "0xFF", "0x2000_0000", "0xDEADBEEF", "0b1010", "0b1111_0000", "0755", "017",
+    "3.14", "-0.5", "2.718281828", "100.25", "1e3", "6.02e23", "1.5e-6", "-273.15",
+};
+
+#define BENCH_ARG_NUM (sizeof(benchArgs) / sizeof(benchArgs[0]))
+
+static volatile unsigned long long benchSink;
+
+
+/**
+ * @brief 旧版数字解析(仅用于对比)
+ *
+ * @param string 数字字符串
+ * @return unsigned long long 解析结果
+ */
+static unsigned long long benchLegacyParse(const char *string)
+{
+    const char *p = string;
+    unsigned char radix = 10;
+    signed char sign = 1;
+    unsigned long long value = 0;
+    unsigned long long devide = 0;
+    char isFloat = 0;
+
+    if (*p == '-')
+    {
+        sign = -1;
+        p++;
+    }
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        radix = 16;
+        p += 2;
+    }
+    else if (p[0] == '0' && (p[1] == 'b' || p[1] == 'B'))
+    {
+        radix = 2;
+        p += 2;
+    }
+    else if (p[0] == '0')
+    {
+        radix = 8;
+        p++;
+    }
+    isFloat = (strchr(p, '.') != NULL);
+    for (; *p; p++)
+    {
+        if (*p == '.')
+        {
+            devide = 1;
+            continue;
+        }
+        if (*p >= '0' && *p <= '9')
+        {
+            value = value * radix + (*p - '0');
+        }
+        else if (*p >= 'a' && *p <= 'f')
+        {
+            value = value * radix + (*p - 'a' + 10);
+        }
+        else if (*p >= 'A' && *p <= 'F')
+        {
+            value = value * radix + (*p - 'A' + 10);
+        }
+        devide *= 10;
+    }
+    if (isFloat && devide != 0)
+    {
+        float valueFloat = (float) value / devide * sign;
+        return *(unsigned int *) (&valueFloat);
+    }
+    return value * sign;
+}
+
+
+/**
+ * @brief C库解析(仅用于对比)
+ *
+ * @param string 数字字符串
+ * @return unsigned long long 解析结果
+ */
+static unsigned long long benchLibcParse(const char *string)
+{
+    if (strpbrk(string, ".eE") != NULL && strncmp(string, "0x", 2) != 0)
+    {
+        double value = strtod(string, NULL);
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+    if (strncmp(string, "0b", 2) == 0)
+    {
+        return strtoull(string + 2, NULL, 2);
+    }
+    return strtoull(string, NULL, 0);
+}
+
+
+/**
+ * @brief shellExtParseNum
+ *
+ * @param string 数字字符串
+ * @return unsigned long long 解析结果
+ */
+static unsigned long long benchShellParse(const char *string)
+{
+    ShellNumber number;
+    shellExtParseNum(string, &number);
+    return number.integer ^ (unsigned long long) number.real;
+}
+
+
+/**
+ * @brief 运行一项测试
+ *
+ * @param name 名称
+ * @param parse 解析函数
+ * @param rounds 轮数
+ */
+static void benchRun(const char *name, unsigned long long (*parse)(const char *), unsigned long rounds)
+{
+    struct timespec start, end;
+    unsigned long i;
+    unsigned int j;
+    double ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < rounds; i++)
+    {
+        for (j = 0; j < BENCH_ARG_NUM; j++)
+        {
+            benchSink += parse(benchArgs[j]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("%-16s %8.2f ns/arg\n", name, ns / ((double) rounds * BENCH_ARG_NUM));
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long rounds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 200000;
+
+    benchRun("shellExtParseNum", benchShellParse, rounds);
+    benchRun("legacy", benchLegacyParse, rounds);
+    benchRun("strtod/strtoull", benchLibcParse, rounds);
+    return 0;
+}
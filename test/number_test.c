@@ -0,0 +1,342 @@
+/**
+ * @file number_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell numeric parser round-trip test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 用法: number_test [full]
+ *       默认按步长抽样float，`full`遍历全部有限float(耗时较长)
+ */
+#include "shell.h"
+#include "shell_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <stdint.h>
+
+static unsigned long failCount = 0;
+static unsigned long checkCount = 0;
+
+#define TEST_FAIL(...) \
+        do { \
+            if (failCount++ < 20) \
+            { \
+                printf(__VA_ARGS__); \
+            } \
+        } while (0)
+
+
+/**
+ * @brief xorshift随机数，保证每次运行的序列相同
+ *
+ * @return uint64_t 随机数
+ */
+static uint64_t testRandom(void)
+{
+    static uint64_t state = 88172645463325252ULL;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+/**
+ * @brief 检查整数解析结果
+ *
+ * @param string 数字字符串
+ * @param negative 期望的符号
+ * @param value 期望的绝对值
+ */
+static void testInteger(const char *string, int negative, unsigned long long value)
+{
+    ShellNumber number;
+    int ret = shellExtParseNum(string, &number);
+
+    checkCount++;
+    if (ret != 0 || number.type == NUM_TYPE_FLOAT
+        || number.negative != negative || number.integer != value)
+    {
+        TEST_FAIL("integer: \"%s\" ret %d, got %s%llu, expect %s%llu\n",
+                  string, ret, number.negative ? "-" : "", number.integer,
+                  negative ? "-" : "", value);
+    }
+}
+
+
+/**
+ * @brief 检查解析返回值
+ *
+ * @param string 数字字符串
+ * @param expect 期望的返回值
+ */
+static void testReturn(const char *string, int expect)
+{
+    ShellNumber number;
+    int ret = shellExtParseNum(string, &number);
+
+    checkCount++;
+    if (ret != expect)
+    {
+        TEST_FAIL("return: \"%s\" ret %d, expect %d\n", string, ret, expect);
+    }
+}
+
+
+/**
+ * @brief 检查浮点数解析结果与strtod按位一致
+ *
+ * @param string 数字字符串
+ */
+static void testReal(const char *string)
+{
+    ShellNumber number;
+    char buffer[128];
+    char *p = buffer;
+    const char *q = string;
+    double expect;
+    double value;
+    int ret = shellExtParseNum(string, &number);
+
+    for (; *q && p < buffer + sizeof(buffer) - 1; q++)
+    {
+        if (*q != '_')
+        {
+            *p++ = *q;
+        }
+    }
+    *p = 0;
+    expect = strtod(buffer, NULL);
+
+    checkCount++;
+    if (expect > DBL_MAX || expect < -DBL_MAX)
+    {
+        if (ret != -2)
+        {
+            TEST_FAIL("real: \"%s\" ret %d, expect overflow\n", string, ret);
+        }
+        return;
+    }
+    value = (number.type == NUM_TYPE_FLOAT) ? number.real : (double) number.integer;
+    if (number.type != NUM_TYPE_FLOAT && number.negative)
+    {
+        value = -value;
+    }
+    if (ret != 0 || memcmp(&value, &expect, sizeof(double)) != 0)
+    {
+        TEST_FAIL("real: \"%s\" ret %d, got %.17g, expect %.17g\n",
+                  string, ret, value, expect);
+    }
+}
+
+
+/**
+ * @brief 格式化double，保证结果按浮点数解析
+ *
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @param precision 有效数字个数
+ * @param value 数值
+ */
+static void testFormat(char *buffer, size_t size, int precision, double value)
+{
+    snprintf(buffer, size, "%.*g", precision, value);
+    if (strpbrk(buffer, ".e") == NULL)
+    {
+        strcat(buffer, ".0");
+    }
+}
+
+
+/**
+ * @brief 整数解析：各进制、分隔符、边界以及溢出
+ */
+static void testIntegers(void)
+{
+    static const char *formats[] = {"%lu", "0x%lx", "0X%lX", "0%lo"};
+    char buffer[96];
+    unsigned long i;
+    unsigned int j;
+
+    for (i = 0; i <= 0x1FFFF; i++)
+    {
+        for (j = 0; j < sizeof(formats) / sizeof(formats[0]); j++)
+        {
+            if (i == 0 && j == 3)
+            {
+                continue;
+            }
+            snprintf(buffer, sizeof(buffer), formats[j], i);
+            testInteger(buffer, 0, i);
+            buffer[0] = '-';
+            snprintf(buffer + 1, sizeof(buffer) - 1, formats[j], i);
+            testInteger(buffer, 1, i);
+        }
+        snprintf(buffer, sizeof(buffer), "0b");
+        for (j = 17; j > 0; j--)
+        {
+            strcat(buffer, ((i >> (j - 1)) & 1) ? "1" : "0");
+            if (j % 4 == 1 && j > 1)
+            {
+                strcat(buffer, "_");
+            }
+        }
+        testInteger(buffer, 0, i);
+    }
+
+    testInteger("1_000_000", 0, 1000000);
+    testInteger("0xFFFF_FFFF", 0, 0xFFFFFFFFUL);
+    testInteger("+42", 0, 42);
+    testInteger("18446744073709551615", 0, 18446744073709551615ULL);
+    testInteger("0xFFFFFFFFFFFFFFFF", 0, 18446744073709551615ULL);
+    testInteger("-9223372036854775808", 1, 9223372036854775808ULL);
+    testInteger("01777777777777777777777", 0, 18446744073709551615ULL);
+
+    testReturn("18446744073709551616", -2);
+    testReturn("0x1_0000_0000_0000_0000", -2);
+    testReturn("0b1" "0000000000000000000000000000000000000000000000000000000000000000", -2);
+    testReturn("02000000000000000000000", -2);
+    testReturn("99999999999999999999999", -2);
+
+    testReturn("", -1);
+    testReturn("-", -1);
+    testReturn("0x", -1);
+    testReturn("0b2", -1);
+    testReturn("09.5", 0);
+    testReturn("0x1G", -1);
+    testReturn("_1", -1);
+    testReturn("12a", -1);
+    testReturn("1.2.3", -1);
+    testReturn("1e", -1);
+    testReturn("1e+", -1);
+    testReturn(".", -1);
+}
+
+
+/**
+ * @brief 浮点数边界：最大值，最小规格化数，非规格化数，2^53附近以及舍入中点
+ */
+static void testRealEdges(void)
+{
+    static const char *edges[] = {
+        "0.0", "-0.0", "0e999999", "1.0", "0.1", "-0.1", "3.14159", "1e22", "1e23",
+        "1.5", "2.5e-3", ".5", "5.", "1_000.25",
+        "9007199254740992.0", "9007199254740993.0", "9007199254740995.0",
+        "9007199254740992.5", "18014398509481985.0",
+        "1.7976931348623157e308", "1.7976931348623158e308",
+        "1.7976931348623158079e308", "1.797693134862315807937289714053e308",
+        "1.7976931348623159e308", "1.8e308", "1e309", "1e99999",
+        "2.2250738585072014e-308", "2.2250738585072011e-308",
+        "2.2250738585072012e-308", "2.225073858507201136057409796709131975934819546351645e-308",
+        "4.9406564584124654e-324", "2.4703282292062327e-324",
+        "2.4703282292062328e-324", "7.4109846876186981e-324", "1e-324", "1e-400",
+        "123456789012345678901234567890.0", "0.000000000000000000000000000000000000001e39",
+        "8.98846567431158e307", "7.2057594037927933e16", "1.00000005960464477550",
+        "2.0000000000000004440892098500626161694526672363281250",
+        "2.00000000000000044408920985006261616945266723632812500000000001",
+        "0.500000000000000166533453693773481063544750213623046875",
+    };
+    char buffer[64];
+    unsigned int i;
+    int e;
+
+    for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+    {
+        testReal(edges[i]);
+    }
+    for (e = -330; e <= 310; e++)
+    {
+        snprintf(buffer, sizeof(buffer), "1e%d", e);
+        testReal(buffer);
+        snprintf(buffer, sizeof(buffer), "-9.999999999999999e%d", e);
+        testReal(buffer);
+    }
+}
+
+
+/**
+ * @brief double随机round-trip：%.17g必须精确还原，较短的格式与strtod一致
+ *
+ * @param count 随机数个数
+ */
+static void testRealRandom(unsigned long count)
+{
+    char buffer[64];
+    unsigned long i;
+    uint64_t bits;
+    double value;
+    ShellNumber number;
+
+    for (i = 0; i < count; i++)
+    {
+        bits = testRandom();
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0)
+        {
+            continue;
+        }
+        testFormat(buffer, sizeof(buffer), 17, value);
+        checkCount++;
+        if (shellExtParseNum(buffer, &number) != 0
+            || memcmp(&number.real, &value, sizeof(double)) != 0)
+        {
+            TEST_FAIL("round-trip: \"%s\" got %.17g\n", buffer, number.real);
+        }
+        testFormat(buffer, sizeof(buffer), (int) (testRandom() % 17) + 1, value);
+        testReal(buffer);
+    }
+}
+
+
+/**
+ * @brief float round-trip：%.9g解析后转换为float必须精确还原
+ *
+ * @param step 遍历步长，1为遍历全部有限float
+ */
+static void testFloat(unsigned long step)
+{
+    char buffer[64];
+    uint64_t i;
+    uint32_t bits;
+    uint32_t result;
+    float value;
+    ShellNumber number;
+
+    for (i = 0; i < 0x7F800000ULL; i += step)
+    {
+        bits = (uint32_t) i;
+        memcpy(&value, &bits, sizeof(value));
+        testFormat(buffer, sizeof(buffer), 9, value);
+        checkCount++;
+        if (shellExtParseNum(buffer, &number) != 0)
+        {
+            TEST_FAIL("float: \"%s\" parse error\n", buffer);
+            continue;
+        }
+        value = (float) number.real;
+        memcpy(&result, &value, sizeof(result));
+        if (result != bits)
+        {
+            TEST_FAIL("float: \"%s\" got %08x, expect %08x\n", buffer,
+                      (unsigned int) result, (unsigned int) bits);
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int full = (argc > 1 && strcmp(argv[1], "full") == 0);
+
+    testIntegers();
+    testRealEdges();
+    testRealRandom(full ? 10000000 : 200000);
+    testFloat(full ? 1 : 4099);
+
+    printf("%lu checks, %lu failures\n", checkCount, failCount);
+    return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file param_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell command parameter test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#define TEST_SHELL_BUFFER_SIZE      2048
+
+#include "test_common.h"
+
+static int testCalls;
+static long long testLong[2];
+static float testFloat[2];
+static double testDouble[2];
+
+int testVar = -123456;
+SHELL_EXPORT_VAR(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_VAR_INT),
+                 testVar, &testVar, test var);
+
+
+int wideParam(long long l, float f, double d)
+{
+    testLong[0] = l;
+    testFloat[0] = f;
+    testDouble[0] = d;
+    return 0;
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0), wideParam, wideParam, wide param, l, f, d);
+
+
+static char testMix[160];
+
+int wideMix(char c, long long l, short h, double d, float f, long long m, int i)
+{
+    snprintf(testMix, sizeof(testMix), "%c %lld %d %.17g %.9g %lld %d", c, l, h, d, f, m, i);
+    return i;
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0), wideMix, wideMix, wide mix, c, l, h, d, f, l, i);
+
+
+int stringParam(int i, char *s)
+{
+    testCalls++;
+    return i + (int) strlen(s);
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0), stringParam, stringParam, string param, i, s);
+
+
+static char testString[64];
+
+int stringCopy(char *s)
+{
+    strncpy(testString, s, sizeof(testString) - 1);
+    return 0;
+}
+SHELL_EXPORT_CMD_TYPED(SHELL_CMD_PERMISSION(0), stringCopy, stringCopy, string copy, s);
+
+
+void wideArray(long long *l, float *f, double *d)
+{
+    testLong[1] = l[0] + l[1];
+    testFloat[1] = f[0] + f[1];
+    testDouble[1] = d[0] + d[1];
+}
+SHELL_EXPORT_CMD_SIGN(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC),
+                      wideArray, wideArray, wide array, [l[f[d);
+
+
+int main(void)
+{
+    testShellInit();
+
+    testRun("wideParam 9007199254740993 1.5 0.1");
+    testCheck("wide long", testLong[0] == 9007199254740993LL);
+    testCheck("wide float", testFloat[0] == 1.5f);
+    testCheck("wide double", testDouble[0] == 0.1);
+
+    testRun("wideMix x -9223372036854775808 -32768 2.2250738585072014e-308 3.4028235e38"
+            " 0x7FFF_FFFF_FFFF_FFFF -1");
+    testCheck("wide mix", strcmp(testMix, "x -9223372036854775808 -32768 2.2250738585072014e-308 "
+                                          "3.40282347e+38 9223372036854775807 -1") == 0);
+
+    testRun("wideParam $testVar $testVar $testVar");
+    testCheck("var long", testLong[0] == -123456);
+    testCheck("var float", testFloat[0] == -123456.0f);
+    testCheck("var double", testDouble[0] == -123456.0);
+
+    testRun("wideArray [$testVar, 4294967296] [$testVar, 0.5] [$testVar, 0.25]");
+    testCheck("var long element", testLong[1] == 4294967296LL - 123456);
+    testCheck("var float element", testFloat[1] == -123455.5f);
+    testCheck("var double element", testDouble[1] == -123455.75);
+
+    testRun("stringParam 1 abc");
+    testCheck("typed call", testCalls == 1);
+    testRun("stringParam 1");
+    testRun("stringParam");
+    testRun("stringParam 1 abc def");
+    testCheck("typed arity", testCalls == 1);
+
+    testRun("stringCopy ${testVar}");
+    testCheck("var expand", strcmp(testString, "-123456") == 0);
+    testRun("stringCopy \"a ${testVar}b\"");
+    testCheck("var expand quoted", strcmp(testString, "a -123456b") == 0);
+    testRun("stringCopy \\${testVar}");
+    testCheck("var escaped", strcmp(testString, "${testVar}") == 0);
+    testRun("stringCopy \\${testVar}-${testVar}");
+    testCheck("var escaped mixed", strcmp(testString, "${testVar}--123456") == 0);
+    testRun("stringCopy ${testVar}\\${testVar}");
+    testCheck("var escaped after", strcmp(testString, "-123456${testVar}") == 0);
+    testRun("stringCopy ${none}");
+    testCheck("var unknown", strcmp(testString, "${none}") == 0);
+
+    testRun("stringCopy foo( ; stringCopy bar");
+    testCheck("plain paren", strcmp(testString, "bar") == 0);
+    testRun("wideParam $testVar+(1 << 2) (1 | 2) ($testVar & 0xFF)");
+    testCheck("paren long", testLong[0] == -123452);
+    testCheck("paren float", testFloat[0] == 3.0f);
+    testCheck("paren double", testDouble[0] == (double) (-123456 & 0xFF));
+
+    testLong[0] = 0;
+    testRun("wideParam $testVar<<2 1 1");
+    testCheck("bare shift", strstr(testOutput, "must be in parentheses") != NULL);
+    testRun("wideParam $testVar|4 1 1");
+    testCheck("bare or", strstr(testOutput, "must be in parentheses") != NULL);
+    testRun("wideParam $testVar&&1 1 1");
+    testCheck("bare and", strstr(testOutput, "must be in parentheses") != NULL);
+    testRun("wideParam 1 1 1; wideParam $testVar>1 1 1; wideParam 2 1 1");
+    testCheck("bare greater", strstr(testOutput, "must be in parentheses") != NULL);
+    testCheck("bare operator", testLong[0] == 1);
+    testRun("wideParam ($testVar|4) 1 1");
+    testCheck("paren operator", testLong[0] == -123452);
+
+    return testReport();
+}
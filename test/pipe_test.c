@@ -0,0 +1,168 @@
+/**
+ * @file pipe_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell pipe test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#include "test_common.h"
+#include <stdlib.h>
+
+static unsigned long testLines;
+static unsigned long testBytes;
+static unsigned long testNext;
+static unsigned int testCalls;
+static unsigned int testMaxChunk;
+static unsigned int testBrokenChunk;
+static unsigned int testMarks;
+
+
+/**
+ * @brief 清除计数
+ */
+static void testReset(void)
+{
+    testLines = 0;
+    testBytes = 0;
+    testNext = 0;
+    testCalls = 0;
+    testMaxChunk = 0;
+    testBrokenChunk = 0;
+    testMarks = 0;
+}
+
+
+/**
+ * @brief 输出编号连续的行
+ *
+ * @param count 行数
+ */
+void produce(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        shellPrint(shellGetCurrent(), "line %05d\r\n", i);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 produce, produce, produce lines);
+
+
+/**
+ * @brief 输出不换行的数据
+ *
+ * @param count 字节数
+ */
+void blob(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        shellWriteString(shellGetCurrent(), "x");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 blob, blob, produce bytes);
+
+
+/**
+ * @brief 统计输入，检查行号连续，并且每次交出的都是完整的行
+ */
+int count(int argc, char *argv[])
+{
+    Shell *current = shellGetCurrent();
+    unsigned int chunk = 0;
+    char line[32];
+    unsigned short length = 0;
+    char data;
+
+    (void) argc;
+    (void) argv;
+    testCalls++;
+    while (current->read(&data, 1) == 1)
+    {
+        chunk++;
+        testBytes++;
+        if (data == 'x')
+        {
+            continue;
+        }
+        if (data != '\n')
+        {
+            if (length < sizeof(line) - 1)
+            {
+                line[length++] = data;
+            }
+            continue;
+        }
+        line[length] = 0;
+        length = 0;
+        if (strncmp(line, "line ", 5) == 0)
+        {
+            testCheck("line order", strtoul(line + 5, NULL, 10) >= testNext);
+            testNext = strtoul(line + 5, NULL, 10) + 1;
+        }
+        testLines++;
+    }
+    if (length > 0)
+    {
+        testBrokenChunk++;
+    }
+    if (chunk > testMaxChunk)
+    {
+        testMaxChunk = chunk;
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 count, count, count input);
+
+
+void mark(void)
+{
+    testMarks++;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 mark, mark, mark);
+
+
+int main(void)
+{
+    testRunReset = testReset;
+    testShellInit();
+
+    testRun("produce 1000 | count");
+    testCheck("all lines", testLines == 1000 && testNext == 1000 && testBytes == 12000);
+    testCheck("bounded chunk", testCalls > 1 && testMaxChunk <= SHELL_PIPE_BUFFER);
+    testCheck("whole lines", testBrokenChunk == 0);
+    testCheck("no output", strcmp(testOutput, "\r\n") == 0);
+
+    testRun("produce 1000 | grep line | count");
+    testCheck("grep all", testLines == 1000 && testNext == 1000 && testBrokenChunk == 0);
+
+    testRun("produce 1000 | grep 00742 | count");
+    testCheck("grep one", testLines == 1 && testNext == 743 && testCalls == 1);
+
+    testRun("blob 1000 | count");
+    testCheck("no newline", testBytes == 1000 && testMaxChunk == SHELL_PIPE_BUFFER);
+
+    testRun("produce 0 | count");
+    testCheck("empty input", testCalls == 1 && testBytes == 0);
+
+    testRun("produce 1000 | grep 00742 && mark");
+    testCheck("grep match", testMarks == 1);
+    testCheck("grep output", strcmp(testOutput, "\r\nline 00742\r\n") == 0);
+
+    testRun("produce 1000 | grep zzz && mark");
+    testCheck("grep no match", testMarks == 0);
+
+    testRun("produce 1 | grep line | grep line | count");
+    testCheck("too deep", testCalls == 0 && strstr(testOutput, "Too many pipes") != NULL);
+
+    testRun("produce 1 | nothing | count");
+    testCheck("not found", testCalls == 0 && strstr(testOutput, "Command not Found") != NULL);
+
+    return testReport();
+}
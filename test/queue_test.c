@@ -0,0 +1,173 @@
+/**
+ * @file queue_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell exec queue test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 主线程作为输入上下文调用`shellTask`，另一个线程作为执行上下文调用`shellExecQueued`，
+ *       执行上下文只在入队通知时被唤醒，检查命令执行期间输入仍然被读取和回显，回显不会写入管道，
+ *       命令读不到端口输入，以及取消按键
+ */
+#define TEST_USING_THREAD           1
+#define TEST_OUTPUT_SIZE            1024
+
+#include "test_common.h"
+#include <semaphore.h>
+
+static int testBlocked;
+static int testRelease;
+static int testFinished;
+static int testCounted;
+static int testRunning;
+static int testCancelled;
+static int testExecReads;
+static int testLines;
+static int testBytes;
+static sem_t testExecSem;
+
+
+/**
+ * @brief 等待释放或者取消，期间尝试读取输入，结束时输出一行
+ */
+int block(int argc, char *argv[])
+{
+    Shell *current = shellGetCurrent();
+    char data;
+
+    (void) argc;
+    (void) argv;
+    __atomic_store_n(&testBlocked, 1, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&testRelease, __ATOMIC_ACQUIRE) && !shellIsCancelled())
+    {
+        if (current->read(&data, 1) == 1)
+        {
+            testExecReads++;
+        }
+        usleep(100);
+    }
+    testCancelled = shellIsCancelled();
+    shellPrint(current, "line\r\n");
+    __atomic_store_n(&testFinished, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 block, block, wait for release);
+
+
+/**
+ * @brief 统计输入的行数和字节数
+ */
+int count(int argc, char *argv[])
+{
+    char data;
+
+    (void) argc;
+    (void) argv;
+    while (shellGetCurrent()->read(&data, 1) == 1)
+    {
+        testBytes++;
+        if (data == '\n')
+        {
+            testLines++;
+        }
+    }
+    __atomic_store_n(&testCounted, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 count, count, count input);
+
+
+/**
+ * @brief 命令行入队通知，唤醒执行上下文
+ */
+static void testExecNotify(Shell *shell)
+{
+    (void) shell;
+    sem_post(&testExecSem);
+}
+
+
+/**
+ * @brief 执行上下文，队列为空时等待入队通知
+ */
+static void *testExecutor(void *param)
+{
+    (void) param;
+    while (__atomic_load_n(&testRunning, __ATOMIC_ACQUIRE))
+    {
+        if (!shellExecQueued(&shell))
+        {
+            sem_wait(&testExecSem);
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief 在输入上下文中处理输入，直到输入读完
+ *
+ * @param input 输入
+ */
+static void testType(const char *input)
+{
+    testInput = input;
+    while (*testInput)
+    {
+        shellTask(&shell);
+    }
+}
+
+
+/**
+ * @brief 清除状态
+ */
+static void testReset(void)
+{
+    testOutputReset();
+    testBlocked = testRelease = testFinished = testCounted = 0;
+    testCancelled = testExecReads = testLines = testBytes = 0;
+}
+
+
+int main(void)
+{
+    pthread_t executor;
+
+    alarm(20);
+    testShellLockInit();
+    testShellInit();
+    sem_init(&testExecSem, 0, 0);
+    shell.queue.notify = testExecNotify;
+    shellSetExecQueue(&shell, 1);
+    testRunning = 1;
+    pthread_create(&executor, NULL, testExecutor, NULL);
+
+    testReset();
+    testType("block | count\r");
+    testCheck("pipe blocked", testWait(&testBlocked));
+    testType("xyz");
+    testCheck("echo", testOutputHas("xyz"));
+    __atomic_store_n(&testRelease, 1, __ATOMIC_RELEASE);
+    testCheck("pipe done", testWait(&testCounted));
+    testCheck("pipe input", testLines == 1 && testBytes == 6);
+    testCheck("no exec input", testExecReads == 0);
+    testType("\b\b\b");
+
+    testReset();
+    testType("block\r");
+    testCheck("cancel blocked", testWait(&testBlocked));
+    testType("\x03");
+    testCheck("cancel done", testWait(&testFinished));
+    testCheck("cancelled", testCancelled);
+    testCheck("cancel output", testOutputHas("line"));
+
+    __atomic_store_n(&testRunning, 0, __ATOMIC_RELEASE);
+    sem_post(&testExecSem);
+    pthread_join(executor, NULL);
+    return testReport();
+}
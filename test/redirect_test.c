@@ -0,0 +1,232 @@
+/**
+ * @file redirect_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell redirect test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#include "test_common.h"
+#include "shell_fs.h"
+
+static ShellFs shellFs;
+static char shellPathBuffer[64] = "/";
+
+static char logBuffer[2048];
+static char smallBuffer[100];
+static ShellFsMemFile memFiles[] = {
+    {.name = "log", .buffer = logBuffer, .size = sizeof(logBuffer)},
+    {.name = "small", .buffer = smallBuffer, .size = sizeof(smallBuffer)},
+};
+
+static char diskBuffer[2048];
+static unsigned short diskLength;
+static unsigned int diskWrites;
+static int diskHandle;
+
+static unsigned long testLines;
+static unsigned int testMarks;
+
+
+/**
+ * @brief 清除计数
+ */
+static void testReset(void)
+{
+    testLines = 0;
+    testMarks = 0;
+}
+
+
+/**
+ * @brief 检查文件内容是否为编号连续的行
+ *
+ * @param buffer 文件内容
+ * @param length 文件长度
+ * @param first 第一行的编号
+ * @param count 行数
+ *
+ * @return int 1 内容正确
+ */
+static int testLinesEqual(const char *buffer, size_t length, int first, int count)
+{
+    char line[16];
+
+    if (length != (size_t) count * 12)
+    {
+        return 0;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "line %05d\r\n", first + i);
+        if (memcmp(buffer + i * 12, line, 12) != 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/**
+ * @brief 输出编号连续的行
+ *
+ * @param first 第一行的编号
+ * @param count 行数
+ *
+ * @return int 0
+ */
+int produce(int first, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        shellPrint(shellGetCurrent(), "line %05d\r\n", first + i);
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 produce, produce, produce lines);
+
+
+/**
+ * @brief 统计输入的行数
+ */
+int count(int argc, char *argv[])
+{
+    char data;
+
+    (void) argc;
+    (void) argv;
+    while (shellGetCurrent()->read(&data, 1) == 1)
+    {
+        if (data == '\n')
+        {
+            testLines++;
+        }
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 count, count, count input lines);
+
+
+void mark(void)
+{
+    testMarks++;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC)|SHELL_CMD_DISABLE_RETURN,
+                 mark, mark, mark);
+
+
+/**
+ * @brief 模拟每次最多写入7个字节的文件
+ */
+static void *diskOpen(const char *path, const char *mode)
+{
+    if (strcmp(path, "disk") != 0)
+    {
+        return NULL;
+    }
+    if (mode[0] == 'w')
+    {
+        diskLength = 0;
+    }
+    diskWrites = 0;
+    return &diskHandle;
+}
+
+
+static int diskClose(void *file)
+{
+    return file == &diskHandle ? 0 : -1;
+}
+
+
+static int diskRead(void *file, char *buffer, unsigned short len)
+{
+    (void) file;
+    (void) buffer;
+    (void) len;
+    return 0;
+}
+
+
+static int diskWrite(void *file, const char *buffer, unsigned short len)
+{
+    if (file != &diskHandle)
+    {
+        return -1;
+    }
+    if (len > 7)
+    {
+        len = 7;
+    }
+    if (len > sizeof(diskBuffer) - diskLength)
+    {
+        len = sizeof(diskBuffer) - diskLength;
+    }
+    memcpy(diskBuffer + diskLength, buffer, len);
+    diskLength += len;
+    diskWrites++;
+    return len;
+}
+
+
+static size_t testGetcwd(char *buffer, size_t len)
+{
+    strncpy(buffer, "/", len);
+    return 0;
+}
+
+
+int main(void)
+{
+    shellFs.getcwd = testGetcwd;
+    shellFs.file.open = diskOpen;
+    shellFs.file.close = diskClose;
+    shellFs.file.read = diskRead;
+    shellFs.file.write = diskWrite;
+    shellFsMemInit(&shellFs, memFiles, sizeof(memFiles) / sizeof(ShellFsMemFile));
+    shellFsInit(&shellFs, shellPathBuffer, sizeof(shellPathBuffer));
+
+    testRunReset = testReset;
+    testShellInit();
+    shellCompanionAdd(&shell, SHELL_COMPANION_ID_FS, &shellFs);
+    shellCompanionAdd(&shell, SHELL_COMPANION_ID_FILE, &shellFs.file);
+
+    testRun("produce 0 100 > log");
+    testCheck("memory write", testLinesEqual(logBuffer, memFiles[0].length, 0, 100));
+    testCheck("memory quiet", strcmp(testOutput, "\r\n") == 0);
+
+    testRun("produce 100 50 >> log");
+    testCheck("memory append", testLinesEqual(logBuffer, memFiles[0].length, 0, 150));
+
+    testRun("count < log");
+    testCheck("memory read", testLines == 150);
+
+    testRun("produce 0 10 > log");
+    testCheck("memory truncate", testLinesEqual(logBuffer, memFiles[0].length, 0, 10));
+
+    testRun("produce 0 100 | grep 7 > log");
+    testCheck("pipe to memory", memFiles[0].length == 19 * 12
+                                && memcmp(logBuffer, "line 00007\r\n", 12) == 0);
+
+    testRun("produce 0 20 > disk");
+    testCheck("short write", testLinesEqual(diskBuffer, diskLength, 0, 20));
+    testCheck("short write count", diskWrites >= 240 / 7);
+
+    testRun("produce 0 20 > small && mark");
+    testCheck("full file", memFiles[1].length == sizeof(smallBuffer));
+    testCheck("full file error", strstr(testOutput, "Redirect write failed") != NULL);
+    testCheck("full file return", testMarks == 0);
+
+    testRun("produce 0 5 > small && mark");
+    testCheck("error reset", testMarks == 1 && testLinesEqual(smallBuffer, memFiles[1].length, 0, 5));
+
+    testRun("produce 0 5 > none");
+    testCheck("open error", strstr(testOutput, "Can't redirect: none") != NULL);
+
+    return testReport();
+}
@@ -0,0 +1,209 @@
+/**
+ * @file registry_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell registry multi-thread test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 多个线程同时反复注册和移除shell，并在注册期间执行命令检查`shellGetCurrent`，另一个线程同时遍历注册表，
+ *       `SHELL_REGISTRY_GROW`为0时检查注册表满时注册失败，为1时检查注册表扩展
+ */
+#define TEST_USING_THREAD           1
+
+#include "test_common.h"
+
+#define TEST_THREADS        8
+#define TEST_ROUNDS         20000
+
+static Shell shells[TEST_THREADS];
+static char shellBuffers[TEST_THREADS][128];
+static unsigned long testAdded[TEST_THREADS];
+static unsigned long testFull[TEST_THREADS];
+
+static volatile int testRunning;
+static unsigned long testWalks;
+static unsigned long testBadShell;
+static unsigned long testMaxCount;
+static unsigned long testCommands[TEST_THREADS];
+static unsigned long testBadCurrent;
+static __thread Shell *testShell;
+
+
+/**
+ * @brief 统计遍历到的shell，并检查是否为测试的shell
+ */
+static void testCount(Shell *shell, void *param)
+{
+    if (shell < &shells[0] || shell >= &shells[TEST_THREADS])
+    {
+        testBadShell++;
+    }
+    (*(unsigned long *) param)++;
+}
+
+
+/**
+ * @brief 检查shell是否在注册表中
+ */
+static void testFind(Shell *shell, void *param)
+{
+    if (shell == ((void **) param)[0])
+    {
+        ((void **) param)[1] = shell;
+    }
+}
+
+
+static int testRegistered(Shell *shell)
+{
+    void *param[2] = {shell, NULL};
+    shellForEach(testFind, param);
+    return param[1] != NULL;
+}
+
+
+/**
+ * @brief 检查当前shell是执行命令的线程注册的shell，中间遍历注册表，并且检查自身已注册
+ */
+int current(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    for (int i = 0; i < 2; i++)
+    {
+        if (shellGetCurrent() != testShell || !testRegistered(testShell))
+        {
+            __atomic_fetch_add(&testBadCurrent, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+    }
+    testCommands[testShell - shells]++;
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN)|SHELL_CMD_DISABLE_RETURN,
+                 current, current, check current shell);
+
+
+/**
+ * @brief 反复注册和移除一个shell，注册期间执行命令
+ */
+static void *testWorker(void *param)
+{
+    unsigned long index = (unsigned long) param;
+    Shell *shell = &shells[index];
+
+    testShell = shell;
+    for (unsigned long i = 0; i < TEST_ROUNDS; i++)
+    {
+        shell->read = testRead;
+        shell->write = testWrite;
+        if (shellInit(shell, shellBuffers[index], sizeof(shellBuffers[index])) == 0)
+        {
+            if (!testRegistered(shell))
+            {
+                __atomic_fetch_add(&failCount, 1, __ATOMIC_RELAXED);
+            }
+            testAdded[index]++;
+            shellRun(shell, "current");
+            shellDeInit(shell);
+        }
+        else
+        {
+            testFull[index]++;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief 遍历注册表直到注册线程结束
+ */
+static void *testWalker(void *param)
+{
+    (void) param;
+    while (__atomic_load_n(&testRunning, __ATOMIC_ACQUIRE))
+    {
+        unsigned long count = 0;
+        if (shellGetCurrent() != NULL)
+        {
+            __atomic_fetch_add(&testBadCurrent, 1, __ATOMIC_RELAXED);
+        }
+        shellForEach(testCount, &count);
+        if (count > testMaxCount)
+        {
+            testMaxCount = count;
+        }
+        testWalks++;
+    }
+    return NULL;
+}
+
+
+int main(void)
+{
+    pthread_t workers[TEST_THREADS];
+    pthread_t walker;
+    unsigned long added = 0;
+    unsigned long full = 0;
+    unsigned long commands = 0;
+    unsigned long count = 0;
+
+    /* 单线程检查注册表容量 */
+    for (unsigned long i = 0; i < TEST_THREADS; i++)
+    {
+        int ret;
+        shells[i].read = testRead;
+        shells[i].write = testWrite;
+        ret = shellInit(&shells[i], shellBuffers[i], sizeof(shellBuffers[i]));
+    #if SHELL_REGISTRY_GROW == 1
+        testCheck("grow", ret == 0);
+    #else
+        testCheck("capacity", ret == (i < SHELL_MAX_NUMBER ? 0 : -1));
+    #endif
+        testCheck("registered", testRegistered(&shells[i]) == (ret == 0));
+    }
+    shellDeInit(&shells[0]);
+    testCheck("removed", !testRegistered(&shells[0]));
+    testCheck("reuse", shellInit(&shells[0], shellBuffers[0], sizeof(shellBuffers[0])) == 0);
+    for (unsigned long i = 0; i < TEST_THREADS; i++)
+    {
+        shellDeInit(&shells[i]);
+    }
+    shellForEach(testCount, &count);
+    testCheck("empty", count == 0);
+
+    /* 多线程同时注册，移除以及遍历 */
+    testRunning = 1;
+    pthread_create(&walker, NULL, testWalker, NULL);
+    for (unsigned long i = 0; i < TEST_THREADS; i++)
+    {
+        pthread_create(&workers[i], NULL, testWorker, (void *) i);
+    }
+    for (unsigned long i = 0; i < TEST_THREADS; i++)
+    {
+        pthread_join(workers[i], NULL);
+        added += testAdded[i];
+        full += testFull[i];
+        commands += testCommands[i];
+    }
+    __atomic_store_n(&testRunning, 0, __ATOMIC_RELEASE);
+    pthread_join(walker, NULL);
+
+    testCheck("rounds", added + full == (unsigned long) TEST_THREADS * TEST_ROUNDS);
+#if SHELL_REGISTRY_GROW == 1
+    testCheck("no full", full == 0);
+#else
+    testCheck("max count", testMaxCount <= SHELL_MAX_NUMBER);
+#endif
+    testCheck("walk", testWalks > 0 && testBadShell == 0);
+    testCheck("current", commands == added && testBadCurrent == 0);
+    count = 0;
+    shellForEach(testCount, &count);
+    testCheck("empty after", count == 0);
+
+    printf("%lu added, %lu full, %lu walks\n", added, full, testWalks);
+    return testReport();
+}
@@ -0,0 +1,20 @@
+/**
+ * @file shell_cfg_cancel.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test config for command cancel
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright (c) 2026 Letter
+ * 
+ */
+#ifndef __SHELL_CFG_CANCEL_H__
+#define __SHELL_CFG_CANCEL_H__
+
+#include "shell_cfg_test.h"
+
+#define     SHELL_SUPPORT_CANCEL        1
+
+#define     SHELL_CANCEL_PENDING_SIZE   4
+
+#endif
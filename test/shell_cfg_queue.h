@@ -0,0 +1,24 @@
+/**
+ * @file shell_cfg_queue.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test config for the exec queue
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright (c) 2026 Letter
+ * 
+ */
+#ifndef __SHELL_CFG_QUEUE_H__
+#define __SHELL_CFG_QUEUE_H__
+
+#include "shell_cfg_test.h"
+
+#define     SHELL_THREAD_LOCAL          __thread
+
+#define     SHELL_USING_LOCK            1
+
+#define     SHELL_EXEC_QUEUE_SIZE       256
+
+#define     SHELL_SUPPORT_CANCEL        1
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file shell_cfg_task.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test config for the shellTask loop
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright (c) 2026 Letter
+ * 
+ */
+#ifndef __SHELL_CFG_TASK_H__
+#define __SHELL_CFG_TASK_H__
+
+#include "shell_cfg_test.h"
+
+extern unsigned int testTick;
+
+#undef      SHELL_TASK_WHILE
+#define     SHELL_TASK_WHILE            1
+
+#define     SHELL_GET_TICK()            testTick
+
+#define     SHELL_SUPPORT_YIELD         1
+
+#define     SHELL_SUPPORT_CANCEL        1
+
+#define     SHELL_SUPPORT_END_LINE      1
+
+#define     SHELL_END_LINE_REDRAW_DELAY 1000
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ * @file shell_cfg_telnet.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test config for the telnet server
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ */
+#ifndef __SHELL_CFG_TELNET_H__
+#define __SHELL_CFG_TELNET_H__
+
+#include "shell_cfg_test.h"
+
+extern unsigned int testTick;
+
+#define     SHELL_GET_TICK()            testTick
+
+#endif
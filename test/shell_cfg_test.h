@@ -0,0 +1,50 @@
+/**
+ * @file shell_cfg_test.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test config
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright (c) 2026 Letter
+ * 
+ */
+#ifndef __SHELL_CFG_TEST_H__
+#define __SHELL_CFG_TEST_H__
+
+#include <stdlib.h>
+
+#define     SHELL_TASK_WHILE            0
+
+#define     SHELL_SHOW_INFO             0
+
+#define     SHELL_MALLOC(size)          malloc(size)
+
+#define     SHELL_FREE(obj)             free(obj)
+
+#define     SHELL_DEFAULT_USER          "test"
+
+#define     SHELL_PARAM_ARENA_SIZE      512
+
+#define     SHELL_USING_FUNC_SIGNATURE  1
+
+#define     SHELL_USING_FUNC_INVOKER    1
+
+#define     SHELL_SUPPORT_ARRAY_PARAM   1
+
+#define     SHELL_SUPPORT_EXPRESSION    1
+
+#define     SHELL_KEEP_RETURN_VALUE     1
+
+#define     SHELL_SUPPORT_MULTI_STATEMENT   1
+
+#define     SHELL_PIPE_BUFFER           64
+
+#define     SHELL_PIPE_DEPTH            2
+
+#define     SHELL_USING_COMPANION       1
+
+#define     SHELL_REDIRECT_BUFFER       32
+
+#define     SHELL_SUPPORT_VAR_EXPAND    1
+
+#endif
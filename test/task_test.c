@@ -0,0 +1,210 @@
+/**
+ * @file task_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell task loop test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 使用模拟的tick和等待函数运行`shellTask`循环，检查挂起的命令不会让循环空转，
+ *       不能挂起(多语句中间)时等待剩余的延时并且可以被取消，空闲等待中写入的尾行输出在重绘延时后重绘，
+ *       没有输入并且空闲等待时结束循环
+ */
+#include "test_common.h"
+#include <setjmp.h>
+#include <unistd.h>
+
+#define TEST_MAX_WAITS      64
+
+unsigned int testTick = 0;
+
+static jmp_buf testExit;
+
+static unsigned int testWaits[TEST_MAX_WAITS];
+static unsigned int testWaitCount;
+static unsigned int testIdleReads;
+static unsigned int testTarget;
+static unsigned int testDoneTick;
+static unsigned int testResumes;
+static char *testLog;
+
+
+/**
+ * @brief 挂起100个tick
+ */
+ShellYieldState delay(ShellYield *yield, int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    SHELL_YIELD_BEGIN(yield);
+    SHELL_YIELD_DELAY(yield, 100);
+    testDoneTick = testTick;
+    SHELL_YIELD_RETURN(yield, 0);
+    SHELL_YIELD_END(yield);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_YIELD)|SHELL_CMD_DISABLE_RETURN,
+                 delay, delay, delay 100 ticks);
+
+
+/**
+ * @brief 挂起直到tick到达目标值
+ */
+ShellYieldState until(ShellYield *yield, int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    SHELL_YIELD_BEGIN(yield);
+    SHELL_YIELD_UNTIL(yield, testTick >= testTarget);
+    testDoneTick = testTick;
+    SHELL_YIELD_RETURN(yield, 0);
+    SHELL_YIELD_END(yield);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_YIELD)|SHELL_CMD_DISABLE_RETURN,
+                 until, until, wait for target tick);
+
+
+/**
+ * @brief 一直挂起，直到被取消
+ */
+ShellYieldState forever(ShellYield *yield, int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    SHELL_YIELD_BEGIN(yield);
+    while (1)
+    {
+        testResumes++;
+        SHELL_YIELD(yield);
+    }
+    SHELL_YIELD_END(yield);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0)|SHELL_CMD_TYPE(SHELL_TYPE_CMD_YIELD)|SHELL_CMD_DISABLE_RETURN,
+                 forever, forever, suspend forever);
+
+
+/**
+ * @brief 读取脚本输入，统计没有输入的读取，过多时结束循环
+ */
+static signed short testIdleRead(char *data, unsigned short len)
+{
+    signed short ret = testRead(data, len);
+    if (ret == 0 && ++testIdleReads >= TEST_MAX_WAITS * 4)
+    {
+        longjmp(testExit, 1);
+    }
+    return ret;
+}
+
+
+/**
+ * @brief 模拟的等待函数，记录等待时间并推进tick，输入已读完并且空闲等待，或者等待次数过多时结束循环
+ *        设置了`testLog`时，在空闲等待中模拟其他线程写入尾行输出，写入不会唤醒等待
+ */
+static int testWaitInput(unsigned int timeout)
+{
+    int idle = timeout == SHELL_WAIT_FOREVER
+               || (timeout == SHELL_END_LINE_REDRAW_DELAY
+                   && !shell.status.endLinePending && !shell.yield.command);
+
+    if (testInput && *testInput)
+    {
+        return 1;
+    }
+    if (idle && testLog)
+    {
+        shellWriteEndLine(&shell, testLog, strlen(testLog));
+        testLog = NULL;
+        if (timeout == SHELL_WAIT_FOREVER)
+        {
+            longjmp(testExit, 1);
+        }
+    }
+    else if (idle || testWaitCount >= TEST_MAX_WAITS)
+    {
+        longjmp(testExit, 1);
+    }
+    testWaits[testWaitCount++] = timeout;
+    testTick += timeout;
+    return 0;
+}
+
+
+/**
+ * @brief 输入命令并运行`shellTask`，直到没有输入并且一直等待
+ *
+ * @param input 输入
+ */
+static void testLoop(const char *input)
+{
+    testInput = input;
+    testWaitCount = 0;
+    testIdleReads = 0;
+    testDoneTick = 0;
+    if (setjmp(testExit) == 0)
+    {
+        shellTask(&shell);
+    }
+}
+
+
+/**
+ * @brief 检查循环没有空转，等待时间都不为0，并且每次没有输入的读取之后都等待
+ *
+ * @return int 1 没有空转
+ */
+static int testNoSpin(void)
+{
+    for (unsigned int i = 0; i < testWaitCount; i++)
+    {
+        if (testWaits[i] == 0)
+        {
+            return 0;
+        }
+    }
+    return testWaitCount < TEST_MAX_WAITS && testIdleReads <= testWaitCount + 1;
+}
+
+
+int main(void)
+{
+    unsigned int start;
+
+    /* 不能挂起的命令空转时由SIGALRM结束测试 */
+    alarm(20);
+    shell.waitInput = testWaitInput;
+    testShellInit();
+    shell.read = testIdleRead;
+
+    start = testTick;
+    testLoop("delay\r");
+    testCheck("delay done", testDoneTick - start >= 100);
+    testCheck("delay no spin", testNoSpin());
+    testCheck("delay waits", testWaitCount >= 1 && testWaitCount <= 2 && testWaits[0] == 100);
+
+    testTarget = testTick + 5;
+    testLoop("until\r");
+    testCheck("until done", testDoneTick == testTarget);
+    testCheck("until no spin", testNoSpin());
+    testCheck("until tick", testWaitCount == 5 && testWaits[0] == 1 && testWaits[4] == 1);
+
+    /* 多语句中间的命令不能挂起，在执行命令处等待 */
+    start = testTick;
+    testLoop("delay; delay\r");
+    testCheck("inline done", testDoneTick - start >= 200);
+    testCheck("inline no spin", testNoSpin());
+    testCheck("inline waits", testWaitCount >= 2 && testWaits[0] == 100 && testWaits[1] == 100);
+
+    testResumes = 0;
+    testDoneTick = 0;
+    testLoop("forever; delay\r\x03");
+    testCheck("inline cancel", testResumes > 0 && testResumes < TEST_MAX_WAITS && testDoneTick == 0);
+
+    /* 等待中写入的尾行输出在重绘延时后重绘命令行，而不是一直等到下一次按键 */
+    testLog = "log\r\n";
+    testLoop("");
+    testCheck("end line redraw", testLog == NULL && !shell.status.endLinePending);
+    testCheck("end line waits", testWaitCount == 1 && testWaits[0] == SHELL_END_LINE_REDRAW_DELAY);
+
+    return testReport();
+}
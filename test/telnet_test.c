@@ -0,0 +1,271 @@
+/**
+ * @file telnet_test.c
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief telnet server protocol parser and idle timeout wheel test
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 直接包含telnetd.c测试其中的静态函数，会话的连接使用socketpair，从另一端读取服务端的应答，
+ *       协议数据按照每一种分块长度分多次解析，检查跨越多次接收的IAC，子协商以及选项协商，
+ *       时间轮使用模拟的tick转动，检查空闲超时的会话按时关闭
+ */
+#include "telnetd.c"
+#include "test_common.h"
+
+unsigned int testTick = 0;
+
+static TelnetdSession testSession;
+static int testPeer;
+
+
+/**
+ * @brief 初始化测试会话，连接使用socketpair
+ *
+ * @param session 会话
+ * @param peer 连接的另一端
+ */
+static void testSessionOpen(TelnetdSession *session, int *peer)
+{
+    int fds[2];
+
+    memset(session, 0, sizeof(TelnetdSession));
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    telnetdSetNonBlock(fds[1]);
+    session->client = fds[0];
+    *peer = fds[1];
+    pthread_mutex_init(&session->lock, NULL);
+    session->options = (1 << TELNET_OPT_ECHO) | (1 << TELNET_OPT_SGA);
+    session->used = 1;
+}
+
+
+/**
+ * @brief 读取服务端发送到连接另一端的数据
+ *
+ * @param peer 连接的另一端
+ * @param buffer 数据缓冲
+ * @param size 缓冲大小
+ *
+ * @return int 数据长度
+ */
+static int testReply(int peer, char *buffer, int size)
+{
+    int length = 0;
+    ssize_t ret;
+
+    while (length < size && (ret = recv(peer, buffer + length, size - length, MSG_DONTWAIT)) > 0)
+    {
+        length += ret;
+    }
+    return length;
+}
+
+
+/**
+ * @brief 按照每一种分块长度解析输入，检查过滤后的数据和服务端的应答
+ *        每次解析前恢复会话的解析状态，选项，终端大小和终端类型
+ *
+ * @param input 输入
+ * @param len 输入长度
+ * @param data 期望的数据
+ * @param dataLen 期望的数据长度
+ * @param reply 期望的应答
+ * @param replyLen 期望的应答长度
+ * @param check 每次解析后的额外检查，可以为NULL
+ *
+ * @return int 1 所有分块长度都通过
+ */
+static int testSplit(const char *input, int len, const char *data, int dataLen,
+                     const char *reply, int replyLen, int (*check)(void))
+{
+    for (int chunk = 1; chunk <= len; chunk++)
+    {
+        char buffer[64];
+        char answer[64];
+        int count = 0;
+
+        testSession.state = TELNETD_STATE_DATA;
+        testSession.options = (1 << TELNET_OPT_ECHO) | (1 << TELNET_OPT_SGA);
+        testSession.shell.info.width = testSession.shell.info.height = 0;
+        testSession.terminal[0] = 0;
+        for (int i = 0; i < len; i += chunk)
+        {
+            int size = len - i < chunk ? len - i : chunk;
+            memcpy(buffer + count, input + i, size);
+            count += telnetdFilter(&testSession, buffer + count, size);
+        }
+        if (count != dataLen || memcmp(buffer, data, count) != 0
+            || testReply(testPeer, answer, sizeof(answer)) != replyLen
+            || memcmp(answer, reply, replyLen) != 0
+            || testSession.state != TELNETD_STATE_DATA
+            || (check && !check()))
+        {
+            printf("chunk %d: ", chunk);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+static int testNaws(void)
+{
+    return testSession.shell.info.width == 80 && testSession.shell.info.height == 24;
+}
+
+
+static int testNawsEscaped(void)
+{
+    return testSession.shell.info.width == 0x1FF && testSession.shell.info.height == 0xFF;
+}
+
+
+static int testTtype(void)
+{
+    return strcmp(testSession.terminal, "xterm-256color") == 0;
+}
+
+
+static int testTtypeLong(void)
+{
+    return strlen(testSession.terminal) == TELNETD_TERMINAL_TYPE_SIZE - 1
+           && memcmp(testSession.terminal, "0123456789abcdefghijklmnopqrstuv",
+                     TELNETD_TERMINAL_TYPE_SIZE - 1) == 0;
+}
+
+
+static int testNoEcho(void)
+{
+    return !(testSession.options & (1 << TELNET_OPT_ECHO));
+}
+
+
+/**
+ * @brief 转动时间轮直到时间到达`end`，记录会话关闭的时间
+ *
+ * @param sessions 会话
+ * @param closed 会话关闭的时间，未关闭时为0
+ * @param count 会话数量
+ * @param end 结束时间
+ * @param step 每次转动推进的时间
+ */
+static void testTurn(TelnetdSession *sessions, unsigned int *closed, int count,
+                     unsigned int end, unsigned int step)
+{
+    while ((int) (end - testTick) > 0)
+    {
+        testTick += step;
+        telnetdWheelTurn();
+        for (int i = 0; i < count; i++)
+        {
+            if (sessions[i].closed && closed[i] == 0)
+            {
+                closed[i] = testTick;
+            }
+        }
+    }
+}
+
+
+static int testWheelEmpty(void)
+{
+    for (int i = 0; i < TELNETD_WHEEL_SIZE; i++)
+    {
+        if (telnetdWheel[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+int main(void)
+{
+    TelnetdSession sessions[3];
+    unsigned int closed[3] = {0};
+    int peers[3];
+    char buffer[64];
+    unsigned int start;
+
+    testSessionOpen(&testSession, &testPeer);
+
+    {
+        const char input[] = {'a', TELNET_IAC, TELNET_IAC, 'b'};
+        const char data[] = {'a', (char) 0xFF, 'b'};
+        testCheck("iac iac", testSplit(input, sizeof(input), data, sizeof(data), "", 0, NULL));
+    }
+    {
+        const char input[] = {'x', TELNET_IAC, TELNET_SB, TELNET_OPT_NAWS, 0, 80, 0, 24,
+                              TELNET_IAC, TELNET_SE, 'y'};
+        testCheck("naws", testSplit(input, sizeof(input), "xy", 2, "", 0, testNaws));
+    }
+    {
+        const char input[] = {TELNET_IAC, TELNET_SB, TELNET_OPT_NAWS, 0x01, TELNET_IAC, TELNET_IAC,
+                              0, TELNET_IAC, TELNET_IAC, TELNET_IAC, TELNET_SE};
+        testCheck("naws iac", testSplit(input, sizeof(input), "", 0, "", 0, testNawsEscaped));
+    }
+    {
+        const char input[] = "\xFF\xFA\x18\x00xterm-256color\xFF\xF0z";
+        testCheck("ttype", testSplit(input, sizeof(input) - 1, "z", 1, "", 0, testTtype));
+    }
+    {
+        const char input[] = "\xFF\xFA\x18\x00" "0123456789abcdefghijklmnopqrstuvwxyz0123456789\xFF\xF0";
+        testCheck("ttype truncate", testSplit(input, sizeof(input) - 1, "", 0, "", 0, testTtypeLong));
+    }
+    {
+        /* 未知选项只拒绝一次，客户端确认拒绝时不再应答 */
+        const char input[] = {TELNET_IAC, TELNET_DO, 0x05, TELNET_IAC, TELNET_DONT, 0x05,
+                              TELNET_IAC, TELNET_WILL, 0x05, TELNET_IAC, TELNET_WONT, 0x05, 'k'};
+        const char reply[] = {TELNET_IAC, TELNET_WONT, 0x05, TELNET_IAC, TELNET_DONT, 0x05};
+        testCheck("refuse", testSplit(input, sizeof(input), "k", 1, reply, sizeof(reply), NULL));
+    }
+    {
+        /* 已启用的选项不重复应答，关闭后应答一次 */
+        const char input[] = {TELNET_IAC, TELNET_DO, TELNET_OPT_ECHO, TELNET_IAC, TELNET_WILL, TELNET_OPT_NAWS,
+                              TELNET_IAC, TELNET_DONT, TELNET_OPT_ECHO, TELNET_IAC, TELNET_DONT, TELNET_OPT_ECHO};
+        const char reply[] = {TELNET_IAC, TELNET_WONT, TELNET_OPT_ECHO};
+        testCheck("option state", testSplit(input, sizeof(input), "", 0, reply, sizeof(reply), testNoEcho));
+    }
+    {
+        const char input[] = {TELNET_IAC, TELNET_WILL, TELNET_OPT_TTYPE};
+        testCheck("ttype send", testSplit(input, sizeof(input), "", 0,
+                                          telnetTtypeSend, sizeof(telnetTtypeSend), NULL));
+    }
+
+    /* 时间轮，起始时间接近tick回绕 */
+    start = testTick = 0xFFFFFFFF - TELNETD_IDLE_TIMEOUT / 2;
+    telnetdWheelTick = testTick;
+    telnetdWheelCursor = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        testSessionOpen(&sessions[i], &peers[i]);
+        sessions[i].active = testTick;
+        telnetdWheelAdd(&sessions[i], testTick);
+    }
+    testTurn(sessions, closed, 3, start + TELNETD_IDLE_TIMEOUT / 2, TELNETD_WHEEL_INTERVAL / 2);
+    /* 会话1收到数据只更新活动时间，会话2被关闭后移出时间轮 */
+    sessions[1].active = testTick;
+    telnetdWheelDel(&sessions[2]);
+    testTurn(sessions, closed, 3, start + 2 * TELNETD_IDLE_TIMEOUT, TELNETD_WHEEL_INTERVAL / 2);
+    testCheck("wheel timeout", closed[0] - start >= TELNETD_IDLE_TIMEOUT
+              && closed[0] - start <= TELNETD_IDLE_TIMEOUT + TELNETD_WHEEL_INTERVAL);
+    testCheck("wheel active", closed[1] - start >= TELNETD_IDLE_TIMEOUT * 3 / 2
+              && closed[1] - start <= TELNETD_IDLE_TIMEOUT * 3 / 2 + TELNETD_WHEEL_INTERVAL);
+    testCheck("wheel removed", closed[2] == 0);
+    testCheck("wheel info", testReply(peers[0], buffer, sizeof(buffer)) == sizeof(telnetdTimeoutInfo) - 1
+              && memcmp(buffer, telnetdTimeoutInfo, sizeof(telnetdTimeoutInfo) - 1) == 0);
+    testCheck("wheel empty", testWheelEmpty());
+
+    /* 长时间没有转动时，转动一圈后追上当前时间 */
+    sessions[2].closed = 0;
+    closed[2] = 0;
+    sessions[2].active = testTick;
+    telnetdWheelAdd(&sessions[2], testTick);
+    testTurn(sessions, closed, 3, testTick + 10 * TELNETD_IDLE_TIMEOUT, 10 * TELNETD_IDLE_TIMEOUT);
+    testCheck("wheel jump", closed[2] == testTick && telnetdWheelTick == testTick && testWheelEmpty());
+
+    return testReport();
+}
@@ -0,0 +1,261 @@
+/**
+ * @file test_common.h
+ * @author Letter (nevermindzzt@gmail.com)
+ * @brief shell host test common fixtures
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright (c) 2026 Letter
+ *
+ * @note 每个测试只包含一次，提供结果检查，测试shell，脚本输入，输出捕获以及命令运行，
+ *       包含之前可以定义`TEST_SHELL_BUFFER_SIZE`，`TEST_OUTPUT_SIZE`修改缓冲大小，
+ *       定义`TEST_USING_THREAD`为1时输出捕获加锁，并提供shell递归锁和等待标志
+ */
+#ifndef __TEST_COMMON_H__
+#define __TEST_COMMON_H__
+
+#include "shell.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TEST_USING_THREAD
+#define TEST_USING_THREAD           0
+#endif
+
+#if TEST_USING_THREAD == 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifndef TEST_SHELL_BUFFER_SIZE
+/**
+ * @brief 测试shell的缓冲大小
+ */
+#define TEST_SHELL_BUFFER_SIZE      512
+#endif
+
+#ifndef TEST_OUTPUT_SIZE
+/**
+ * @brief 输出捕获缓冲大小，写满后的输出被丢弃
+ */
+#define TEST_OUTPUT_SIZE            256
+#endif
+
+static unsigned long failCount = 0;
+
+static Shell shell;
+static char shellBuffer[TEST_SHELL_BUFFER_SIZE];
+
+static const char *testInput;
+static char testOutput[TEST_OUTPUT_SIZE];
+static unsigned short testOutputLength;
+
+/**
+ * @brief `testRun`运行命令前调用，用于清除测试自己的计数，可以为NULL
+ */
+static void (*testRunReset)(void);
+
+#if TEST_USING_THREAD == 1
+static pthread_mutex_t testOutputMutex = PTHREAD_MUTEX_INITIALIZER;
+#if SHELL_USING_LOCK == 1
+static pthread_mutex_t testShellMutex;
+#endif
+#define TEST_OUTPUT_LOCK()          pthread_mutex_lock(&testOutputMutex)
+#define TEST_OUTPUT_UNLOCK()        pthread_mutex_unlock(&testOutputMutex)
+#else
+#define TEST_OUTPUT_LOCK()
+#define TEST_OUTPUT_UNLOCK()
+#endif
+
+
+/**
+ * @brief 检查结果
+ *
+ * @param name 名称
+ * @param ok 是否通过
+ */
+static inline void testCheck(const char *name, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", name);
+        failCount++;
+    }
+}
+
+
+/**
+ * @brief 输出失败数量
+ *
+ * @return int main函数的返回值，0 全部通过
+ */
+static inline int testReport(void)
+{
+    printf("%lu failures\n", failCount);
+    return failCount == 0 ? 0 : 1;
+}
+
+
+/**
+ * @brief 捕获shell的输出，输出总是以0结尾
+ */
+static inline signed short testWrite(char *data, unsigned short len)
+{
+    unsigned short size;
+
+    TEST_OUTPUT_LOCK();
+    size = sizeof(testOutput) - 1 - testOutputLength;
+    if (size > len)
+    {
+        size = len;
+    }
+    memcpy(testOutput + testOutputLength, data, size);
+    testOutputLength += size;
+    testOutput[testOutputLength] = 0;
+    TEST_OUTPUT_UNLOCK();
+    return len;
+}
+
+
+/**
+ * @brief 每次读取`testInput`中的一个字节，读完或者没有设置时返回0
+ */
+static inline signed short testRead(char *data, unsigned short len)
+{
+    if (len == 0 || testInput == NULL || *testInput == 0)
+    {
+        return 0;
+    }
+    *data = *testInput++;
+    return 1;
+}
+
+
+/**
+ * @brief 清除捕获的输出
+ */
+static inline void testOutputReset(void)
+{
+    TEST_OUTPUT_LOCK();
+    testOutputLength = 0;
+    testOutput[0] = 0;
+    TEST_OUTPUT_UNLOCK();
+}
+
+
+/**
+ * @brief 统计输出中字符串出现的次数
+ *
+ * @param string 字符串
+ *
+ * @return int 次数
+ */
+static inline int testOutputCount(const char *string)
+{
+    int count = 0;
+
+    TEST_OUTPUT_LOCK();
+    for (char *p = strstr(testOutput, string); p; p = strstr(p + 1, string))
+    {
+        count++;
+    }
+    TEST_OUTPUT_UNLOCK();
+    return count;
+}
+
+
+/**
+ * @brief 检查输出中是否包含字符串
+ *
+ * @param string 字符串
+ *
+ * @return int 1 包含
+ */
+static inline int testOutputHas(const char *string)
+{
+    return testOutputCount(string) > 0;
+}
+
+
+/**
+ * @brief 初始化测试shell，使用脚本输入和输出捕获
+ */
+static inline void testShellInit(void)
+{
+    shell.read = testRead;
+    shell.write = testWrite;
+    shellInit(&shell, shellBuffer, sizeof(shellBuffer));
+}
+
+
+/**
+ * @brief 运行命令，清除之前的输出，命令复制到可写的缓冲中执行
+ *
+ * @param command 命令
+ */
+static inline void testRun(const char *command)
+{
+    char buffer[128];
+
+    strncpy(buffer, command, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = 0;
+    if (testRunReset)
+    {
+        testRunReset();
+    }
+    testOutputReset();
+    shellRun(&shell, buffer);
+}
+
+
+#if TEST_USING_THREAD == 1
+#if SHELL_USING_LOCK == 1
+static inline int testShellLock(Shell *shell)
+{
+    (void) shell;
+    return pthread_mutex_lock(&testShellMutex);
+}
+
+
+static inline int testShellUnlock(Shell *shell)
+{
+    (void) shell;
+    return pthread_mutex_unlock(&testShellMutex);
+}
+
+
+/**
+ * @brief 测试shell使用递归锁，需要在`testShellInit`之前调用
+ */
+static inline void testShellLockInit(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&testShellMutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    shell.lock = testShellLock;
+    shell.unlock = testShellUnlock;
+}
+#endif /** SHELL_USING_LOCK == 1 */
+
+
+/**
+ * @brief 等待其他线程设置标志，最多等待1s
+ *
+ * @param flag 标志
+ *
+ * @return int 标志的值
+ */
+static inline int testWait(int *flag)
+{
+    for (int i = 0; i < 1000 && !__atomic_load_n(flag, __ATOMIC_ACQUIRE); i++)
+    {
+        usleep(1000);
+    }
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+}
+#endif /** TEST_USING_THREAD == 1 */
+
+#endif